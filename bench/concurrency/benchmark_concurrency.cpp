@@ -0,0 +1,241 @@
+#include "bench/util/table.hpp"
+
+#include "fly/types/concurrency/bounded_lock_free_queue.hpp"
+#include "fly/types/concurrency/concurrent_queue.hpp"
+#include "fly/types/concurrency/concurrent_stack.hpp"
+#include "fly/types/concurrency/lock_free_queue.hpp"
+#include "fly/types/concurrency/lock_free_stack.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using QueueTable = fly::benchmark::Table<std::string, std::int64_t, std::int64_t, double, double>;
+using StackTable = fly::benchmark::Table<std::string, std::int64_t, double, double>;
+
+constexpr std::size_t s_iterations = 11;
+constexpr std::size_t s_items = 1 << 20;
+
+/**
+ * Split a number of items evenly between a number of threads.
+ */
+std::size_t share_of(std::size_t thread, std::size_t threads)
+{
+    return (s_items / threads) + ((thread < (s_items % threads)) ? 1 : 0);
+}
+
+template <typename QueueType>
+double run_queue_once(std::uint32_t producers, std::uint32_t consumers)
+{
+    QueueType queue;
+
+    std::vector<std::thread> threads;
+    std::atomic_bool start(false);
+
+    for (std::uint32_t i = 0; i < producers; ++i)
+    {
+        threads.emplace_back(
+            [&queue, &start, items = share_of(i, producers)]()
+            {
+                while (!start.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                for (std::size_t item = 0; item < items; ++item)
+                {
+                    queue.push(std::uint64_t(item));
+                }
+            });
+    }
+
+    for (std::uint32_t i = 0; i < consumers; ++i)
+    {
+        threads.emplace_back(
+            [&queue, &start, items = share_of(i, consumers)]()
+            {
+                while (!start.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                for (std::size_t item = 0; item < items; ++item)
+                {
+                    std::uint64_t value = 0;
+                    queue.pop(value);
+                }
+            });
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+template <typename QueueType>
+void run_queue_test(
+    QueueTable &table,
+    std::string &&name,
+    std::uint32_t producers,
+    std::uint32_t consumers)
+{
+    std::vector<double> results;
+
+    for (std::size_t i = 0; i < s_iterations; ++i)
+    {
+        results.push_back(run_queue_once<QueueType>(producers, consumers));
+    }
+
+    std::sort(results.begin(), results.end());
+
+    const auto duration = results[s_iterations / 2];
+    const auto speed = s_items / duration / 1000.0 / 1000.0;
+
+    table.append_row(
+        std::move(name),
+        static_cast<std::int64_t>(producers),
+        static_cast<std::int64_t>(consumers),
+        duration * 1000,
+        speed);
+}
+
+template <typename StackType>
+double run_stack_once(std::uint32_t thread_count)
+{
+    StackType stack;
+
+    std::vector<std::thread> threads;
+    std::atomic_bool start(false);
+
+    for (std::uint32_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(
+            [&stack, &start, items = share_of(i, thread_count)]()
+            {
+                while (!start.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                // Mimic use of the stack as an object free-list: release an object onto the stack,
+                // then acquire any object from the stack.
+                for (std::size_t item = 0; item < items; ++item)
+                {
+                    std::uint64_t value = item;
+                    stack.push(std::move(value));
+                    stack.pop(value, std::chrono::milliseconds(0));
+                }
+            });
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+template <typename StackType>
+void run_stack_test(StackTable &table, std::string &&name, std::uint32_t thread_count)
+{
+    std::vector<double> results;
+
+    for (std::size_t i = 0; i < s_iterations; ++i)
+    {
+        results.push_back(run_stack_once<StackType>(thread_count));
+    }
+
+    std::sort(results.begin(), results.end());
+
+    const auto duration = results[s_iterations / 2];
+    const auto speed = s_items / duration / 1000.0 / 1000.0;
+
+    table.append_row(
+        std::move(name),
+        static_cast<std::int64_t>(thread_count),
+        duration * 1000,
+        speed);
+}
+
+} // namespace
+
+CATCH_TEST_CASE("Queues", "[bench]")
+{
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> configurations;
+
+    for (std::uint32_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        configurations.emplace_back(threads, threads);
+    }
+
+    if (max_threads > 1)
+    {
+        configurations.emplace_back(1, max_threads);
+        configurations.emplace_back(max_threads, 1);
+    }
+
+    QueueTable table(
+        "Queues",
+        {"Queue", "Producers", "Consumers", "Duration (ms)", "Speed (Mops/s)"});
+
+    for (const auto &[producers, consumers] : configurations)
+    {
+        run_queue_test<fly::ConcurrentQueue<std::uint64_t>>(
+            table,
+            "ConcurrentQueue",
+            producers,
+            consumers);
+        run_queue_test<fly::BoundedLockFreeQueue<std::uint64_t>>(
+            table,
+            "BoundedLockFreeQueue",
+            producers,
+            consumers);
+        run_queue_test<fly::LockFreeQueue<std::uint64_t>>(
+            table,
+            "LockFreeQueue",
+            producers,
+            consumers);
+    }
+
+    std::cout << table << '\n';
+}
+
+CATCH_TEST_CASE("Stacks", "[bench]")
+{
+    StackTable table("Stacks", {"Stack", "Threads", "Duration (ms)", "Speed (Mops/s)"});
+
+    for (std::uint32_t thread_count : {1, 4, 16})
+    {
+        run_stack_test<fly::ConcurrentStack<std::uint64_t>>(
+            table,
+            "ConcurrentStack",
+            thread_count);
+        run_stack_test<fly::LockFreeStack<std::uint64_t>>(table, "LockFreeStack", thread_count);
+    }
+
+    std::cout << table << '\n';
+}
@@ -16,6 +16,7 @@ SRC_DIRS_$(d) := \
 # Include the directories containing the benchmark tests.
 SRC_DIRS_$(d) += \
     bench/coders \
+    bench/concurrency \
     bench/json
 
 SRC_$(d) := \
@@ -5,24 +5,61 @@
 #include "fly/logger/log.hpp"
 #include "fly/logger/logger_config.hpp"
 #include "fly/system/system.hpp"
+#include "fly/task/task_runner.hpp"
 #include "fly/types/string/string.hpp"
 
 #include <string>
-#include <system_error>
 
 namespace fly::detail {
 
+namespace {
+
+    /**
+     * Compress a rotated log file, removing the log file if it was successfully compressed.
+     *
+     * @param coder_config Reference to the coder configuration.
+     * @param log_file Path to the rotated log file.
+     */
+    void compress(
+        const std::shared_ptr<fly::CoderConfig> &coder_config,
+        const std::filesystem::path &log_file)
+    {
+        std::filesystem::path compressed_log_file = log_file;
+        compressed_log_file.replace_extension(".log.enc");
+
+        fly::HuffmanEncoder encoder(coder_config);
+
+        if (encoder.encode_file(log_file, compressed_log_file))
+        {
+            std::filesystem::remove(log_file);
+        }
+    }
+
+} // namespace
+
 //==================================================================================================
 FileSink::FileSink(
     const std::shared_ptr<fly::LoggerConfig> &logger_config,
     const std::shared_ptr<fly::CoderConfig> &coder_config,
-    const std::filesystem::path &logger_directory) :
+    const std::filesystem::path &logger_directory,
+    const std::shared_ptr<fly::TaskRunner> &compression_task_runner) :
     m_logger_config(logger_config),
     m_coder_config(coder_config),
+    m_compression_task_runner(compression_task_runner),
+    m_pending_compressions(std::make_shared<std::atomic<std::uint32_t>>(0)),
     m_log_directory(logger_directory)
 {
 }
 
+//==================================================================================================
+FileSink::~FileSink()
+{
+    if (m_log_stream.is_open())
+    {
+        flush();
+    }
+}
+
 //==================================================================================================
 bool FileSink::initialize()
 {
@@ -32,20 +69,45 @@ bool FileSink::initialize()
 //==================================================================================================
 bool FileSink::stream(fly::Log &&log)
 {
-    if (m_log_stream.good())
+    if (!m_log_stream.good())
     {
-        m_log_stream << log << std::flush;
-        std::error_code error;
+        return false;
+    }
 
-        if (std::filesystem::file_size(m_log_file, error) > m_logger_config->max_log_file_size())
-        {
-            return create_log_file();
-        }
+    if (m_buffer_size == 0)
+    {
+        m_buffer_time = std::chrono::steady_clock::now();
+    }
 
-        return true;
+    const auto position = m_buffer.tellp();
+    m_buffer << log;
+
+    const auto size = static_cast<std::uintmax_t>(m_buffer.tellp() - position);
+    m_buffer_size += size;
+    m_log_file_size += size;
+
+    if (should_flush(log) && !flush())
+    {
+        return false;
     }
 
-    return false;
+    if (m_log_file_size > m_max_log_file_size)
+    {
+        return create_log_file();
+    }
+
+    return true;
+}
+
+//==================================================================================================
+std::optional<std::chrono::steady_clock::time_point> FileSink::flush_deadline() const
+{
+    if ((m_buffer_size == 0) || (m_flush_interval <= std::chrono::milliseconds::zero()))
+    {
+        return std::nullopt;
+    }
+
+    return m_buffer_time + m_flush_interval;
 }
 
 //==================================================================================================
@@ -53,19 +115,12 @@ bool FileSink::create_log_file()
 {
     if (m_log_stream.is_open())
     {
+        flush();
         m_log_stream.close();
 
         if (m_logger_config->compress_log_files())
         {
-            std::filesystem::path compressed_log_file = m_log_file;
-            compressed_log_file.replace_extension(".log.enc");
-
-            fly::HuffmanEncoder encoder(m_coder_config);
-
-            if (encoder.encode_file(m_log_file, compressed_log_file))
-            {
-                std::filesystem::remove(m_log_file);
-            }
+            compress_log_file(m_log_file);
         }
     }
 
@@ -78,8 +133,79 @@ bool FileSink::create_log_file()
     std::string file_name = fly::String::format("Log_%d_%s_%s.log", ++m_log_index, time, random);
     m_log_file = m_log_directory / std::move(file_name);
 
+    m_log_file_size = 0;
+    m_max_log_file_size = m_logger_config->max_log_file_size();
+    m_flush_size = m_logger_config->log_flush_size();
+    m_flush_interval = m_logger_config->log_flush_interval();
+    m_flush_on_error = m_logger_config->flush_on_error();
+
     m_log_stream.open(m_log_file, std::ios::out);
     return m_log_stream.good();
 }
 
+//==================================================================================================
+void FileSink::compress_log_file(std::filesystem::path log_file)
+{
+    const std::uint32_t max_pending_compressions = m_logger_config->max_pending_log_compressions();
+
+    // Only this sink increments the pending count, so the bound cannot be exceeded between this
+    // check and the increment.
+    if (m_compression_task_runner && (m_pending_compressions->load() < max_pending_compressions))
+    {
+        m_pending_compressions->fetch_add(1);
+
+        auto task = [coder_config = m_coder_config,
+                     log_file,
+                     pending_compressions = m_pending_compressions]()
+        {
+            compress(coder_config, log_file);
+            pending_compressions->fetch_sub(1);
+        };
+
+        if (m_compression_task_runner->post_task(FROM_HERE, std::move(task)))
+        {
+            return;
+        }
+
+        m_pending_compressions->fetch_sub(1);
+    }
+
+    compress(m_coder_config, log_file);
+}
+
+//==================================================================================================
+bool FileSink::should_flush(const fly::Log &log) const
+{
+    if (m_buffer_size >= m_flush_size)
+    {
+        return true;
+    }
+    else if (m_flush_on_error && (log.m_level == fly::Log::Level::Error))
+    {
+        return true;
+    }
+    else if (m_flush_interval > std::chrono::milliseconds::zero())
+    {
+        return (std::chrono::steady_clock::now() - m_buffer_time) >= m_flush_interval;
+    }
+
+    return false;
+}
+
+//==================================================================================================
+bool FileSink::flush()
+{
+    if (m_buffer_size > 0)
+    {
+        const std::string buffer = m_buffer.str();
+        m_log_stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+        m_buffer.str(std::string());
+        m_buffer_size = 0;
+    }
+
+    m_log_stream.flush();
+    return m_log_stream.good();
+}
+
 } // namespace fly::detail
@@ -2,15 +2,20 @@
 
 #include "fly/logger/log_sink.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <optional>
+#include <sstream>
 
 namespace fly {
 class CoderConfig;
 class LoggerConfig;
 struct Log;
+class TaskRunner;
 } // namespace fly
 
 namespace fly::detail {
@@ -19,6 +24,18 @@ namespace fly::detail {
  * A log sink for streaming log points to a file. Log files are size-limted, rotated, and optionally
  * compressed.
  *
+ * Log points are buffered in memory and written to the log file according to the configured flush
+ * policy: once the buffer reaches a size, once a log point has been buffered for an interval, or
+ * immediately for error-level log points. The size of the log file is tracked in memory rather than
+ * queried from the file system. The flush policy is read from the logger configuration whenever a
+ * log file is created. Asynchronous loggers also flush the sink once the flush interval elapses,
+ * even if no further log points are streamed.
+ *
+ * If the sink is given a compression task runner, rotated log files are compressed on that task
+ * runner so that the sink may immediately continue streaming log points to the new log file. The
+ * number of log files pending compression is bounded; beyond that bound, rotated log files are
+ * compressed synchronously.
+ *
  * @author Timothy Flynn (trflynn89@pm.me)
  * @version October 11, 2020
  */
@@ -31,11 +48,19 @@ class FileSink : public fly::LogSink
      * @param logger_config Reference to the logger configuration.
      * @param coder_config Reference to the coder configuration.
      * @param logger_directory Path to store the log files.
+     * @param compression_task_runner If not null, the task runner on which to compress rotated log
+     *        files.
      */
     FileSink(
         const std::shared_ptr<fly::LoggerConfig> &logger_config,
         const std::shared_ptr<fly::CoderConfig> &coder_config,
-        const std::filesystem::path &logger_directory);
+        const std::filesystem::path &logger_directory,
+        const std::shared_ptr<fly::TaskRunner> &compression_task_runner = nullptr);
+
+    /**
+     * Destructor. Flush any buffered log points to the log file.
+     */
+    ~FileSink() override;
 
     /**
      * Create the initial log file.
@@ -45,8 +70,9 @@ class FileSink : public fly::LogSink
     bool initialize() override;
 
     /**
-     * Stream the given log point to the currently opened file. If the log file has exceeded its
-     * maximum size after streaming, rotate the log file.
+     * Buffer the given log point for the currently opened file, flushing the buffer to the file if
+     * required by the flush policy. If the log file has exceeded its maximum size after streaming,
+     * rotate the log file.
      *
      * @param log The log point to stream.
      *
@@ -54,6 +80,19 @@ class FileSink : public fly::LogSink
      */
     bool stream(fly::Log &&log) override;
 
+    /**
+     * @return If log points are buffered and a flush interval is configured, the time at which the
+     *         buffered log points should be flushed.
+     */
+    std::optional<std::chrono::steady_clock::time_point> flush_deadline() const override;
+
+    /**
+     * Write the buffered log points to the log file and flush the file.
+     *
+     * @return True if the log file is healthy.
+     */
+    bool flush() override;
+
 private:
     /**
      * Create a log file. If a log file is already open, close it.
@@ -62,13 +101,42 @@ class FileSink : public fly::LogSink
      */
     bool create_log_file();
 
+    /**
+     * Compress a rotated log file, either on the compression task runner or synchronously.
+     *
+     * @param log_file Path to the rotated log file.
+     */
+    void compress_log_file(std::filesystem::path log_file);
+
+    /**
+     * Determine whether the buffered log points should be flushed to the log file.
+     *
+     * @param log The most recently buffered log point.
+     *
+     * @return True if the buffer should be flushed.
+     */
+    bool should_flush(const fly::Log &log) const;
+
     std::shared_ptr<fly::LoggerConfig> m_logger_config;
     std::shared_ptr<fly::CoderConfig> m_coder_config;
 
+    std::shared_ptr<fly::TaskRunner> m_compression_task_runner;
+    std::shared_ptr<std::atomic<std::uint32_t>> m_pending_compressions;
+
     const std::filesystem::path m_log_directory;
     std::filesystem::path m_log_file;
     std::ofstream m_log_stream;
     std::uint32_t m_log_index {0};
+
+    std::ostringstream m_buffer;
+    std::uintmax_t m_buffer_size {0};
+    std::chrono::steady_clock::time_point m_buffer_time;
+
+    std::uintmax_t m_log_file_size {0};
+    std::uintmax_t m_max_log_file_size {0};
+    std::uintmax_t m_flush_size {0};
+    std::chrono::milliseconds m_flush_interval {0};
+    bool m_flush_on_error {true};
 };
 
 } // namespace fly::detail
@@ -0,0 +1,174 @@
+#include "fly/logger/detail/log_buffer.hpp"
+
+namespace fly::detail {
+
+namespace {
+
+    /**
+     * A ring buffer registered by the current thread with an instance of ThreadLogBuffers.
+     */
+    struct ThreadBuffer
+    {
+        std::uint64_t m_owner;
+        std::shared_ptr<LogRingBuffer> m_buffer;
+    };
+
+    std::atomic<std::uint64_t> s_next_owner_id {0};
+
+    thread_local std::vector<ThreadBuffer> s_thread_buffers;
+
+    std::size_t round_capacity(std::size_t capacity)
+    {
+        std::size_t rounded = 2;
+
+        while (rounded < capacity)
+        {
+            rounded <<= 1;
+        }
+
+        return rounded;
+    }
+
+} // namespace
+
+//==================================================================================================
+LogRingBuffer::LogRingBuffer(std::size_t capacity) :
+    m_mask(round_capacity(capacity) - 1),
+    m_slots(std::make_unique<Slot[]>(m_mask + 1))
+{
+}
+
+//==================================================================================================
+LogRingBuffer::~LogRingBuffer()
+{
+    const std::size_t tail = m_tail.load();
+
+    for (std::size_t head = m_head.load(); head != tail; ++head)
+    {
+        m_slots[head & m_mask].log()->~BufferedLog();
+    }
+}
+
+//==================================================================================================
+bool LogRingBuffer::try_push(BufferedLog &&log)
+{
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+    if ((tail - m_cached_head) > m_mask)
+    {
+        m_cached_head = m_head.load(std::memory_order_acquire);
+
+        if ((tail - m_cached_head) > m_mask)
+        {
+            return false;
+        }
+    }
+
+    ::new (static_cast<void *>(m_slots[tail & m_mask].m_storage)) BufferedLog(std::move(log));
+    m_tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+//==================================================================================================
+BufferedLog *LogRingBuffer::front()
+{
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+
+    if (head == m_cached_tail)
+    {
+        m_cached_tail = m_tail.load(std::memory_order_acquire);
+
+        if (head == m_cached_tail)
+        {
+            return nullptr;
+        }
+    }
+
+    return m_slots[head & m_mask].log();
+}
+
+//==================================================================================================
+void LogRingBuffer::pop_front()
+{
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+
+    m_slots[head & m_mask].log()->~BufferedLog();
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+//==================================================================================================
+std::size_t LogRingBuffer::size() const
+{
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_relaxed);
+}
+
+//==================================================================================================
+std::size_t LogRingBuffer::capacity() const
+{
+    return m_mask + 1;
+}
+
+//==================================================================================================
+ThreadLogBuffers::ThreadLogBuffers(std::size_t capacity, LogOverflowPolicy policy) :
+    m_id(s_next_owner_id.fetch_add(1)),
+    m_capacity(capacity),
+    m_policy(policy)
+{
+}
+
+//==================================================================================================
+std::size_t ThreadLogBuffers::dropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+//==================================================================================================
+LogRingBuffer &ThreadLogBuffers::buffer_for_current_thread()
+{
+    for (const ThreadBuffer &thread_buffer : s_thread_buffers)
+    {
+        if (thread_buffer.m_owner == m_id)
+        {
+            return *thread_buffer.m_buffer;
+        }
+    }
+
+    // Release any ring buffers whose owners have been destroyed before registering a new one.
+    std::erase_if(
+        s_thread_buffers,
+        [](const ThreadBuffer &thread_buffer)
+        {
+            return thread_buffer.m_buffer.use_count() == 1;
+        });
+
+    auto buffer = std::make_shared<LogRingBuffer>(m_capacity);
+    {
+        std::lock_guard<std::mutex> lock(m_buffers_mutex);
+        m_buffers.push_back(buffer);
+    }
+
+    return *s_thread_buffers.emplace_back(ThreadBuffer {m_id, std::move(buffer)}).m_buffer;
+}
+
+//==================================================================================================
+void ThreadLogBuffers::snapshot_buffers()
+{
+    std::lock_guard<std::mutex> lock(m_buffers_mutex);
+
+    // A ring buffer which is only referenced here belongs to a thread which has exited. Once it has
+    // been drained, it will never be written to again.
+    std::erase_if(
+        m_buffers,
+        [](const std::shared_ptr<LogRingBuffer> &buffer)
+        {
+            return (buffer.use_count() == 1) && (buffer->size() == 0);
+        });
+
+    for (const auto &buffer : m_buffers)
+    {
+        m_draining.push_back({buffer.get(), buffer->size()});
+    }
+}
+
+} // namespace fly::detail
@@ -0,0 +1,335 @@
+#pragma once
+
+#include "fly/logger/detail/log_record.hpp"
+#include "fly/logger/log.hpp"
+#include "fly/logger/logger_config.hpp"
+#include "fly/types/concurrency/detail/wait_notifier.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fly::detail {
+
+/**
+ * A log point which has been made, but not yet handed to a log sink.
+ */
+struct BufferedLog
+{
+    Log::Level m_level;
+    Log::Trace m_trace;
+    LogRecord m_record;
+    std::chrono::high_resolution_clock::time_point m_time;
+
+    // Assigned by the logger's ring buffers to order log points made at the same time.
+    std::uint64_t m_sequence {0};
+};
+
+/**
+ * A bounded, lock-free, single-producer single-consumer ring buffer of log points. The producer and
+ * consumer each own one end of the ring buffer, and cache the position of the other end, so that
+ * neither needs to touch the other's cache line unless the ring buffer appears full or empty.
+ */
+class LogRingBuffer
+{
+public:
+    /**
+     * Constructor. Allocate the ring buffer, rounding the given capacity up to the nearest power
+     * of two.
+     *
+     * @param capacity The minimum number of log points the ring buffer may hold.
+     */
+    explicit LogRingBuffer(std::size_t capacity);
+
+    /**
+     * Destructor. Destroy any log points remaining in the ring buffer.
+     */
+    ~LogRingBuffer();
+
+    LogRingBuffer(const LogRingBuffer &) = delete;
+    LogRingBuffer &operator=(const LogRingBuffer &) = delete;
+
+    /**
+     * Move a log point onto the ring buffer if there is space available. May only be invoked by the
+     * producer. The log point is only moved-from if it was pushed.
+     *
+     * @param log The log point to push.
+     *
+     * @return True if the log point was pushed.
+     */
+    bool try_push(BufferedLog &&log);
+
+    /**
+     * Retrieve the oldest log point in the ring buffer. May only be invoked by the consumer.
+     *
+     * @return The oldest log point, or null if the ring buffer is empty.
+     */
+    BufferedLog *front();
+
+    /**
+     * Destroy the oldest log point in the ring buffer. May only be invoked by the consumer, and
+     * only after front() has returned a log point.
+     */
+    void pop_front();
+
+    /**
+     * @return The number of log points in the ring buffer. May only be invoked by the consumer.
+     */
+    std::size_t size() const;
+
+    /**
+     * @return The maximum number of log points the ring buffer may hold.
+     */
+    std::size_t capacity() const;
+
+private:
+    /**
+     * A single slot in the ring buffer.
+     */
+    struct Slot
+    {
+        alignas(BufferedLog) unsigned char m_storage[sizeof(BufferedLog)];
+
+        BufferedLog *log()
+        {
+            return std::launder(static_cast<BufferedLog *>(static_cast<void *>(m_storage)));
+        }
+    };
+
+    const std::size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(s_cache_line_size) std::atomic<std::size_t> m_tail {0};
+    std::size_t m_cached_head {0};
+
+    alignas(s_cache_line_size) std::atomic<std::size_t> m_head {0};
+    std::size_t m_cached_tail {0};
+};
+
+/**
+ * Class to hold a ring buffer of log points for each thread which logs to a logger. Each producer
+ * thread lazily registers its own ring buffer on its first log point, and thereafter pushes log
+ * points without taking a lock or contending with other producers. A single consumer drains all
+ * ring buffers, merging the log points available at the time of each drain in the order they were
+ * made. Log points made at the same time are ordered by a sequence number assigned as they are
+ * pushed. Log points from a single thread are always consumed in the order that thread made them.
+ *
+ * Ring buffers of threads which have exited are released by the consumer once they are drained.
+ *
+ * Draining is serialized, but is not tied to any one thread. A producer which is blocked by a full
+ * ring buffer drains all ring buffers itself if no other thread is draining them, so that it never
+ * depends on another thread (e.g. a task on a busy task runner) to make space.
+ */
+class ThreadLogBuffers
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param capacity The number of log points each thread's ring buffer may hold.
+     * @param policy The policy applied when a thread's ring buffer is full.
+     */
+    ThreadLogBuffers(std::size_t capacity, LogOverflowPolicy policy);
+
+    /**
+     * Push a log point onto the calling thread's ring buffer. If the ring buffer is full, either
+     * make space, or drop the log point, depending on the overflow policy. To make space, the
+     * calling thread drains the ring buffers with the given consumer, or waits for the thread which
+     * is currently draining them. A thread which is itself draining the ring buffers (e.g. because
+     * the consumer made a log point) cannot make space, and drops the log point.
+     *
+     * @tparam Consumer Callable type of the consumer, accepting a BufferedLog rvalue reference.
+     *
+     * @param log The log point to push.
+     * @param consumer The consumer to invoke for each log point drained by the calling thread.
+     *
+     * @return True if the log point was pushed.
+     */
+    template <typename Consumer>
+    bool push(BufferedLog &&log, Consumer &&consumer);
+
+    /**
+     * Drain the log points which are currently in the ring buffers, handing them to the given
+     * consumer in the order they were made. Log points pushed while draining are left for the next
+     * drain. Blocks while another thread is draining the ring buffers.
+     *
+     * @tparam Consumer Callable type of the consumer, accepting a BufferedLog rvalue reference.
+     *
+     * @param consumer The consumer to invoke for each log point.
+     */
+    template <typename Consumer>
+    void drain(Consumer &&consumer);
+
+    /**
+     * @return The number of log points which have been dropped due to full ring buffers.
+     */
+    std::size_t dropped() const;
+
+private:
+    /**
+     * A ring buffer being drained, and the number of log points to drain from it.
+     */
+    struct DrainingBuffer
+    {
+        LogRingBuffer *m_buffer;
+        std::size_t m_remaining;
+    };
+
+    /**
+     * Drain the log points which are currently in the ring buffers, then release the drain lock
+     * and wake any producers waiting for space.
+     *
+     * @tparam Consumer Callable type of the consumer, accepting a BufferedLog rvalue reference.
+     *
+     * @param lock The held drain lock.
+     * @param consumer The consumer to invoke for each log point.
+     */
+    template <typename Consumer>
+    void drain_locked(std::unique_lock<std::mutex> lock, Consumer &consumer);
+
+    /**
+     * @return The calling thread's ring buffer, registering one if needed.
+     */
+    LogRingBuffer &buffer_for_current_thread();
+
+    /**
+     * Snapshot the registered ring buffers and the number of log points in each of them, releasing
+     * ring buffers of threads which have exited.
+     */
+    void snapshot_buffers();
+
+    static constexpr std::chrono::milliseconds s_wait_interval {1};
+
+    const std::uint64_t m_id;
+    const std::size_t m_capacity;
+    const LogOverflowPolicy m_policy;
+
+    std::mutex m_buffers_mutex;
+    std::vector<std::shared_ptr<LogRingBuffer>> m_buffers;
+
+    std::mutex m_drain_mutex;
+    std::atomic<std::thread::id> m_draining_thread;
+    std::vector<DrainingBuffer> m_draining;
+
+    std::atomic<std::uint64_t> m_drain_count {0};
+    WaitNotifier m_space_notifier;
+
+    std::atomic<std::size_t> m_dropped {0};
+
+    alignas(s_cache_line_size) std::atomic<std::uint64_t> m_sequence {0};
+};
+
+//==================================================================================================
+template <typename Consumer>
+bool ThreadLogBuffers::push(BufferedLog &&log, Consumer &&consumer)
+{
+    LogRingBuffer &buffer = buffer_for_current_thread();
+    log.m_sequence = m_sequence.fetch_add(1, std::memory_order_relaxed);
+
+    if (buffer.try_push(std::move(log)))
+    {
+        return true;
+    }
+    else if (
+        (m_policy == LogOverflowPolicy::Block) &&
+        (m_draining_thread.load() != std::this_thread::get_id()))
+    {
+        do
+        {
+            const std::uint64_t drain_count = m_drain_count.load();
+
+            std::unique_lock<std::mutex> lock(m_drain_mutex, std::try_to_lock);
+
+            if (lock.owns_lock())
+            {
+                drain_locked(std::move(lock), consumer);
+            }
+            else
+            {
+                // The ring buffer will have space once the current drain completes. The wait is
+                // bounded in case the drain lock was only spuriously unavailable.
+                m_space_notifier.wait_for(
+                    [this, drain_count]()
+                    {
+                        return m_drain_count.load() != drain_count;
+                    },
+                    s_wait_interval);
+            }
+        } while (!buffer.try_push(std::move(log)));
+
+        return true;
+    }
+
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+//==================================================================================================
+template <typename Consumer>
+void ThreadLogBuffers::drain(Consumer &&consumer)
+{
+    drain_locked(std::unique_lock<std::mutex>(m_drain_mutex), consumer);
+}
+
+//==================================================================================================
+template <typename Consumer>
+void ThreadLogBuffers::drain_locked(std::unique_lock<std::mutex> lock, Consumer &consumer)
+{
+    m_draining_thread.store(std::this_thread::get_id());
+    snapshot_buffers();
+
+    while (true)
+    {
+        DrainingBuffer *next = nullptr;
+
+        for (auto &draining : m_draining)
+        {
+            if (draining.m_remaining == 0)
+            {
+                continue;
+            }
+            else if (next == nullptr)
+            {
+                next = &draining;
+                continue;
+            }
+
+            const BufferedLog *log = draining.m_buffer->front();
+            const BufferedLog *next_log = next->m_buffer->front();
+
+            if (std::tie(log->m_time, log->m_sequence) <
+                std::tie(next_log->m_time, next_log->m_sequence))
+            {
+                next = &draining;
+            }
+        }
+
+        if (next == nullptr)
+        {
+            break;
+        }
+
+        consumer(std::move(*next->m_buffer->front()));
+
+        next->m_buffer->pop_front();
+        --next->m_remaining;
+    }
+
+    m_draining.clear();
+
+    m_draining_thread.store(std::thread::id());
+    lock.unlock();
+
+    m_drain_count.fetch_add(1);
+    m_space_notifier.notify_all();
+}
+
+} // namespace fly::detail
@@ -0,0 +1,61 @@
+#include "fly/logger/detail/log_record.hpp"
+
+namespace fly::detail {
+
+//==================================================================================================
+LogRecord::LogRecord(std::string &&message) noexcept : m_message(std::move(message))
+{
+}
+
+//==================================================================================================
+bool LogRecord::is_deferred() const
+{
+    return m_formatter != nullptr;
+}
+
+//==================================================================================================
+std::string LogRecord::format()
+{
+    if (is_deferred())
+    {
+        const auto *format = reinterpret_cast<const char *>(storage());
+        return m_formatter(format, storage() + m_format_size);
+    }
+
+    return std::move(m_message);
+}
+
+//==================================================================================================
+std::byte *LogRecord::store_format(const char *format, std::size_t arguments_size)
+{
+    if (arguments_size < s_inline_size)
+    {
+        const std::size_t capacity = s_inline_size - arguments_size;
+
+        for (std::size_t i = 0; i < capacity; ++i)
+        {
+            m_inline_storage[i] = static_cast<std::byte>(format[i]);
+
+            if (format[i] == '\0')
+            {
+                m_format_size = i + 1;
+                return m_inline_storage + m_format_size;
+            }
+        }
+    }
+
+    m_format_size = std::strlen(format) + 1;
+
+    m_heap_storage.reset(new std::byte[m_format_size + arguments_size]);
+    std::memcpy(m_heap_storage.get(), format, m_format_size);
+
+    return m_heap_storage.get() + m_format_size;
+}
+
+//==================================================================================================
+const std::byte *LogRecord::storage() const
+{
+    return m_heap_storage ? m_heap_storage.get() : m_inline_storage;
+}
+
+} // namespace fly::detail
@@ -0,0 +1,304 @@
+#pragma once
+
+#include "fly/fly.hpp"
+#include "fly/types/string/detail/string_traits.hpp"
+#include "fly/types/string/string.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace fly::detail {
+
+/**
+ * Traits for testing whether a log point argument may have its formatting deferred.
+ */
+template <typename T>
+// NOLINTNEXTLINE(readability-identifier-naming)
+inline constexpr bool is_deferrable_string_v =
+    std::is_same_v<is_like_supported_string_t<T>, std::string>;
+
+template <typename T>
+// NOLINTNEXTLINE(readability-identifier-naming)
+inline constexpr bool is_deferrable_argument_v =
+    std::is_arithmetic_v<T> || is_deferrable_string_v<T>;
+
+/**
+ * The message of a log point, either formatted eagerly or stored in a form which may be formatted
+ * later. Deferred records hold a compact binary copy of the log point's format string and
+ * arguments, so that the cost of formatting is paid by whichever thread consumes the record rather
+ * than the thread which made the log point.
+ *
+ * Only arguments which may be copied into the record without changing how they are formatted may
+ * be deferred: arithmetic values and narrow string-like values (std::string, std::string_view, and
+ * C-strings), the latter of which are copied by value. The format string is copied alongside the
+ * arguments, so the record does not depend on the lifetime of any of the log point's inputs. Array
+ * arguments (e.g. string literals) are treated as the pointers they decay to.
+ *
+ * The format string and arguments are stored in an inline buffer if they fit, so that typical log
+ * points are deferred without any heap allocation. Otherwise, they are stored on the heap.
+ */
+class LogRecord
+{
+public:
+    /**
+     * Whether a log point with the given arguments may have its formatting deferred.
+     *
+     * @tparam Args Variadic template arguments.
+     */
+    template <typename... Args>
+    static constexpr bool is_deferrable_v = (is_deferrable_argument_v<std::decay_t<Args>> && ...);
+
+    /**
+     * Constructor. Create a record holding an already formatted message.
+     *
+     * @param message The formatted message.
+     */
+    explicit LogRecord(std::string &&message) noexcept;
+
+    /**
+     * Constructor. Create a deferred record holding a copy of the format string and its arguments.
+     *
+     * @tparam Args Variadic template arguments.
+     *
+     * @param format The format string for the log point.
+     * @param args The variadic list of arguments to augment the format string with.
+     */
+    template <typename... Args>
+    explicit LogRecord(const char *format, const Args &...args);
+
+    /**
+     * Move constructor.
+     */
+    LogRecord(LogRecord &&record) noexcept = default;
+
+    /**
+     * Move assignment operator.
+     */
+    LogRecord &operator=(LogRecord &&record) noexcept = default;
+
+    /**
+     * @return True if the record's message has not yet been formatted.
+     */
+    bool is_deferred() const;
+
+    /**
+     * Retrieve the record's message, formatting the stored arguments if the record is deferred.
+     * The record should not be used afterwards.
+     *
+     * @return The formatted message.
+     */
+    std::string format();
+
+private:
+    using Formatter = std::string (*)(const char *format, const std::byte *arguments);
+
+    /**
+     * The type an argument is decoded as. Arithmetic values are decoded as themselves. String-like
+     * values are decoded as a view into the record, which is formatted the same as the original.
+     */
+    template <typename T>
+    using decoded_type = std::conditional_t<is_deferrable_string_v<T>, std::string_view, T>;
+
+    /**
+     * Convert an argument to the value which is stored in the record.
+     *
+     * @tparam T The type of the argument.
+     *
+     * @param value The argument.
+     *
+     * @return The argument itself, or a view of the argument if it is string-like.
+     */
+    template <typename T>
+    static decoded_type<T> view(const T &value);
+
+    /**
+     * Determine the number of bytes needed to store an argument.
+     *
+     * @tparam T The type of the argument.
+     *
+     * @param value The argument.
+     *
+     * @return The number of bytes needed to store the argument.
+     */
+    template <typename T>
+    static std::size_t encoded_size(const T &value);
+
+    /**
+     * Store an argument at the given location, advancing that location past the stored bytes.
+     *
+     * @tparam T The type of the argument.
+     *
+     * @param data The location to store the argument.
+     * @param value The argument.
+     */
+    template <typename T>
+    static void encode(std::byte *&data, const T &value);
+
+    /**
+     * Load an argument from the given location, advancing that location past the loaded bytes.
+     *
+     * @tparam T The type of the argument.
+     *
+     * @param data The location to load the argument from.
+     *
+     * @return The decoded argument.
+     */
+    template <typename T>
+    static decoded_type<T> decode(const std::byte *&data);
+
+    /**
+     * Decode all stored arguments and format the format string with them.
+     *
+     * @tparam Args Variadic template arguments.
+     *
+     * @param format The format string for the log point.
+     * @param arguments The stored arguments.
+     *
+     * @return The formatted message.
+     */
+    template <typename... Args>
+    static std::string format_arguments(const char *format, const std::byte *arguments);
+
+    /**
+     * Copy the format string into the record's storage, leaving enough space after the format
+     * string for the arguments. The inline buffer is used if both fit, in which case the format
+     * string is measured while it is copied. Otherwise, the storage is allocated on the heap.
+     *
+     * @param format The format string for the log point.
+     * @param arguments_size The number of bytes needed to store the arguments.
+     *
+     * @return The location to store the arguments.
+     */
+    std::byte *store_format(const char *format, std::size_t arguments_size);
+
+    /**
+     * @return The storage holding the format string, followed by the arguments.
+     */
+    const std::byte *storage() const;
+
+    static constexpr std::size_t s_inline_size = 128;
+
+    Formatter m_formatter {nullptr};
+    std::size_t m_format_size {0};
+
+    std::byte m_inline_storage[s_inline_size];
+    std::unique_ptr<std::byte[]> m_heap_storage;
+
+    std::string m_message;
+};
+
+//==================================================================================================
+template <typename... Args>
+LogRecord::LogRecord(const char *format, const Args &...args) :
+    m_formatter(&LogRecord::format_arguments<std::decay_t<Args>...>)
+{
+    static_assert(is_deferrable_v<Args...>, "Log point arguments must be deferrable");
+
+    // The format string, including its null terminator, is stored ahead of the arguments.
+    std::byte *data = store_format(format, (encoded_size(args) + ... + 0));
+
+    (encode(data, args), ...);
+    FLY_UNUSED(data);
+}
+
+//==================================================================================================
+template <typename T>
+auto LogRecord::view(const T &value) -> decoded_type<T>
+{
+    if constexpr (std::is_pointer_v<T>)
+    {
+        return (value == nullptr) ? decoded_type<T>() : decoded_type<T>(value);
+    }
+    else
+    {
+        return decoded_type<T>(value);
+    }
+}
+
+//==================================================================================================
+template <typename T>
+std::size_t LogRecord::encoded_size(const T &value)
+{
+    if constexpr (is_deferrable_string_v<T>)
+    {
+        return sizeof(std::size_t) + view(value).size();
+    }
+    else
+    {
+        return sizeof(T);
+    }
+}
+
+//==================================================================================================
+template <typename T>
+void LogRecord::encode(std::byte *&data, const T &value)
+{
+    if constexpr (is_deferrable_string_v<T>)
+    {
+        const std::string_view string = view(value);
+        const std::size_t size = string.size();
+
+        std::memcpy(data, &size, sizeof(size));
+        data += sizeof(size);
+
+        if (size > 0)
+        {
+            std::memcpy(data, string.data(), size);
+            data += size;
+        }
+    }
+    else
+    {
+        std::memcpy(data, &value, sizeof(T));
+        data += sizeof(T);
+    }
+}
+
+//==================================================================================================
+template <typename T>
+auto LogRecord::decode(const std::byte *&data) -> decoded_type<T>
+{
+    if constexpr (is_deferrable_string_v<T>)
+    {
+        std::size_t size = 0;
+        std::memcpy(&size, data, sizeof(size));
+        data += sizeof(size);
+
+        const auto *string = reinterpret_cast<const char *>(data);
+        data += size;
+
+        return std::string_view(string, size);
+    }
+    else
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+
+        return value;
+    }
+}
+
+//==================================================================================================
+template <typename... Args>
+std::string LogRecord::format_arguments(const char *format, const std::byte *arguments)
+{
+    // Arguments within a braced initializer list are evaluated in order, so the arguments are
+    // decoded in the order they were encoded.
+    std::tuple<decoded_type<Args>...> decoded {decode<Args>(arguments)...};
+    FLY_UNUSED(arguments);
+
+    return std::apply(
+        [format](const auto &...args)
+        {
+            return String::format(format, args...);
+        },
+        decoded);
+}
+
+} // namespace fly::detail
@@ -1,6 +1,8 @@
 SRC_$(d) := \
     $(d)/detail/console_sink.cpp \
     $(d)/detail/file_sink.cpp \
+    $(d)/detail/log_buffer.cpp \
+    $(d)/detail/log_record.cpp \
     $(d)/detail/nix/styler_proxy_impl.cpp \
     $(d)/detail/registry.cpp \
     $(d)/detail/styler_proxy.cpp \
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <optional>
+
 namespace fly {
 
 struct Log;
@@ -35,6 +38,29 @@ class LogSink
      * @return True if the streaming the log point was successful.
      */
     virtual bool stream(Log &&log) = 0;
+
+    /**
+     * Sinks which buffer log points may indicate when their buffered log points are due to be
+     * flushed. Asynchronous loggers schedule a flush of the sink at that time, so that buffered log
+     * points are written even if no further log points are streamed.
+     *
+     * @return If the sink holds buffered log points, the time at which they should be flushed.
+     */
+    virtual std::optional<std::chrono::steady_clock::time_point> flush_deadline() const
+    {
+        return std::nullopt;
+    }
+
+    /**
+     * Flush any buffered log points. If flushing fails, the logger will be stopped and will not
+     * accept any new log points.
+     *
+     * @return True if flushing the buffered log points was successful.
+     */
+    virtual bool flush()
+    {
+        return true;
+    }
 };
 
 } // namespace fly
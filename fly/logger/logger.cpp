@@ -3,12 +3,15 @@
 #include "fly/coders/coder_config.hpp"
 #include "fly/logger/detail/console_sink.hpp"
 #include "fly/logger/detail/file_sink.hpp"
+#include "fly/logger/detail/log_buffer.hpp"
 #include "fly/logger/detail/registry.hpp"
 #include "fly/logger/log.hpp"
 #include "fly/logger/log_sink.hpp"
 #include "fly/logger/logger_config.hpp"
 #include "fly/task/task_runner.hpp"
 
+#include <algorithm>
+
 namespace fly {
 
 //==================================================================================================
@@ -21,8 +24,16 @@ Logger::Logger(
     m_config(config),
     m_sink(std::move(sink)),
     m_task_runner(task_runner),
+    m_min_level(m_config->min_log_level()),
+    m_defer_formatting(m_task_runner && m_config->defer_log_formatting()),
     m_start_time(std::chrono::high_resolution_clock::now())
 {
+    if (m_task_runner && (m_config->log_buffer_size() > 0))
+    {
+        m_buffers = std::make_unique<detail::ThreadLogBuffers>(
+            m_config->log_buffer_size(),
+            m_config->log_buffer_overflow_policy());
+    }
 }
 
 //==================================================================================================
@@ -63,9 +74,16 @@ std::shared_ptr<Logger> Logger::create_file_logger(
     const std::string &name,
     const std::shared_ptr<LoggerConfig> &logger_config,
     const std::shared_ptr<CoderConfig> &coder_config,
-    const std::filesystem::path &logger_directory)
+    const std::filesystem::path &logger_directory,
+    const std::shared_ptr<TaskRunner> &compression_task_runner)
 {
-    return create_file_logger(name, nullptr, logger_config, coder_config, logger_directory);
+    return create_file_logger(
+        name,
+        nullptr,
+        logger_config,
+        coder_config,
+        logger_directory,
+        compression_task_runner);
 }
 
 //==================================================================================================
@@ -74,9 +92,14 @@ std::shared_ptr<Logger> Logger::create_file_logger(
     const std::shared_ptr<SequencedTaskRunner> &task_runner,
     const std::shared_ptr<LoggerConfig> &logger_config,
     const std::shared_ptr<CoderConfig> &coder_config,
-    const std::filesystem::path &logger_directory)
+    const std::filesystem::path &logger_directory,
+    const std::shared_ptr<TaskRunner> &compression_task_runner)
 {
-    auto sink = std::make_unique<detail::FileSink>(logger_config, coder_config, logger_directory);
+    auto sink = std::make_unique<detail::FileSink>(
+        logger_config,
+        coder_config,
+        logger_directory,
+        compression_task_runner);
     return create_logger(name, task_runner, logger_config, std::move(sink));
 }
 
@@ -122,6 +145,18 @@ const std::string &Logger::name() const
     return m_name;
 }
 
+//==================================================================================================
+Log::Level Logger::min_level() const
+{
+    return m_min_level.load(std::memory_order_relaxed);
+}
+
+//==================================================================================================
+void Logger::set_min_level(Log::Level level)
+{
+    m_min_level.store(level, std::memory_order_relaxed);
+}
+
 //==================================================================================================
 bool Logger::initialize()
 {
@@ -135,23 +170,35 @@ bool Logger::initialize()
 }
 
 //==================================================================================================
-void Logger::log(Log::Level level, Log::Trace &&trace, std::string &&message)
+void Logger::log(Log::Level level, Log::Trace &&trace, detail::LogRecord &&record)
 {
-    if (m_last_task_failed || (level < Log::Level::Debug) || (level >= Log::Level::NumLevels))
+    if (m_last_task_failed || !is_enabled(level) || (level >= Log::Level::NumLevels))
     {
         return;
     }
 
     const auto now = std::chrono::high_resolution_clock::now();
 
-    if (m_task_runner)
+    if (m_buffers)
+    {
+        auto consumer = [this](detail::BufferedLog &&log)
+        {
+            drain_to_sink(std::move(log));
+        };
+
+        if (m_buffers->push({level, std::move(trace), std::move(record), now}, std::move(consumer)))
+        {
+            schedule_drain();
+        }
+    }
+    else if (m_task_runner)
     {
-        auto task = [level, trace = std::move(trace), message = std::move(message), now](
+        auto task = [level, trace = std::move(trace), record = std::move(record), now](
                         std::shared_ptr<Logger> self) mutable
         {
             if (!self->m_last_task_failed)
             {
-                self->log_to_sink(level, std::move(trace), std::move(message), now);
+                self->log_to_sink(level, std::move(trace), std::move(record), now);
             }
         };
 
@@ -160,7 +207,54 @@ void Logger::log(Log::Level level, Log::Trace &&trace, std::string &&message)
     }
     else
     {
-        log_to_sink(level, std::move(trace), std::move(message), now);
+        log_to_sink(level, std::move(trace), std::move(record), now);
+    }
+}
+
+//==================================================================================================
+void Logger::schedule_drain()
+{
+    // The pushed log point must be visible to a drain which has already cleared the pending flag,
+    // or this thread must observe the cleared flag and post a new drain. See drain_buffers().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_drain_scheduled.load(std::memory_order_relaxed) || m_drain_scheduled.exchange(true))
+    {
+        return;
+    }
+
+    auto task = [](std::shared_ptr<Logger> self)
+    {
+        self->drain_buffers();
+    };
+
+    std::weak_ptr<Logger> weak_self = shared_from_this();
+
+    if (!m_task_runner->post_task(FROM_HERE, std::move(task), std::move(weak_self)))
+    {
+        m_drain_scheduled.store(false);
+    }
+}
+
+//==================================================================================================
+void Logger::drain_buffers()
+{
+    m_drain_scheduled.store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    m_buffers->drain(
+        [this](detail::BufferedLog &&log)
+        {
+            drain_to_sink(std::move(log));
+        });
+}
+
+//==================================================================================================
+void Logger::drain_to_sink(detail::BufferedLog &&log)
+{
+    if (!m_last_task_failed)
+    {
+        log_to_sink(log.m_level, std::move(log.m_trace), std::move(log.m_record), log.m_time);
     }
 }
 
@@ -168,18 +262,67 @@ void Logger::log(Log::Level level, Log::Trace &&trace, std::string &&message)
 void Logger::log_to_sink(
     Log::Level level,
     Log::Trace &&trace,
-    std::string &&message,
+    detail::LogRecord &&record,
     std::chrono::high_resolution_clock::time_point time)
 {
     const std::chrono::duration<double, std::milli> elapsed = time - m_start_time;
 
-    Log log(std::move(trace), std::move(message), m_config->max_message_size());
+    Log log(std::move(trace), record.format(), m_config->max_message_size());
     log.m_index = m_index++;
     log.m_level = level;
     log.m_time = elapsed.count();
 
     const bool accepted = m_sink->stream(std::move(log));
     m_last_task_failed.store(!accepted);
+
+    if (accepted && m_task_runner)
+    {
+        schedule_flush();
+    }
+}
+
+//==================================================================================================
+void Logger::schedule_flush()
+{
+    const auto deadline = m_sink->flush_deadline();
+
+    if (!deadline)
+    {
+        // The buffered log points were flushed (e.g. the sink reached its flush size), so there is
+        // nothing left for a scheduled flush to write.
+        if (m_flush_handle.is_pending())
+        {
+            m_flush_handle.cancel();
+        }
+    }
+    else if (!m_flush_handle.is_pending())
+    {
+        auto task = [](std::shared_ptr<Logger> self)
+        {
+            self->flush_sink();
+        };
+
+        const auto delay = std::max(
+            *deadline - std::chrono::steady_clock::now(),
+            std::chrono::steady_clock::duration::zero());
+
+        std::weak_ptr<Logger> weak_self = shared_from_this();
+
+        m_flush_handle = m_task_runner->post_task_with_delay(
+            FROM_HERE,
+            std::move(task),
+            std::move(weak_self),
+            delay);
+    }
+}
+
+//==================================================================================================
+void Logger::flush_sink()
+{
+    if (!m_last_task_failed && m_sink->flush_deadline())
+    {
+        m_last_task_failed.store(!m_sink->flush());
+    }
 }
 
 } // namespace fly
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "fly/logger/detail/log_record.hpp"
 #include "fly/logger/detail/logger_macros.hpp"
 #include "fly/logger/log.hpp"
 #include "fly/system/system.hpp"
+#include "fly/task/task_handle.hpp"
 #include "fly/types/string/string.hpp"
 
 #include <atomic>
@@ -12,6 +14,20 @@
 #include <memory>
 #include <string>
 
+/**
+ * The minimum level of log points compiled by the LOG* macros, as the integral value of a log level
+ * (0 = Debug, 1 = Info, 2 = Warn, 3 = Error). Log points below this level are discarded at compile
+ * time, and their arguments are never evaluated. Unless defined otherwise, debug log points are
+ * compiled only for debug builds.
+ */
+#if !defined(FLY_MIN_LOG_LEVEL)
+#    if defined(NDEBUG)
+#        define FLY_MIN_LOG_LEVEL 1
+#    else
+#        define FLY_MIN_LOG_LEVEL 0
+#    endif
+#endif
+
 /**
  * Add a debug log point to the default logger with trace information.
  *
@@ -24,9 +40,17 @@
 #define LOGD(...)                                                                                  \
     do                                                                                             \
     {                                                                                              \
-        fly::Logger::get_default_logger()->debug(                                                  \
-            {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                        \
-            FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                          \
+        if constexpr (fly::Logger::is_compiled(fly::Log::Level::Debug))                            \
+        {                                                                                          \
+            fly::Logger *fly_default_logger = fly::Logger::get_default_logger();                   \
+                                                                                                   \
+            if (fly_default_logger->is_enabled(fly::Log::Level::Debug))                            \
+            {                                                                                      \
+                fly_default_logger->debug(                                                         \
+                    {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                \
+                    FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                  \
+            }                                                                                      \
+        }                                                                                          \
     } while (0)
 
 /**
@@ -41,9 +65,17 @@
 #define LOGI(...)                                                                                  \
     do                                                                                             \
     {                                                                                              \
-        fly::Logger::get_default_logger()->info(                                                   \
-            {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                        \
-            FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                          \
+        if constexpr (fly::Logger::is_compiled(fly::Log::Level::Info))                             \
+        {                                                                                          \
+            fly::Logger *fly_default_logger = fly::Logger::get_default_logger();                   \
+                                                                                                   \
+            if (fly_default_logger->is_enabled(fly::Log::Level::Info))                             \
+            {                                                                                      \
+                fly_default_logger->info(                                                          \
+                    {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                \
+                    FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                  \
+            }                                                                                      \
+        }                                                                                          \
     } while (0)
 
 /**
@@ -58,9 +90,17 @@
 #define LOGW(...)                                                                                  \
     do                                                                                             \
     {                                                                                              \
-        fly::Logger::get_default_logger()->warn(                                                   \
-            {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                        \
-            FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                          \
+        if constexpr (fly::Logger::is_compiled(fly::Log::Level::Warn))                             \
+        {                                                                                          \
+            fly::Logger *fly_default_logger = fly::Logger::get_default_logger();                   \
+                                                                                                   \
+            if (fly_default_logger->is_enabled(fly::Log::Level::Warn))                             \
+            {                                                                                      \
+                fly_default_logger->warn(                                                          \
+                    {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                \
+                    FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                  \
+            }                                                                                      \
+        }                                                                                          \
     } while (0)
 
 /**
@@ -76,10 +116,18 @@
 #define LOGS(...)                                                                                  \
     do                                                                                             \
     {                                                                                              \
-        fly::Logger::get_default_logger()->warn(                                                   \
-            {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                        \
-            FLY_FORMAT_STRING(__VA_ARGS__) ": %s" FLY_FORMAT_ARGS(__VA_ARGS__),                    \
-            fly::System::get_error_string());                                                      \
+        if constexpr (fly::Logger::is_compiled(fly::Log::Level::Warn))                             \
+        {                                                                                          \
+            fly::Logger *fly_default_logger = fly::Logger::get_default_logger();                   \
+                                                                                                   \
+            if (fly_default_logger->is_enabled(fly::Log::Level::Warn))                             \
+            {                                                                                      \
+                fly_default_logger->warn(                                                          \
+                    {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                \
+                    FLY_FORMAT_STRING(__VA_ARGS__) ": %s" FLY_FORMAT_ARGS(__VA_ARGS__),            \
+                    fly::System::get_error_string());                                              \
+            }                                                                                      \
+        }                                                                                          \
     } while (0)
 
 /**
@@ -94,13 +142,23 @@
 #define LOGE(...)                                                                                  \
     do                                                                                             \
     {                                                                                              \
-        fly::Logger::get_default_logger()->error(                                                  \
-            {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                        \
-            FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                          \
+        if constexpr (fly::Logger::is_compiled(fly::Log::Level::Error))                            \
+        {                                                                                          \
+            fly::Logger *fly_default_logger = fly::Logger::get_default_logger();                   \
+                                                                                                   \
+            if (fly_default_logger->is_enabled(fly::Log::Level::Error))                            \
+            {                                                                                      \
+                fly_default_logger->error(                                                         \
+                    {__FILE__, __FUNCTION__, static_cast<std::uint32_t>(__LINE__)},                \
+                    FLY_FORMAT_STRING(__VA_ARGS__) FLY_FORMAT_ARGS(__VA_ARGS__));                  \
+            }                                                                                      \
+        }                                                                                          \
     } while (0)
 
 namespace fly::detail {
+struct BufferedLog;
 class Registry;
+class ThreadLogBuffers;
 } // namespace fly::detail
 
 namespace fly {
@@ -109,6 +167,7 @@ class CoderConfig;
 class LoggerConfig;
 class SequencedTaskRunner;
 class LogSink;
+class TaskRunner;
 
 /**
  * Logging class to provide configurable instrumentation. There are 4 levels of instrumentation:
@@ -128,6 +187,22 @@ class LogSink;
  * Any number of loggers may be created. By default, a synchronous console logger will be used, but
  * callers may override the default logger.
  *
+ * Each logger discards log points below its minimum level before formatting their messages. The
+ * minimum level is read from the logger configuration when the logger is created, and may be
+ * changed afterwards. The LOG* macros additionally discard log points below FLY_MIN_LOG_LEVEL at
+ * compile time, and avoid evaluating the arguments of log points the default logger would discard.
+ *
+ * Asynchronous loggers may be configured to defer formatting log points to their sequence. Such
+ * loggers copy the log point's format string and arguments into a compact record, so callers need
+ * not keep either alive. Log points with arguments which cannot be copied into a record are
+ * formatted immediately.
+ *
+ * Asynchronous loggers may also be configured to buffer log points per thread. Each thread then
+ * pushes its log points onto its own lock-free ring buffer, rather than posting a task for each log
+ * point. The logger's sequence periodically drains all ring buffers, merging the drained log points
+ * in the order they were made. If a ring buffer is full and the overflow policy is to block, the
+ * logging thread drains the ring buffers itself, rather than waiting on the logger's sequence.
+ *
  * The logging macros above may be used to add log points to the default logger. They are useful for
  * providing trace information about the log point (e.g. file name, line number). The logging macros
  * support up to and including 50 format arguments. If more are needed, invoke the logger's public
@@ -181,6 +256,8 @@ class Logger : public std::enable_shared_from_this<Logger>
      * @param logger_config Reference to the logger configuration.
      * @param coder_config Reference to the coder configuration.
      * @param logger_directory Path to store log files.
+     * @param compression_task_runner If not null, the task runner on which to compress rotated log
+     *        files.
      *
      * @return The created logger, or null if the logger could not be initialized.
      */
@@ -188,7 +265,8 @@ class Logger : public std::enable_shared_from_this<Logger>
         const std::string &name,
         const std::shared_ptr<LoggerConfig> &logger_config,
         const std::shared_ptr<CoderConfig> &coder_config,
-        const std::filesystem::path &logger_directory);
+        const std::filesystem::path &logger_directory,
+        const std::shared_ptr<TaskRunner> &compression_task_runner = nullptr);
 
     /**
      * Create an asynchronous file logger.
@@ -198,6 +276,8 @@ class Logger : public std::enable_shared_from_this<Logger>
      * @param logger_config Reference to the logger configuration.
      * @param coder_config Reference to the coder configuration.
      * @param logger_directory Path to store log files.
+     * @param compression_task_runner If not null, the task runner on which to compress rotated log
+     *        files.
      *
      * @return The created logger, or null if the logger could not be initialized.
      */
@@ -206,7 +286,8 @@ class Logger : public std::enable_shared_from_this<Logger>
         const std::shared_ptr<SequencedTaskRunner> &task_runner,
         const std::shared_ptr<LoggerConfig> &logger_config,
         const std::shared_ptr<CoderConfig> &coder_config,
-        const std::filesystem::path &logger_directory);
+        const std::filesystem::path &logger_directory,
+        const std::shared_ptr<TaskRunner> &compression_task_runner = nullptr);
 
     /**
      * Create a synchronous console logger.
@@ -268,6 +349,42 @@ class Logger : public std::enable_shared_from_this<Logger>
      */
     const std::string &name() const;
 
+    /**
+     * Determine whether log points of a level are compiled by the LOG* macros.
+     *
+     * @param level The level of the log point.
+     *
+     * @return True if the level is at or above FLY_MIN_LOG_LEVEL.
+     */
+    static constexpr bool is_compiled(Log::Level level)
+    {
+        return level >= static_cast<Log::Level>(FLY_MIN_LOG_LEVEL);
+    }
+
+    /**
+     * Determine whether log points of a level are accepted by this logger.
+     *
+     * @param level The level of the log point.
+     *
+     * @return True if the level is at or above this logger's minimum level.
+     */
+    bool is_enabled(Log::Level level) const
+    {
+        return level >= m_min_level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return The minimum level of log points accepted by this logger.
+     */
+    Log::Level min_level() const;
+
+    /**
+     * Set the minimum level of log points accepted by this logger.
+     *
+     * @param level The minimum level of log points.
+     */
+    void set_min_level(Log::Level level);
+
     /**
      * Add a debug log point to the logger.
      *
@@ -279,7 +396,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void debug(const char *format, const Args &...args)
     {
-        log(Log::Level::Debug, {}, String::format(format, args...));
+        log(Log::Level::Debug, {}, format, args...);
     }
 
     /**
@@ -294,7 +411,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void debug(Log::Trace &&trace, const char *format, const Args &...args)
     {
-        log(Log::Level::Debug, std::move(trace), String::format(format, args...));
+        log(Log::Level::Debug, std::move(trace), format, args...);
     }
 
     /**
@@ -308,7 +425,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void info(const char *format, const Args &...args)
     {
-        log(Log::Level::Info, {}, String::format(format, args...));
+        log(Log::Level::Info, {}, format, args...);
     }
 
     /**
@@ -323,7 +440,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void info(Log::Trace &&trace, const char *format, const Args &...args)
     {
-        log(Log::Level::Info, std::move(trace), String::format(format, args...));
+        log(Log::Level::Info, std::move(trace), format, args...);
     }
 
     /**
@@ -337,7 +454,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void warn(const char *format, const Args &...args)
     {
-        log(Log::Level::Warn, {}, String::format(format, args...));
+        log(Log::Level::Warn, {}, format, args...);
     }
 
     /**
@@ -352,7 +469,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void warn(Log::Trace &&trace, const char *format, const Args &...args)
     {
-        log(Log::Level::Warn, std::move(trace), String::format(format, args...));
+        log(Log::Level::Warn, std::move(trace), format, args...);
     }
 
     /**
@@ -366,7 +483,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void error(const char *format, const Args &...args)
     {
-        log(Log::Level::Error, {}, String::format(format, args...));
+        log(Log::Level::Error, {}, format, args...);
     }
 
     /**
@@ -381,7 +498,7 @@ class Logger : public std::enable_shared_from_this<Logger>
     template <typename... Args>
     void error(Log::Trace &&trace, const char *format, const Args &...args)
     {
-        log(Log::Level::Error, std::move(trace), String::format(format, args...));
+        log(Log::Level::Error, std::move(trace), format, args...);
     }
 
 private:
@@ -409,6 +526,20 @@ class Logger : public std::enable_shared_from_this<Logger>
      */
     bool initialize();
 
+    /**
+     * Format a log point, or store its arguments for formatting later, if the log point's level is
+     * accepted by this logger.
+     *
+     * @tparam Args Variadic template arguments.
+     *
+     * @param level The level of the log point.
+     * @param trace The trace information for the log point.
+     * @param format The format string for the log point.
+     * @param args The variadic list of arguments to augment the format string with.
+     */
+    template <typename... Args>
+    void log(Log::Level level, Log::Trace &&trace, const char *format, const Args &...args);
+
     /**
      * Add a log point to the logger, optionally with trace information.
      *
@@ -417,24 +548,52 @@ class Logger : public std::enable_shared_from_this<Logger>
      *
      * @param level The level of the log point.
      * @param trace The trace information for the log point.
-     * @param message The message to log.
+     * @param record The message to log.
+     */
+    void log(Log::Level level, Log::Trace &&trace, detail::LogRecord &&record);
+
+    /**
+     * Post a task to drain the per-thread log buffers, if one is not already pending.
+     */
+    void schedule_drain();
+
+    /**
+     * Forward all log points currently in the per-thread log buffers to the log sink.
+     */
+    void drain_buffers();
+
+    /**
+     * Forward a log point drained from the per-thread log buffers to the log sink.
+     *
+     * @param log The drained log point.
      */
-    void log(Log::Level level, Log::Trace &&trace, std::string &&message);
+    void drain_to_sink(detail::BufferedLog &&log);
 
     /**
      * Forward a log point to the log sink.
      *
      * @param level The level of the log point.
      * @param trace The trace information for the log point.
-     * @param message The message to log.
+     * @param record The message to log, formatted if needed.
      * @param time The time the log point was made.
      */
     void log_to_sink(
         Log::Level level,
         Log::Trace &&trace,
-        std::string &&message,
+        detail::LogRecord &&record,
         std::chrono::high_resolution_clock::time_point time);
 
+    /**
+     * Schedule a flush of the log sink at the time its buffered log points are due to be flushed.
+     * If the sink no longer holds any buffered log points, cancel a previously scheduled flush.
+     */
+    void schedule_flush();
+
+    /**
+     * Flush any log points buffered by the log sink.
+     */
+    void flush_sink();
+
     const std::string m_name;
 
     std::shared_ptr<LoggerConfig> m_config;
@@ -443,8 +602,35 @@ class Logger : public std::enable_shared_from_this<Logger>
     std::shared_ptr<SequencedTaskRunner> m_task_runner;
     std::atomic_bool m_last_task_failed {true};
 
+    std::unique_ptr<detail::ThreadLogBuffers> m_buffers;
+    std::atomic_bool m_drain_scheduled {false};
+    TaskHandle m_flush_handle;
+    std::atomic<Log::Level> m_min_level;
+    const bool m_defer_formatting;
+
     const std::chrono::high_resolution_clock::time_point m_start_time;
     std::uintmax_t m_index {0};
 };
 
+//==================================================================================================
+template <typename... Args>
+void Logger::log(Log::Level level, Log::Trace &&trace, const char *format, const Args &...args)
+{
+    if (!is_enabled(level))
+    {
+        return;
+    }
+
+    if constexpr (detail::LogRecord::is_deferrable_v<Args...>)
+    {
+        if (m_defer_formatting)
+        {
+            log(level, std::move(trace), detail::LogRecord(format, args...));
+            return;
+        }
+    }
+
+    log(level, std::move(trace), detail::LogRecord(String::format(format, args...)));
+}
+
 } // namespace fly
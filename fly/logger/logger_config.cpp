@@ -8,6 +8,14 @@ bool LoggerConfig::compress_log_files() const
     return get_value<bool>("compress_log_files", m_default_compress_log_files);
 }
 
+//==================================================================================================
+std::uint32_t LoggerConfig::max_pending_log_compressions() const
+{
+    return get_value<std::uint32_t>(
+        "max_pending_log_compressions",
+        m_default_max_pending_log_compressions);
+}
+
 //==================================================================================================
 std::uintmax_t LoggerConfig::max_log_file_size() const
 {
@@ -20,4 +28,72 @@ std::uint32_t LoggerConfig::max_message_size() const
     return get_value<std::uint32_t>("max_message_size", m_default_max_message_size);
 }
 
+//==================================================================================================
+Log::Level LoggerConfig::min_log_level() const
+{
+    const std::string level = get_value<std::string>("min_log_level", m_default_min_log_level);
+
+    if (level == "info")
+    {
+        return Log::Level::Info;
+    }
+    else if (level == "warn")
+    {
+        return Log::Level::Warn;
+    }
+    else if (level == "error")
+    {
+        return Log::Level::Error;
+    }
+
+    return Log::Level::Debug;
+}
+
+//==================================================================================================
+bool LoggerConfig::defer_log_formatting() const
+{
+    return get_value<bool>("defer_log_formatting", m_default_defer_log_formatting);
+}
+
+//==================================================================================================
+std::uint32_t LoggerConfig::log_buffer_size() const
+{
+    return get_value<std::uint32_t>("log_buffer_size", m_default_log_buffer_size);
+}
+
+//==================================================================================================
+LogOverflowPolicy LoggerConfig::log_buffer_overflow_policy() const
+{
+    const std::string policy = get_value<std::string>(
+        "log_buffer_overflow_policy",
+        m_default_log_buffer_overflow_policy);
+
+    if (policy == "drop")
+    {
+        return LogOverflowPolicy::Drop;
+    }
+
+    return LogOverflowPolicy::Block;
+}
+
+//==================================================================================================
+std::uintmax_t LoggerConfig::log_flush_size() const
+{
+    return get_value<std::uintmax_t>("log_flush_size", m_default_log_flush_size);
+}
+
+//==================================================================================================
+std::chrono::milliseconds LoggerConfig::log_flush_interval() const
+{
+    return std::chrono::milliseconds(get_value<std::chrono::milliseconds::rep>(
+        "log_flush_interval",
+        m_default_log_flush_interval));
+}
+
+//==================================================================================================
+bool LoggerConfig::flush_on_error() const
+{
+    return get_value<bool>("flush_on_error", m_default_flush_on_error);
+}
+
 } // namespace fly
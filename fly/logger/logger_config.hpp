@@ -1,12 +1,27 @@
 #pragma once
 
 #include "fly/config/config.hpp"
+#include "fly/logger/log.hpp"
 #include "fly/types/numeric/literals.hpp"
 
+#include <chrono>
 #include <cstdint>
+#include <string>
 
 namespace fly {
 
+/**
+ * Policy applied when a thread's log buffer is full.
+ */
+enum class LogOverflowPolicy : std::uint8_t
+{
+    // Block the logging thread until there is space in the buffer, draining it if needed.
+    Block,
+
+    // Drop the log point.
+    Drop,
+};
+
 /**
  * Class to hold configuration values related to the logger.
  *
@@ -23,6 +38,13 @@ class LoggerConfig : public Config
      */
     bool compress_log_files() const;
 
+    /**
+     * @return Max number of rotated log files which may be pending compression on a file sink's
+     *         compression task runner. Once reached, rotated log files are compressed synchronously
+     *         until the backlog drains. A value of zero always compresses synchronously.
+     */
+    std::uint32_t max_pending_log_compressions() const;
+
     /**
      * @return Max log file size (in bytes) before rotating the log file.
      */
@@ -33,10 +55,62 @@ class LoggerConfig : public Config
      */
     std::uint32_t max_message_size() const;
 
+    /**
+     * @return The minimum level of log points accepted by the logger. Log points below this level
+     *         are discarded before their messages are formatted. Configured as one of "debug",
+     *         "info", "warn", or "error".
+     */
+    Log::Level min_log_level() const;
+
+    /**
+     * @return True if asynchronous loggers should defer formatting log points to their sequence,
+     *         rather than formatting log points on the thread which made them.
+     */
+    bool defer_log_formatting() const;
+
+    /**
+     * @return The number of log points each thread may buffer for an asynchronous logger before
+     *         the overflow policy is applied. A value of zero disables per-thread buffers, in which
+     *         case a task is posted to the logger's sequence for each log point.
+     */
+    std::uint32_t log_buffer_size() const;
+
+    /**
+     * @return The policy applied when a thread's log buffer is full. Configured as one of "block"
+     *         or "drop".
+     */
+    LogOverflowPolicy log_buffer_overflow_policy() const;
+
+    /**
+     * @return Number of bytes file sinks may buffer before flushing the log file. A value
+     *         of zero flushes the log file after every log point.
+     */
+    std::uintmax_t log_flush_size() const;
+
+    /**
+     * @return Maximum time file sinks may buffer a log point before flushing the log file. For
+     *         synchronous loggers, this is only checked as log points are streamed. A value of zero
+     *         disables flushing by interval.
+     */
+    std::chrono::milliseconds log_flush_interval() const;
+
+    /**
+     * @return True if file sinks should flush the log file after every error-level log point.
+     */
+    bool flush_on_error() const;
+
 protected:
     bool m_default_compress_log_files {true};
+    std::uint32_t m_default_max_pending_log_compressions {4};
     std::uintmax_t m_default_max_log_file_size {20_u64 << 20};
     std::uint32_t m_default_max_message_size {256};
+    std::string m_default_min_log_level {"debug"};
+    bool m_default_defer_log_formatting {false};
+    std::uint32_t m_default_log_buffer_size {0};
+    std::string m_default_log_buffer_overflow_policy {"block"};
+    std::uintmax_t m_default_log_flush_size {0};
+    std::chrono::milliseconds::rep m_default_log_flush_interval {0};
+    bool m_default_flush_on_error {true};
 };
 
 } // namespace fly
@@ -177,8 +177,8 @@ class PathMonitor : public std::enable_shared_from_this<PathMonitor>
     PathInfo *get_or_create_path_info(const std::filesystem::path &path);
 
     /**
-     * Queue a task to poll monitored paths. When the task is completed, it re-arms itself (if the
-     * path monitor is still in a valid state).
+     * Queue a blocking task to poll monitored paths. When the task is completed, it re-arms itself
+     * (if the path monitor is still in a valid state).
      *
      * @return True if task was able to be queued.
      */
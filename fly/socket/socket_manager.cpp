@@ -143,7 +143,7 @@ void SocketManager::poll_sockets_later()
     };
 
     std::weak_ptr<SocketManager> weak_self = shared_from_this();
-    m_task_runner->post_task(FROM_HERE, std::move(task), std::move(weak_self));
+    m_task_runner->post_blocking_task(FROM_HERE, std::move(task), std::move(weak_self));
 }
 
 } // namespace fly
@@ -137,7 +137,8 @@ class SocketManager : public std::enable_shared_from_this<SocketManager>
 
 private:
     /**
-     * Queue a task to poll aynchronous sockets. When the task is completed, it re-arms itself.
+     * Queue a blocking task to poll aynchronous sockets. When the task is completed, it re-arms
+     * itself.
      *
      * @return True if task was able to be queued.
      */
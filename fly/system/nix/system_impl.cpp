@@ -1,8 +1,15 @@
 #include "fly/system/nix/system_impl.hpp"
 
+#include "fly/fly.hpp"
+
 #include <execinfo.h>
+#include <pthread.h>
 #include <unistd.h>
 
+#if defined(FLY_LINUX)
+#    include <sched.h>
+#endif
+
 #include <cerrno>
 #include <chrono>
 #include <cstring>
@@ -49,4 +56,39 @@ int SystemImpl::get_error_code()
     return errno;
 }
 
+//==================================================================================================
+bool SystemImpl::set_thread_name(const std::string &name)
+{
+#if defined(FLY_LINUX)
+    // Linux limits thread names to 16 characters, including the null terminator.
+    static constexpr std::size_t s_max_name_length = 15;
+
+    const std::string truncated = name.substr(0, s_max_name_length);
+    return ::pthread_setname_np(::pthread_self(), truncated.c_str()) == 0;
+#else
+    return ::pthread_setname_np(name.c_str()) == 0;
+#endif
+}
+
+//==================================================================================================
+bool SystemImpl::set_thread_affinity(std::uint32_t cpu)
+{
+#if defined(FLY_LINUX)
+    if (cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    // macOS does not support pinning threads to CPUs.
+    FLY_UNUSED(cpu);
+    return false;
+#endif
+}
+
 } // namespace fly
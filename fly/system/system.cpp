@@ -57,6 +57,18 @@ void System::set_signal_handler(SignalHandler handler)
     }
 }
 
+//==================================================================================================
+bool System::set_thread_name(const std::string &name)
+{
+    return SystemImpl::set_thread_name(name);
+}
+
+//==================================================================================================
+bool System::set_thread_affinity(std::uint32_t cpu)
+{
+    return SystemImpl::set_thread_affinity(cpu);
+}
+
 //==================================================================================================
 void System::handle_signal(int signal)
 {
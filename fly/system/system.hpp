@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -52,6 +53,27 @@ class System
      */
     static void set_signal_handler(SignalHandler handler);
 
+    /**
+     * Set the name of the calling thread, as shown by system tools such as top and perf. Some
+     * systems limit the length of thread names (e.g. to 15 characters on Linux), in which case the
+     * name is truncated.
+     *
+     * @param name The name to give the calling thread.
+     *
+     * @return True if the thread name was set.
+     */
+    static bool set_thread_name(const std::string &name);
+
+    /**
+     * Pin the calling thread to a single CPU, so that the thread is not migrated between CPUs by
+     * the scheduler. Not supported on macOS.
+     *
+     * @param cpu The index of the CPU to pin the calling thread to.
+     *
+     * @return True if the thread was pinned.
+     */
+    static bool set_thread_affinity(std::uint32_t cpu);
+
 private:
     /**
      * Signal handler to intercept raised signal and forward to the user specified signal handler.
@@ -87,11 +87,13 @@ bool SystemMonitor::poll_system_later()
     };
 
     std::weak_ptr<SystemMonitor> weak_self = shared_from_this();
-    return m_task_runner->post_task_with_delay(
+    TaskHandle handle = m_task_runner->post_task_with_delay(
         FROM_HERE,
         std::move(task),
         std::move(weak_self),
         m_config->poll_interval());
+
+    return handle.valid();
 }
 
 } // namespace fly
@@ -47,4 +47,23 @@ int SystemImpl::get_error_code()
     return ::GetLastError();
 }
 
+//==================================================================================================
+bool SystemImpl::set_thread_name(const std::string &name)
+{
+    const std::wstring wide_name(name.begin(), name.end());
+    return SUCCEEDED(::SetThreadDescription(::GetCurrentThread(), wide_name.c_str()));
+}
+
+//==================================================================================================
+bool SystemImpl::set_thread_affinity(std::uint32_t cpu)
+{
+    if (cpu >= (sizeof(DWORD_PTR) * 8))
+    {
+        return false;
+    }
+
+    const DWORD_PTR mask = static_cast<DWORD_PTR>(1) << cpu;
+    return ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0;
+}
+
 } // namespace fly
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <csignal>
+#include <cstdint>
 #include <string>
 
 namespace fly {
@@ -18,6 +19,8 @@ class SystemImpl
     static void print_backtrace();
     static std::string local_time(const char *fmt);
     static int get_error_code();
+    static bool set_thread_name(const std::string &name);
+    static bool set_thread_affinity(std::uint32_t cpu);
 
     static constexpr std::array<int, 6> fatal_signals()
     {
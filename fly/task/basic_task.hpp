@@ -0,0 +1,300 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fly {
+
+template <typename Signature, std::size_t InlineSize>
+class BasicTask;
+
+/**
+ * A move-only, type-erased wrapper around any callable type, similar to std::function. Unlike
+ * std::function, the wrapped callable is not required to be copyable, and callables which fit
+ * within the inline storage buffer are stored without any heap allocation.
+ *
+ * A callable is stored inline if its size does not exceed the size of the inline buffer, its
+ * alignment does not exceed that of std::max_align_t, and it is nothrow move constructible.
+ * Otherwise, the callable is stored on the heap.
+ *
+ * @tparam Result The return type of the callable.
+ * @tparam Args Variadic list of argument types of the callable.
+ * @tparam InlineSize The size (in bytes) of the inline storage buffer.
+ */
+template <typename Result, typename... Args, std::size_t InlineSize>
+class BasicTask<Result(Args...), InlineSize>
+{
+    template <typename Callable>
+    static constexpr bool s_is_stored_inline = (sizeof(Callable) <= InlineSize) &&
+        (alignof(Callable) <= alignof(std::max_align_t)) &&
+        std::is_nothrow_move_constructible_v<Callable>;
+
+    template <typename Callable>
+    using enable_if_callable = std::enable_if_t<
+        !std::is_same_v<std::decay_t<Callable>, BasicTask> &&
+        !std::is_same_v<std::decay_t<Callable>, std::nullptr_t> &&
+        std::is_invocable_r_v<Result, std::decay_t<Callable> &, Args...>>;
+
+public:
+    /**
+     * Default constructor. Creates an empty task.
+     */
+    BasicTask() noexcept = default;
+
+    /**
+     * Constructor. Creates an empty task.
+     */
+    BasicTask(std::nullptr_t) noexcept;
+
+    /**
+     * Constructor. Store the given callable, either inline or on the heap.
+     *
+     * @tparam Callable The type of the callable to store.
+     *
+     * @param callable The callable to store.
+     */
+    template <typename Callable, typename = enable_if_callable<Callable>>
+    BasicTask(Callable &&callable);
+
+    /**
+     * Move constructor. The moved-from task is left empty.
+     *
+     * @param task The task to move.
+     */
+    BasicTask(BasicTask &&task) noexcept;
+
+    /**
+     * Destructor. Destroy the stored callable, if any.
+     */
+    ~BasicTask();
+
+    /**
+     * Move assignment operator. The moved-from task is left empty.
+     *
+     * @param task The task to move.
+     *
+     * @return A reference to this task.
+     */
+    BasicTask &operator=(BasicTask &&task) noexcept;
+
+    /**
+     * Destroy the stored callable, if any, leaving this task empty.
+     *
+     * @return A reference to this task.
+     */
+    BasicTask &operator=(std::nullptr_t) noexcept;
+
+    BasicTask(const BasicTask &) = delete;
+    BasicTask &operator=(const BasicTask &) = delete;
+
+    /**
+     * Invoke the stored callable. The task must not be empty.
+     *
+     * @param args The arguments to invoke the callable with.
+     *
+     * @return The result of invoking the callable.
+     */
+    Result operator()(Args... args);
+
+    /**
+     * @return True if this task is not empty.
+     */
+    explicit operator bool() const noexcept;
+
+    /**
+     * @return True if the given task is empty.
+     */
+    friend bool operator==(const BasicTask &task, std::nullptr_t) noexcept
+    {
+        return task.m_operations == nullptr;
+    }
+
+    /**
+     * @return True if the given task is not empty.
+     */
+    friend bool operator!=(const BasicTask &task, std::nullptr_t) noexcept
+    {
+        return task.m_operations != nullptr;
+    }
+
+private:
+    /**
+     * Table of type-erased operations for a stored callable type.
+     */
+    struct Operations
+    {
+        Result (*m_invoke)(void *storage, Args &&...args);
+        void (*m_move)(void *source, void *destination) noexcept;
+        void (*m_destroy)(void *storage) noexcept;
+    };
+
+    /**
+     * Operations for callables stored inline.
+     */
+    template <typename Callable>
+    struct InlineOperations
+    {
+        static Result invoke(void *storage, Args &&...args)
+        {
+            return std::invoke(*static_cast<Callable *>(storage), std::forward<Args>(args)...);
+        }
+
+        static void move(void *source, void *destination) noexcept
+        {
+            auto *callable = static_cast<Callable *>(source);
+
+            ::new (destination) Callable(std::move(*callable));
+            callable->~Callable();
+        }
+
+        static void destroy(void *storage) noexcept
+        {
+            static_cast<Callable *>(storage)->~Callable();
+        }
+
+        static constexpr Operations s_operations {&invoke, &move, &destroy};
+    };
+
+    /**
+     * Operations for callables stored on the heap. The inline storage holds a pointer to the
+     * callable.
+     */
+    template <typename Callable>
+    struct HeapOperations
+    {
+        static Callable *&pointer(void *storage) noexcept
+        {
+            return *static_cast<Callable **>(storage);
+        }
+
+        static Result invoke(void *storage, Args &&...args)
+        {
+            return std::invoke(*pointer(storage), std::forward<Args>(args)...);
+        }
+
+        static void move(void *source, void *destination) noexcept
+        {
+            ::new (destination) Callable *(pointer(source));
+        }
+
+        static void destroy(void *storage) noexcept
+        {
+            delete pointer(storage);
+        }
+
+        static constexpr Operations s_operations {&invoke, &move, &destroy};
+    };
+
+    /**
+     * Destroy the stored callable, if any, leaving this task empty.
+     */
+    void reset() noexcept;
+
+    alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+    const Operations *m_operations {nullptr};
+};
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+BasicTask<Result(Args...), InlineSize>::BasicTask(std::nullptr_t) noexcept
+{
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+template <typename Callable, typename>
+BasicTask<Result(Args...), InlineSize>::BasicTask(Callable &&callable)
+{
+    using CallableType = std::decay_t<Callable>;
+    static_assert(InlineSize >= sizeof(CallableType *));
+
+    if constexpr (s_is_stored_inline<CallableType>)
+    {
+        ::new (static_cast<void *>(m_storage)) CallableType(std::forward<Callable>(callable));
+        m_operations = &InlineOperations<CallableType>::s_operations;
+    }
+    else
+    {
+        auto *stored = new CallableType(std::forward<Callable>(callable));
+
+        ::new (static_cast<void *>(m_storage)) CallableType *(stored);
+        m_operations = &HeapOperations<CallableType>::s_operations;
+    }
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+BasicTask<Result(Args...), InlineSize>::BasicTask(BasicTask &&task) noexcept :
+    m_operations(task.m_operations)
+{
+    if (m_operations != nullptr)
+    {
+        m_operations->m_move(task.m_storage, m_storage);
+        task.m_operations = nullptr;
+    }
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+BasicTask<Result(Args...), InlineSize>::~BasicTask()
+{
+    reset();
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+auto BasicTask<Result(Args...), InlineSize>::operator=(BasicTask &&task) noexcept -> BasicTask &
+{
+    if (this != &task)
+    {
+        reset();
+
+        if (task.m_operations != nullptr)
+        {
+            task.m_operations->m_move(task.m_storage, m_storage);
+            m_operations = task.m_operations;
+            task.m_operations = nullptr;
+        }
+    }
+
+    return *this;
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+auto BasicTask<Result(Args...), InlineSize>::operator=(std::nullptr_t) noexcept -> BasicTask &
+{
+    reset();
+    return *this;
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+Result BasicTask<Result(Args...), InlineSize>::operator()(Args... args)
+{
+    return m_operations->m_invoke(m_storage, std::forward<Args>(args)...);
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+BasicTask<Result(Args...), InlineSize>::operator bool() const noexcept
+{
+    return m_operations != nullptr;
+}
+
+//==================================================================================================
+template <typename Result, typename... Args, std::size_t InlineSize>
+void BasicTask<Result(Args...), InlineSize>::reset() noexcept
+{
+    if (m_operations != nullptr)
+    {
+        m_operations->m_destroy(m_storage);
+        m_operations = nullptr;
+    }
+}
+
+} // namespace fly
@@ -0,0 +1,111 @@
+#include "fly/task/task_config.hpp"
+
+namespace fly {
+
+//==================================================================================================
+bool TaskConfig::work_stealing() const
+{
+    return get_value<bool>("work_stealing", m_default_work_stealing);
+}
+
+//==================================================================================================
+std::uint32_t TaskConfig::sequenced_batch_size() const
+{
+    return get_value<std::uint32_t>("sequenced_batch_size", m_default_sequenced_batch_size);
+}
+
+//==================================================================================================
+std::chrono::microseconds TaskConfig::sequenced_batch_duration() const
+{
+    return std::chrono::microseconds(get_value<std::chrono::microseconds::rep>(
+        "sequenced_batch_duration",
+        m_default_sequenced_batch_duration));
+}
+
+//==================================================================================================
+bool TaskConfig::instrument_tasks() const
+{
+    return get_value<bool>("instrument_tasks", m_default_instrument_tasks);
+}
+
+//==================================================================================================
+bool TaskConfig::trace_tasks() const
+{
+    return get_value<bool>("trace_tasks", m_default_trace_tasks);
+}
+
+//==================================================================================================
+std::uint32_t TaskConfig::trace_buffer_size() const
+{
+    return get_value<std::uint32_t>("trace_buffer_size", m_default_trace_buffer_size);
+}
+
+//==================================================================================================
+std::uint32_t TaskConfig::max_blocking_threads() const
+{
+    return get_value<std::uint32_t>("max_blocking_threads", m_default_max_blocking_threads);
+}
+
+//==================================================================================================
+std::chrono::milliseconds TaskConfig::blocking_thread_idle_timeout() const
+{
+    return std::chrono::milliseconds(get_value<std::chrono::milliseconds::rep>(
+        "blocking_thread_idle_timeout",
+        m_default_blocking_thread_idle_timeout));
+}
+
+//==================================================================================================
+std::uint32_t TaskConfig::max_workers() const
+{
+    return get_value<std::uint32_t>("max_workers", m_default_max_workers);
+}
+
+//==================================================================================================
+std::chrono::microseconds TaskConfig::worker_spawn_latency() const
+{
+    return std::chrono::microseconds(get_value<std::chrono::microseconds::rep>(
+        "worker_spawn_latency",
+        m_default_worker_spawn_latency));
+}
+
+//==================================================================================================
+std::chrono::milliseconds TaskConfig::worker_idle_timeout() const
+{
+    return std::chrono::milliseconds(get_value<std::chrono::milliseconds::rep>(
+        "worker_idle_timeout",
+        m_default_worker_idle_timeout));
+}
+
+//==================================================================================================
+std::vector<std::uint32_t> TaskConfig::worker_cpu_affinity() const
+{
+    return get_value<std::vector<std::uint32_t>>(
+        "worker_cpu_affinity",
+        m_default_worker_cpu_affinity);
+}
+
+//==================================================================================================
+std::size_t TaskConfig::max_queued_tasks() const
+{
+    return get_value<std::size_t>("max_queued_tasks", m_default_max_queued_tasks);
+}
+
+//==================================================================================================
+TaskQueuePolicy TaskConfig::queue_overflow_policy() const
+{
+    const std::string policy =
+        get_value<std::string>("queue_overflow_policy", m_default_queue_overflow_policy);
+
+    if (policy == "block")
+    {
+        return TaskQueuePolicy::Block;
+    }
+    else if (policy == "drop_oldest")
+    {
+        return TaskQueuePolicy::DropOldest;
+    }
+
+    return TaskQueuePolicy::Reject;
+}
+
+} // namespace fly
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "fly/config/config.hpp"
+#include "fly/task/task_queue_limit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fly {
+
+/**
+ * Class to hold configuration values related to the task system.
+ *
+ * Configuration values are read when the task manager is started, or when a task runner is created
+ * for values specific to task runners; updates to the configuration after that point will not
+ * affect an already running task manager or already created task runners.
+ */
+class TaskConfig : public Config
+{
+public:
+    static constexpr const char *identifier = "task";
+
+    /**
+     * @return True if each worker thread should own a local task queue, and steal tasks from other
+     *         worker threads when idle.
+     */
+    bool work_stealing() const;
+
+    /**
+     * @return The maximum number of pending tasks a sequenced task runner may execute in order on
+     *         a single worker thread before yielding that worker thread to other tasks.
+     */
+    std::uint32_t sequenced_batch_size() const;
+
+    /**
+     * @return The maximum amount of time a sequenced task runner may spend executing a batch of
+     *         pending tasks on a single worker thread. A value of zero disables the time budget.
+     */
+    std::chrono::microseconds sequenced_batch_duration() const;
+
+    /**
+     * @return True if the task manager should record the queueing delay and execution time of
+     *         every task it executes.
+     */
+    bool instrument_tasks() const;
+
+    /**
+     * @return True if the task manager should record a trace of the execution of every task.
+     */
+    bool trace_tasks() const;
+
+    /**
+     * @return The maximum number of executed tasks retained in the trace for each worker thread.
+     */
+    std::uint32_t trace_buffer_size() const;
+
+    /**
+     * @return The maximum number of threads the task manager may create to execute blocking
+     *         tasks.
+     */
+    std::uint32_t max_blocking_threads() const;
+
+    /**
+     * @return The amount of time a thread created to execute blocking tasks may remain idle before
+     *         it exits.
+     */
+    std::chrono::milliseconds blocking_thread_idle_timeout() const;
+
+    /**
+     * @return The maximum number of worker threads the task manager may create when its queues
+     *         back up. If not greater than the task manager's initial number of worker threads,
+     *         the worker pool has a fixed size.
+     */
+    std::uint32_t max_workers() const;
+
+    /**
+     * @return The amount of time a task may remain queued, while no worker thread is idle, before
+     *         the task manager creates an additional worker thread.
+     */
+    std::chrono::microseconds worker_spawn_latency() const;
+
+    /**
+     * @return The amount of time an additional worker thread may remain idle before it exits.
+     */
+    std::chrono::milliseconds worker_idle_timeout() const;
+
+    /**
+     * @return The CPUs to pin worker threads to. Each worker thread is pinned to a single CPU from
+     *         this list, assigned in order of the worker threads' indices, wrapping around if there
+     *         are more worker threads than CPUs. If empty, worker threads are not pinned.
+     */
+    std::vector<std::uint32_t> worker_cpu_affinity() const;
+
+    /**
+     * @return The maximum number of tasks which may be queued in the task manager's shared queues
+     *         before the overflow policy is applied. A value of zero leaves the queues unbounded.
+     */
+    std::size_t max_queued_tasks() const;
+
+    /**
+     * @return The policy applied when tasks are posted while the task manager's shared queues are
+     *         at capacity. Configured as one of "block", "reject", or "drop_oldest".
+     */
+    TaskQueuePolicy queue_overflow_policy() const;
+
+protected:
+    bool m_default_work_stealing {false};
+    std::uint32_t m_default_sequenced_batch_size {1};
+    std::chrono::microseconds::rep m_default_sequenced_batch_duration {0};
+    bool m_default_instrument_tasks {false};
+    bool m_default_trace_tasks {false};
+    std::uint32_t m_default_trace_buffer_size {4096};
+    std::uint32_t m_default_max_blocking_threads {64};
+    std::chrono::milliseconds::rep m_default_blocking_thread_idle_timeout {10000};
+    std::uint32_t m_default_max_workers {0};
+    std::chrono::microseconds::rep m_default_worker_spawn_latency {1000};
+    std::chrono::milliseconds::rep m_default_worker_idle_timeout {10000};
+    std::vector<std::uint32_t> m_default_worker_cpu_affinity;
+    std::size_t m_default_max_queued_tasks {0};
+    std::string m_default_queue_overflow_policy {"reject"};
+};
+
+} // namespace fly
@@ -0,0 +1,226 @@
+#include "fly/task/task_coroutine.hpp"
+
+#include "fly/task/task_runner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <new>
+
+namespace fly {
+
+namespace {
+
+    // Coroutine frames are cached in power-of-two size classes from 64 bytes to 4 kilobytes.
+    constexpr const std::size_t s_min_frame_size_bits = 6;
+    constexpr const std::size_t s_num_size_classes = 7;
+
+    // The maximum number of frames cached per size class on each thread.
+    constexpr const std::size_t s_max_cached_frames = 16;
+
+    /**
+     * A freed coroutine frame, linked into its size class's free list.
+     */
+    struct FreeFrame
+    {
+        FreeFrame *m_next;
+    };
+
+    /**
+     * Per-thread cache of freed coroutine frames. This structure is trivially destructible so that
+     * it remains usable while other thread-local objects are destroyed; the cached frames are freed
+     * by the FrameCacheCleaner below.
+     */
+    struct FrameCache
+    {
+        std::array<FreeFrame *, s_num_size_classes> m_frames;
+        std::array<std::size_t, s_num_size_classes> m_counts;
+        bool m_disabled;
+    };
+
+    thread_local FrameCache s_frame_cache {};
+
+    /**
+     * Free the frames cached by a thread when that thread exits, and disable caching for any frames
+     * freed afterwards.
+     */
+    struct FrameCacheCleaner
+    {
+        ~FrameCacheCleaner()
+        {
+            s_frame_cache.m_disabled = true;
+
+            for (FreeFrame *&frames : s_frame_cache.m_frames)
+            {
+                while (frames != nullptr)
+                {
+                    ::operator delete(std::exchange(frames, frames->m_next));
+                }
+            }
+        }
+    };
+
+    thread_local FrameCacheCleaner s_frame_cache_cleaner;
+
+    /**
+     * @return The size class of a frame of the given size. Frames too large to be cached have a
+     *         size class of s_num_size_classes.
+     */
+    std::size_t size_class(std::size_t size)
+    {
+        const std::size_t min_size = std::size_t(1) << s_min_frame_size_bits;
+        const auto bits = static_cast<std::size_t>(std::bit_width(std::max(size, min_size) - 1));
+
+        return std::min(bits - s_min_frame_size_bits, s_num_size_classes);
+    }
+
+} // namespace
+
+//==================================================================================================
+void *detail::CoroutineFrameAllocator::allocate(std::size_t size)
+{
+    const std::size_t index = size_class(size);
+
+    if (index == s_num_size_classes)
+    {
+        return ::operator new(size);
+    }
+
+    if (FreeFrame *frame = s_frame_cache.m_frames[index]; frame != nullptr)
+    {
+        s_frame_cache.m_frames[index] = frame->m_next;
+        --s_frame_cache.m_counts[index];
+
+        return frame;
+    }
+
+    return ::operator new(std::size_t(1) << (index + s_min_frame_size_bits));
+}
+
+//==================================================================================================
+void detail::CoroutineFrameAllocator::deallocate(void *frame, std::size_t size) noexcept
+{
+    const std::size_t index = size_class(size);
+
+    if ((index == s_num_size_classes) || s_frame_cache.m_disabled ||
+        (s_frame_cache.m_counts[index] == s_max_cached_frames))
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    // Ensure the cached frames are freed when this thread exits.
+    static_cast<void>(&s_frame_cache_cleaner);
+
+    s_frame_cache.m_frames[index] = ::new (frame) FreeFrame {s_frame_cache.m_frames[index]};
+    ++s_frame_cache.m_counts[index];
+}
+
+//==================================================================================================
+detail::CoroutineResumer::CoroutineResumer(std::coroutine_handle<> handle) noexcept :
+    m_handle(handle)
+{
+}
+
+//==================================================================================================
+detail::CoroutineResumer::CoroutineResumer(CoroutineResumer &&resumer) noexcept :
+    m_handle(std::exchange(resumer.m_handle, nullptr))
+{
+}
+
+//==================================================================================================
+detail::CoroutineResumer::~CoroutineResumer()
+{
+    if (m_handle)
+    {
+        m_handle.destroy();
+    }
+}
+
+//==================================================================================================
+void detail::CoroutineResumer::resume()
+{
+    std::exchange(m_handle, nullptr).resume();
+}
+
+//==================================================================================================
+std::shared_ptr<TaskRunner> detail::CoroutineScheduler::current_task_runner()
+{
+    if (TaskRunner *task_runner = TaskRunner::s_current_task_runner; task_runner != nullptr)
+    {
+        return task_runner->shared_from_this();
+    }
+
+    return nullptr;
+}
+
+//==================================================================================================
+void detail::CoroutineScheduler::post_task(
+    TaskRunner &task_runner,
+    TaskLocation &&location,
+    Task &&task)
+{
+    task_runner.post_admitted_task(std::move(location), std::move(task), task_runner.m_priority);
+}
+
+//==================================================================================================
+void detail::CoroutineScheduler::resume(
+    const std::shared_ptr<TaskRunner> &task_runner,
+    TaskLocation &&location,
+    CoroutineResumer &&resumer,
+    std::chrono::nanoseconds delay)
+{
+    if (!task_runner)
+    {
+        resumer.resume();
+        return;
+    }
+
+    Task task = [resumer = std::move(resumer)](TaskRunner *, TaskLocation) mutable
+    {
+        resumer.resume();
+    };
+
+    if (delay > std::chrono::nanoseconds::zero())
+    {
+        task_runner->post_task_to_task_manager_with_delay(
+            std::move(location),
+            std::move(task),
+            task_runner->m_priority,
+            delay);
+    }
+    else
+    {
+        task_runner->post_admitted_task(
+            std::move(location),
+            std::move(task),
+            task_runner->m_priority);
+    }
+}
+
+//==================================================================================================
+ScheduleAwaitable::ScheduleAwaitable(
+    std::shared_ptr<TaskRunner> task_runner,
+    TaskLocation &&location,
+    std::chrono::nanoseconds delay) noexcept :
+    m_task_runner(std::move(task_runner)),
+    m_location(std::move(location)),
+    m_delay(delay)
+{
+}
+
+//==================================================================================================
+void ScheduleAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    // The awaitable lives in the coroutine frame, which may be resumed or destroyed as soon as the
+    // coroutine is posted, so the awaitable must not be accessed after posting.
+    std::shared_ptr<TaskRunner> task_runner = std::move(m_task_runner);
+
+    detail::CoroutineScheduler::resume(
+        task_runner,
+        std::move(m_location),
+        detail::CoroutineResumer(handle),
+        m_delay);
+}
+
+} // namespace fly
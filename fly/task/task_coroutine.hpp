@@ -0,0 +1,302 @@
+#pragma once
+
+#include "fly/task/task_types.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace fly {
+
+class TaskRunner;
+
+namespace detail {
+
+    /**
+     * Allocator for coroutine frames. Freed frames are cached per-thread in power-of-two size
+     * classes, so that coroutines which are repeatedly created (e.g. one per request) reuse the
+     * same few frames rather than allocating a new frame each time. Frames which are too large to
+     * be cached, or which are freed while their thread's cache is full, are freed immediately.
+     */
+    class CoroutineFrameAllocator
+    {
+    public:
+        /**
+         * Allocate a coroutine frame.
+         *
+         * @param size The size of the frame.
+         *
+         * @return The allocated frame.
+         */
+        static void *allocate(std::size_t size);
+
+        /**
+         * Free a coroutine frame, caching it for reuse if possible.
+         *
+         * @param frame The frame to free.
+         * @param size The size of the frame.
+         */
+        static void deallocate(void *frame, std::size_t size) noexcept;
+    };
+
+    /**
+     * Move-only owner of a suspended coroutine, captured by the task which will resume it. If the
+     * owner is destroyed without resuming the coroutine (e.g. because the task was dropped), the
+     * coroutine frame is destroyed so that it is not leaked.
+     */
+    class CoroutineResumer
+    {
+    public:
+        explicit CoroutineResumer(std::coroutine_handle<> handle) noexcept;
+        CoroutineResumer(CoroutineResumer &&resumer) noexcept;
+        ~CoroutineResumer();
+
+        CoroutineResumer &operator=(CoroutineResumer &&resumer) = delete;
+        CoroutineResumer(const CoroutineResumer &) = delete;
+        CoroutineResumer &operator=(const CoroutineResumer &) = delete;
+
+        /**
+         * Resume the owned coroutine. Ownership of the coroutine is released.
+         */
+        void resume();
+
+    private:
+        std::coroutine_handle<> m_handle;
+    };
+
+    /**
+     * Helper for awaitables to post tasks to, and resume coroutines on, task runners.
+     *
+     * Coroutines are resumed on the task runner which was executing the coroutine when it was
+     * suspended, if any. Resuming a coroutine is posted to that task runner as a new task, so a
+     * coroutine suspended on a sequenced task runner is resumed in sequence with that task runner's
+     * other tasks.
+     */
+    class CoroutineScheduler
+    {
+    public:
+        /**
+         * @return The task runner whose task is being executed by the calling thread, if any.
+         */
+        static std::shared_ptr<TaskRunner> current_task_runner();
+
+        /**
+         * Post a task to a task runner with the task runner's default priority.
+         *
+         * @param task_runner The task runner to post the task to.
+         * @param location The location from which the task was posted.
+         * @param task The task to be executed.
+         */
+        static void post_task(TaskRunner &task_runner, TaskLocation &&location, Task &&task);
+
+        /**
+         * Resume a coroutine on a task runner, after an optional delay. If there is no task runner
+         * and no delay, the coroutine is resumed immediately on the calling thread.
+         *
+         * @param task_runner The task runner to resume the coroutine on.
+         * @param location The location from which the coroutine was suspended.
+         * @param resumer The owner of the coroutine to resume.
+         * @param delay Delay before resuming the coroutine.
+         */
+        static void resume(
+            const std::shared_ptr<TaskRunner> &task_runner,
+            TaskLocation &&location,
+            CoroutineResumer &&resumer,
+            std::chrono::nanoseconds delay = std::chrono::nanoseconds::zero());
+    };
+
+} // namespace detail
+
+/**
+ * Coroutine type for coroutines which await task runners. The coroutine begins executing
+ * immediately on the calling thread, and runs detached: its frame is destroyed when the coroutine
+ * completes, and the caller does not await its completion. Coroutines which need to report a result
+ * should do so by other means, such as by posting a task or awaiting another task runner.
+ *
+ * Coroutine frames are allocated with a per-thread caching allocator (see CoroutineFrameAllocator).
+ *
+ * For example:
+ *
+ *       fly::TaskCoroutine handle_request(
+ *           std::shared_ptr<fly::SequencedTaskRunner> runner,
+ *           std::shared_ptr<fly::ParallelTaskRunner> io_runner)
+ *       {
+ *           co_await runner->schedule(FROM_HERE);
+ *
+ *           std::string data = co_await io_runner->post_task_with_awaitable(FROM_HERE, read_data);
+ *           co_await runner->delay(FROM_HERE, std::chrono::milliseconds(10));
+ *
+ *           // Continue processing data in sequence on the sequenced task runner.
+ *       }
+ */
+class TaskCoroutine
+{
+public:
+    struct promise_type
+    {
+        TaskCoroutine get_return_object() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_void() const noexcept
+        {
+        }
+
+        void unhandled_exception() const noexcept
+        {
+            std::terminate();
+        }
+
+        static void *operator new(std::size_t size)
+        {
+            return detail::CoroutineFrameAllocator::allocate(size);
+        }
+
+        static void operator delete(void *frame, std::size_t size) noexcept
+        {
+            detail::CoroutineFrameAllocator::deallocate(frame, size);
+        }
+    };
+};
+
+/**
+ * Awaitable to suspend a coroutine and resume it on a task runner, optionally after a delay.
+ */
+class ScheduleAwaitable
+{
+public:
+    ScheduleAwaitable(
+        std::shared_ptr<TaskRunner> task_runner,
+        TaskLocation &&location,
+        std::chrono::nanoseconds delay) noexcept;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle);
+
+    void await_resume() const noexcept
+    {
+    }
+
+private:
+    std::shared_ptr<TaskRunner> m_task_runner;
+    TaskLocation m_location;
+    std::chrono::nanoseconds m_delay;
+};
+
+/**
+ * Awaitable to suspend a coroutine, execute a task on a task runner, and resume the coroutine with
+ * the result of that task. The coroutine is resumed on the task runner it was suspended from, if
+ * any; otherwise, it is resumed on the thread which executed the task.
+ *
+ * If the task is dropped without being executed, the suspended coroutine is destroyed.
+ *
+ * @tparam TaskType Callable type of the task.
+ */
+template <typename TaskType>
+class TaskAwaitable
+{
+    using ResultType = std::invoke_result_t<TaskType>;
+    static constexpr bool s_result_is_void = std::is_void_v<ResultType>;
+
+public:
+    TaskAwaitable(
+        std::shared_ptr<TaskRunner> task_runner,
+        TaskLocation &&location,
+        TaskType task) noexcept;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle);
+
+    ResultType await_resume();
+
+private:
+    struct Empty
+    {
+    };
+
+    std::shared_ptr<TaskRunner> m_task_runner;
+    TaskLocation m_location;
+    TaskType m_task;
+
+    std::optional<std::conditional_t<s_result_is_void, Empty, ResultType>> m_result;
+};
+
+//==================================================================================================
+template <typename TaskType>
+TaskAwaitable<TaskType>::TaskAwaitable(
+    std::shared_ptr<TaskRunner> task_runner,
+    TaskLocation &&location,
+    TaskType task) noexcept :
+    m_task_runner(std::move(task_runner)),
+    m_location(std::move(location)),
+    m_task(std::move(task))
+{
+}
+
+//==================================================================================================
+template <typename TaskType>
+void TaskAwaitable<TaskType>::await_suspend(std::coroutine_handle<> handle)
+{
+    auto task = [this,
+                 resumer = detail::CoroutineResumer(handle),
+                 resume_runner = detail::CoroutineScheduler::current_task_runner()](
+                    TaskRunner *,
+                    TaskLocation location) mutable
+    {
+        if constexpr (s_result_is_void)
+        {
+            std::move(m_task)();
+            m_result.emplace();
+        }
+        else
+        {
+            m_result.emplace(std::move(m_task)());
+        }
+
+        detail::CoroutineScheduler::resume(
+            resume_runner,
+            std::move(location),
+            std::move(resumer));
+    };
+
+    // The awaitable lives in the coroutine frame, which may be destroyed by the task, so the
+    // awaitable must not be accessed after posting the task.
+    std::shared_ptr<TaskRunner> task_runner = std::move(m_task_runner);
+    detail::CoroutineScheduler::post_task(*task_runner, std::move(m_location), std::move(task));
+}
+
+//==================================================================================================
+template <typename TaskType>
+auto TaskAwaitable<TaskType>::await_resume() -> ResultType
+{
+    if constexpr (!s_result_is_void)
+    {
+        return std::move(*m_result);
+    }
+}
+
+} // namespace fly
@@ -0,0 +1,80 @@
+#include "fly/task/task_future.hpp"
+
+#include "fly/task/task_manager.hpp"
+
+namespace fly::detail {
+
+//==================================================================================================
+TaskFutureStateBase::TaskFutureStateBase(std::weak_ptr<TaskManager> weak_task_manager) noexcept :
+    m_weak_task_manager(std::move(weak_task_manager))
+{
+}
+
+//==================================================================================================
+bool TaskFutureStateBase::wait()
+{
+    auto is_complete = [this]()
+    {
+        return is_ready();
+    };
+
+    std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock();
+
+    if (task_manager && task_manager->is_worker_thread())
+    {
+        while (!is_ready() && task_manager->m_keep_running.load())
+        {
+            if (!task_manager->execute_pending_task())
+            {
+                // Park on the task manager rather than on this state, so that the worker is woken
+                // to help execute newly posted tasks as well as once the task is complete.
+                m_waiting_workers.fetch_add(1);
+                task_manager->park_waiting_worker(*this);
+                m_waiting_workers.fetch_sub(1);
+            }
+        }
+    }
+    else
+    {
+        task_manager.reset();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, is_complete);
+    }
+
+    return m_status.load() == Status::Fulfilled;
+}
+
+//==================================================================================================
+bool TaskFutureStateBase::is_ready() const
+{
+    return m_status.load() != Status::Pending;
+}
+
+//==================================================================================================
+void TaskFutureStateBase::complete(bool fulfilled)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status.store(fulfilled ? Status::Fulfilled : Status::Dropped);
+    }
+
+    m_condition.notify_all();
+
+    if (m_waiting_workers.load() > 0)
+    {
+        if (std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock(); task_manager)
+        {
+            task_manager->wake_waiting_workers();
+        }
+    }
+}
+
+//==================================================================================================
+void TaskFutureStateBase::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_status.store(Status::Pending);
+}
+
+} // namespace fly::detail
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace fly {
+
+class TaskManager;
+class TaskRunner;
+
+namespace detail {
+
+    /**
+     * The state shared between a task posted with a future and that future, independent of the
+     * task's result type. Handles waiting for the task to be executed.
+     */
+    class TaskFutureStateBase
+    {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param weak_task_manager The task manager which will execute the task.
+         */
+        explicit TaskFutureStateBase(std::weak_ptr<TaskManager> weak_task_manager) noexcept;
+
+        /**
+         * Block until the task has either been executed or dropped. If the calling thread is a
+         * worker thread of the task manager, other pending tasks are executed while waiting.
+         *
+         * @return True if the task was executed.
+         */
+        bool wait();
+
+        /**
+         * @return True if the task has either been executed or dropped.
+         */
+        bool is_ready() const;
+
+        /**
+         * Mark the task as executed or dropped, and wake any waiting threads.
+         *
+         * @param fulfilled True if the task was executed.
+         */
+        void complete(bool fulfilled);
+
+        /**
+         * Mark the task as pending again, so that the state may be reused for another execution
+         * of the task. Must only be called once the state is ready, and not while being waited on.
+         */
+        void reset();
+
+    private:
+        enum class Status : std::uint8_t
+        {
+            Pending,
+            Fulfilled,
+            Dropped,
+        };
+
+        std::weak_ptr<TaskManager> m_weak_task_manager;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::atomic<Status> m_status {Status::Pending};
+
+        // The number of worker threads parked on the task manager while waiting on this state.
+        std::atomic<std::uint32_t> m_waiting_workers {0};
+    };
+
+    /**
+     * The state shared between a task posted with a future and that future, holding the task's
+     * result once it has been executed.
+     *
+     * @tparam T The result type of the task.
+     */
+    template <typename T>
+    struct TaskFutureState : public TaskFutureStateBase
+    {
+        using TaskFutureStateBase::TaskFutureStateBase;
+
+        std::optional<T> m_result;
+    };
+
+    template <>
+    struct TaskFutureState<void> : public TaskFutureStateBase
+    {
+        using TaskFutureStateBase::TaskFutureStateBase;
+    };
+
+    /**
+     * Move-only handle captured by a task posted with a future, through which the task's result is
+     * provided to the future. If the handle is destroyed before a result is provided (e.g. because
+     * the task was dropped), the future is marked as dropped.
+     *
+     * @tparam T The result type of the task.
+     */
+    template <typename T>
+    class TaskPromise
+    {
+    public:
+        explicit TaskPromise(std::shared_ptr<TaskFutureState<T>> state) noexcept;
+        TaskPromise(TaskPromise &&promise) noexcept = default;
+        ~TaskPromise();
+
+        TaskPromise &operator=(TaskPromise &&promise) = delete;
+        TaskPromise(const TaskPromise &) = delete;
+        TaskPromise &operator=(const TaskPromise &) = delete;
+
+        /**
+         * Execute a task and provide its result to the future.
+         *
+         * @tparam TaskType Callable type of the task.
+         *
+         * @param task The task to execute.
+         */
+        template <typename TaskType>
+        void fulfill(TaskType &&task);
+
+    private:
+        std::shared_ptr<TaskFutureState<T>> m_state;
+    };
+
+} // namespace detail
+
+/**
+ * A lightweight future to retrieve the result of a task posted with TaskRunner's
+ * post_task_with_future methods. Unlike std::future, waiting on a task future from within a task
+ * does not simply block the worker thread; instead, the worker thread executes other pending tasks
+ * until the awaited task is complete. This avoids exhausting the thread pool when tasks wait on
+ * each other, and allows a worker to execute the awaited task itself.
+ *
+ * A task may still never complete if it is waited upon from a task posted to the same sequenced
+ * task runner, as the awaited task cannot begin until the waiting task completes.
+ *
+ * If the task is dropped without being executed (e.g. because its task runner was deleted), the
+ * future is still made ready, but holds no result.
+ *
+ * @tparam T The result type of the task.
+ */
+template <typename T>
+class TaskFuture
+{
+    friend class TaskRunner;
+
+public:
+    /**
+     * The type returned by get(): the task's result if non-void, or whether the task was executed
+     * if void.
+     */
+    using result_type = std::conditional_t<std::is_void_v<T>, bool, std::optional<T>>;
+
+    /**
+     * Default constructor. Creates a future which is not associated with any task.
+     */
+    TaskFuture() = default;
+
+    /**
+     * @return True if this future is associated with a task.
+     */
+    bool valid() const;
+
+    /**
+     * @return True if the task has either been executed or dropped.
+     */
+    bool is_ready() const;
+
+    /**
+     * Block until the task has either been executed or dropped. If the calling thread is a worker
+     * thread, other pending tasks are executed while waiting.
+     *
+     * @return True if the task was executed.
+     */
+    bool wait() const;
+
+    /**
+     * Block until the task has either been executed or dropped, and retrieve its result. The result
+     * is moved out of the future, so this may only be called once.
+     *
+     * @return If the task returns a non-void type, the task's result, or an empty optional if the
+     *         task was dropped. Otherwise, true if the task was executed.
+     */
+    result_type get();
+
+private:
+    explicit TaskFuture(std::shared_ptr<detail::TaskFutureState<T>> state) noexcept;
+
+    std::shared_ptr<detail::TaskFutureState<T>> m_state;
+};
+
+//==================================================================================================
+template <typename T>
+detail::TaskPromise<T>::TaskPromise(std::shared_ptr<TaskFutureState<T>> state) noexcept :
+    m_state(std::move(state))
+{
+}
+
+//==================================================================================================
+template <typename T>
+detail::TaskPromise<T>::~TaskPromise()
+{
+    if (m_state)
+    {
+        m_state->complete(false);
+    }
+}
+
+//==================================================================================================
+template <typename T>
+template <typename TaskType>
+void detail::TaskPromise<T>::fulfill(TaskType &&task)
+{
+    if constexpr (std::is_void_v<T>)
+    {
+        std::forward<TaskType>(task)();
+    }
+    else
+    {
+        m_state->m_result.emplace(std::forward<TaskType>(task)());
+    }
+
+    std::shared_ptr<TaskFutureState<T>> state = std::move(m_state);
+    state->complete(true);
+}
+
+//==================================================================================================
+template <typename T>
+TaskFuture<T>::TaskFuture(std::shared_ptr<detail::TaskFutureState<T>> state) noexcept :
+    m_state(std::move(state))
+{
+}
+
+//==================================================================================================
+template <typename T>
+bool TaskFuture<T>::valid() const
+{
+    return static_cast<bool>(m_state);
+}
+
+//==================================================================================================
+template <typename T>
+bool TaskFuture<T>::is_ready() const
+{
+    return m_state && m_state->is_ready();
+}
+
+//==================================================================================================
+template <typename T>
+bool TaskFuture<T>::wait() const
+{
+    return m_state && m_state->wait();
+}
+
+//==================================================================================================
+template <typename T>
+auto TaskFuture<T>::get() -> result_type
+{
+    if constexpr (std::is_void_v<T>)
+    {
+        return wait();
+    }
+    else
+    {
+        if (!wait())
+        {
+            return std::nullopt;
+        }
+
+        return std::move(m_state->m_result);
+    }
+}
+
+} // namespace fly
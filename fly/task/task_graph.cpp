@@ -0,0 +1,215 @@
+#include "fly/task/task_graph.hpp"
+
+#include "fly/task/task_runner.hpp"
+
+#include <limits>
+
+namespace fly {
+
+namespace {
+
+    // Sentinel node identifier held by a node handle which has been moved from.
+    constexpr const TaskGraph::NodeId s_invalid_node =
+        std::numeric_limits<TaskGraph::NodeId>::max();
+
+} // namespace
+
+//==================================================================================================
+TaskGraph::TaskGraph(std::shared_ptr<TaskRunner> task_runner) noexcept :
+    m_task_runner(std::move(task_runner)),
+    m_state(std::make_shared<detail::TaskFutureState<void>>(m_task_runner->m_weak_task_manager))
+{
+    // The graph is not running until it is first run.
+    m_state->complete(true);
+}
+
+//==================================================================================================
+TaskGraph::~TaskGraph()
+{
+    m_state->wait();
+}
+
+//==================================================================================================
+bool TaskGraph::add_dependency(NodeId before, NodeId after)
+{
+    if ((before == after) || (before >= m_nodes.size()) || (after >= m_nodes.size()))
+    {
+        return false;
+    }
+
+    m_nodes[before].m_successors.push_back(after);
+    ++m_nodes[after].m_predecessors;
+    m_validated = false;
+
+    return true;
+}
+
+//==================================================================================================
+std::size_t TaskGraph::size() const
+{
+    return m_nodes.size();
+}
+
+//==================================================================================================
+bool TaskGraph::run()
+{
+    if (!m_state->is_ready() || !validate())
+    {
+        return false;
+    }
+
+    m_state->reset();
+    m_executed.store(0);
+
+    for (NodeId node = 0; node < m_nodes.size(); ++node)
+    {
+        m_remaining_predecessors[node].store(m_nodes[node].m_predecessors);
+    }
+
+    // The run itself is counted as an outstanding node until every root node has been posted, so
+    // that the run cannot complete while root nodes are still being posted.
+    m_outstanding.store(1);
+
+    for (NodeId node = 0; node < m_nodes.size(); ++node)
+    {
+        if (m_nodes[node].m_predecessors == 0)
+        {
+            post_node(node);
+        }
+    }
+
+    finish_node();
+
+    return true;
+}
+
+//==================================================================================================
+bool TaskGraph::is_ready() const
+{
+    return m_state->is_ready();
+}
+
+//==================================================================================================
+bool TaskGraph::wait() const
+{
+    return m_state->wait();
+}
+
+//==================================================================================================
+bool TaskGraph::validate()
+{
+    if (m_validated)
+    {
+        return m_acyclic;
+    }
+
+    // Kahn's algorithm: repeatedly remove nodes without any remaining dependencies. If any nodes
+    // remain, they form a cycle.
+    std::vector<std::uint32_t> remaining_predecessors;
+    std::vector<NodeId> ready_nodes;
+
+    remaining_predecessors.reserve(m_nodes.size());
+    ready_nodes.reserve(m_nodes.size());
+
+    for (NodeId node = 0; node < m_nodes.size(); ++node)
+    {
+        remaining_predecessors.push_back(m_nodes[node].m_predecessors);
+
+        if (m_nodes[node].m_predecessors == 0)
+        {
+            ready_nodes.push_back(node);
+        }
+    }
+
+    for (std::size_t i = 0; i < ready_nodes.size(); ++i)
+    {
+        for (const NodeId successor : m_nodes[ready_nodes[i]].m_successors)
+        {
+            if (--remaining_predecessors[successor] == 0)
+            {
+                ready_nodes.push_back(successor);
+            }
+        }
+    }
+
+    m_acyclic = ready_nodes.size() == m_nodes.size();
+    m_validated = true;
+
+    if (m_remaining_predecessors.size() != m_nodes.size())
+    {
+        m_remaining_predecessors = std::vector<std::atomic<std::uint32_t>>(m_nodes.size());
+    }
+
+    return m_acyclic;
+}
+
+//==================================================================================================
+void TaskGraph::post_node(NodeId node)
+{
+    m_outstanding.fetch_add(1);
+
+    m_task_runner->post_task(TaskLocation(m_nodes[node].m_location), NodeHandle(this, node));
+}
+
+//==================================================================================================
+void TaskGraph::execute_node(NodeId node)
+{
+    m_nodes[node].m_task();
+    m_executed.fetch_add(1);
+
+    for (const NodeId successor : m_nodes[node].m_successors)
+    {
+        if (m_remaining_predecessors[successor].fetch_sub(1) == 1)
+        {
+            post_node(successor);
+        }
+    }
+
+    finish_node();
+}
+
+//==================================================================================================
+void TaskGraph::finish_node()
+{
+    if (m_outstanding.fetch_sub(1) != 1)
+    {
+        return;
+    }
+
+    // The graph may be destroyed as soon as the run is marked complete, so hold a reference to the
+    // state until the waiting threads have been notified.
+    std::shared_ptr<detail::TaskFutureState<void>> state = m_state;
+    state->complete(m_executed.load() == m_nodes.size());
+}
+
+//==================================================================================================
+TaskGraph::NodeHandle::NodeHandle(TaskGraph *graph, NodeId node) noexcept :
+    m_graph(graph),
+    m_node(node)
+{
+}
+
+//==================================================================================================
+TaskGraph::NodeHandle::NodeHandle(NodeHandle &&handle) noexcept :
+    m_graph(std::exchange(handle.m_graph, nullptr)),
+    m_node(std::exchange(handle.m_node, s_invalid_node))
+{
+}
+
+//==================================================================================================
+TaskGraph::NodeHandle::~NodeHandle()
+{
+    if (m_graph != nullptr)
+    {
+        m_graph->finish_node();
+    }
+}
+
+//==================================================================================================
+void TaskGraph::NodeHandle::operator()()
+{
+    TaskGraph *graph = std::exchange(m_graph, nullptr);
+    graph->execute_node(m_node);
+}
+
+} // namespace fly
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "fly/task/task_future.hpp"
+#include "fly/task/task_types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fly {
+
+class TaskRunner;
+
+/**
+ * Class to execute a directed acyclic graph of tasks on a task runner. Nodes of the graph are
+ * tasks, and edges are dependencies between tasks: a task is not posted for execution until all of
+ * the tasks it depends on have completed. Tasks without a dependency between them may execute
+ * concurrently, subject to the policy of the task runner (a parallel task runner should generally
+ * be used).
+ *
+ * A node is posted to the task runner directly from the worker thread which completed its last
+ * remaining dependency, so there is no coordinating thread between the stages of the graph. For
+ * example, to parse two documents concurrently, and then encode and write their merged result:
+ *
+ *       fly::TaskGraph graph(task_runner);
+ *
+ *       auto parse1 = graph.add_task(FROM_HERE, [&]() { json1 = parse(document1); });
+ *       auto parse2 = graph.add_task(FROM_HERE, [&]() { json2 = parse(document2); });
+ *       auto encode = graph.add_task(FROM_HERE, [&]() { encoded = encode(json1, json2); });
+ *       auto write = graph.add_task(FROM_HERE, [&]() { write_file(encoded); });
+ *
+ *       graph.add_dependency(parse1, encode);
+ *       graph.add_dependency(parse2, encode);
+ *       graph.add_dependency(encode, write);
+ *
+ *       graph.run();
+ *       graph.wait();
+ *
+ * Graphs are reusable. Once a run of the graph has completed, the graph may be run again. The
+ * structure of the graph is only validated when it changes, and re-running an unchanged graph does
+ * not allocate any memory beyond what the task runner requires to post each task. Each node's task
+ * is therefore invoked once per run, and must be invocable more than once.
+ *
+ * If any task is dropped without being executed (e.g. because the task runner's task manager was
+ * deleted), the tasks which depend on it are never posted, and the run completes once the tasks
+ * already posted have finished.
+ *
+ * The graph must not be modified while it is running. Destroying the graph blocks until any
+ * ongoing run has completed.
+ */
+class TaskGraph
+{
+public:
+    /**
+     * Identifier of a node within the graph.
+     */
+    using NodeId = std::size_t;
+
+    /**
+     * Constructor.
+     *
+     * @param task_runner The task runner onto which the graph's tasks are posted.
+     */
+    explicit TaskGraph(std::shared_ptr<TaskRunner> task_runner) noexcept;
+
+    /**
+     * Destructor. Blocks until any ongoing run of the graph has completed.
+     */
+    ~TaskGraph();
+
+    TaskGraph(const TaskGraph &) = delete;
+    TaskGraph &operator=(const TaskGraph &) = delete;
+
+    /**
+     * Add a task to the graph as a node without any dependencies. The task may be any callable type
+     * which is invocable without any arguments, and which may be invoked more than once.
+     *
+     * @tparam TaskType Callable type of the task.
+     *
+     * @param location The location from which the task was added (use FROM_HERE).
+     * @param task The task to be executed.
+     *
+     * @return The identifier of the created node.
+     */
+    template <typename TaskType>
+    NodeId add_task(TaskLocation &&location, TaskType &&task);
+
+    /**
+     * Add a dependency between two nodes, such that the second node is not posted for execution
+     * until the first node has completed.
+     *
+     * @param before The node which must complete first.
+     * @param after The node which depends on the first node.
+     *
+     * @return True if the dependency was added.
+     */
+    bool add_dependency(NodeId before, NodeId after);
+
+    /**
+     * @return The number of nodes in the graph.
+     */
+    std::size_t size() const;
+
+    /**
+     * Start a run of the graph, posting each node without any dependencies for execution. Does not
+     * block until the run is complete.
+     *
+     * @return True if the run was started. False if a previous run is not yet complete, or if the
+     *         graph contains a cycle.
+     */
+    bool run();
+
+    /**
+     * @return True if the graph is not currently running.
+     */
+    bool is_ready() const;
+
+    /**
+     * Block until the current run of the graph (if any) has completed. If the calling thread is a
+     * worker thread, other pending tasks are executed while waiting.
+     *
+     * @return True if every node was executed in the most recent run.
+     */
+    bool wait() const;
+
+private:
+    using NodeTask = BasicTask<void(), s_task_inline_size>;
+
+    /**
+     * Structure to hold a node's task and the nodes which depend on it.
+     */
+    struct Node
+    {
+        TaskLocation m_location;
+        NodeTask m_task;
+        std::vector<NodeId> m_successors;
+        std::uint32_t m_predecessors {0};
+    };
+
+    /**
+     * Move-only handle posted to the task runner to execute a node. If the handle is destroyed
+     * without being invoked (e.g. because the task was dropped), the node is marked as finished
+     * without having been executed.
+     */
+    class NodeHandle
+    {
+    public:
+        NodeHandle(TaskGraph *graph, NodeId node) noexcept;
+        NodeHandle(NodeHandle &&handle) noexcept;
+        ~NodeHandle();
+
+        NodeHandle &operator=(NodeHandle &&) = delete;
+        NodeHandle(const NodeHandle &) = delete;
+        NodeHandle &operator=(const NodeHandle &) = delete;
+
+        /**
+         * Execute the node.
+         */
+        void operator()();
+
+    private:
+        TaskGraph *m_graph;
+        NodeId m_node;
+    };
+
+    /**
+     * Verify that the graph does not contain a cycle, and size the per-run state of the graph.
+     * Only performed when the structure of the graph has changed since the last validation.
+     *
+     * @return True if the graph does not contain a cycle.
+     */
+    bool validate();
+
+    /**
+     * Post a node whose dependencies have all completed for execution.
+     *
+     * @param node The node to post.
+     */
+    void post_node(NodeId node);
+
+    /**
+     * Execute a node, and post each node which depends on it and has no remaining dependencies.
+     *
+     * @param node The node to execute.
+     */
+    void execute_node(NodeId node);
+
+    /**
+     * Mark a posted node as finished, either because it was executed or dropped. Once every posted
+     * node has finished, the run is complete.
+     */
+    void finish_node();
+
+    std::shared_ptr<TaskRunner> m_task_runner;
+
+    std::vector<Node> m_nodes;
+    bool m_validated {false};
+    bool m_acyclic {false};
+
+    std::vector<std::atomic<std::uint32_t>> m_remaining_predecessors;
+    std::atomic<std::size_t> m_outstanding {0};
+    std::atomic<std::size_t> m_executed {0};
+
+    std::shared_ptr<detail::TaskFutureState<void>> m_state;
+};
+
+//==================================================================================================
+template <typename TaskType>
+TaskGraph::NodeId TaskGraph::add_task(TaskLocation &&location, TaskType &&task)
+{
+    static_assert(std::is_invocable_v<TaskType &>, "Task must be invocable without any arguments");
+
+    m_nodes.push_back({std::move(location), NodeTask(std::forward<TaskType>(task)), {}, 0});
+    m_validated = false;
+
+    return m_nodes.size() - 1;
+}
+
+} // namespace fly
@@ -0,0 +1,53 @@
+#include "fly/task/task_handle.hpp"
+
+#include "fly/task/task_manager.hpp"
+
+namespace fly {
+
+//==================================================================================================
+TaskHandle::TaskHandle(
+    std::weak_ptr<TaskManager> weak_task_manager,
+    std::uint32_t slot,
+    std::uint32_t generation) noexcept :
+    m_weak_task_manager(std::move(weak_task_manager)),
+    m_slot(slot),
+    m_generation(generation),
+    m_valid(true)
+{
+}
+
+//==================================================================================================
+bool TaskHandle::valid() const
+{
+    return m_valid;
+}
+
+//==================================================================================================
+TaskHandle::operator bool() const
+{
+    return m_valid;
+}
+
+//==================================================================================================
+bool TaskHandle::is_pending() const
+{
+    if (std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock(); task_manager)
+    {
+        return task_manager->is_delayed_task_pending(m_slot, m_generation);
+    }
+
+    return false;
+}
+
+//==================================================================================================
+bool TaskHandle::cancel()
+{
+    if (std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock(); task_manager)
+    {
+        return task_manager->cancel_delayed_task(m_slot, m_generation);
+    }
+
+    return false;
+}
+
+} // namespace fly
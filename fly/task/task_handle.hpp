@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace fly {
+
+class TaskManager;
+
+/**
+ * A lightweight handle to a delayed task, returned by TaskRunner's post_task_with_delay methods,
+ * through which the task may be cancelled before its delay expires. Cancelling the task removes it
+ * from the task manager's timer in logarithmic time, and destroys the task without executing it.
+ *
+ * Once the delay has expired, the task is handed back to its task runner and may no longer be
+ * cancelled through the handle. Destroying the handle does not cancel the task.
+ *
+ * Handles are cheap to copy, and remain safe to use after the task has executed or the task manager
+ * has been deleted.
+ */
+class TaskHandle
+{
+    friend class TaskManager;
+
+public:
+    /**
+     * Default constructor. Creates a handle which is not associated with any task.
+     */
+    TaskHandle() = default;
+
+    /**
+     * @return True if this handle is associated with a task, i.e. the task was posted for delayed
+     *         execution.
+     */
+    bool valid() const;
+
+    /**
+     * @return True if this handle is associated with a task.
+     */
+    explicit operator bool() const;
+
+    /**
+     * @return True if the task's delay has not yet expired, and the task has not been cancelled.
+     */
+    bool is_pending() const;
+
+    /**
+     * Cancel the task, if its delay has not yet expired.
+     *
+     * @return True if the task was cancelled.
+     */
+    bool cancel();
+
+private:
+    /**
+     * Constructor.
+     *
+     * @param weak_task_manager The task manager holding the delayed task.
+     * @param slot The slot of the task manager's timer holding the delayed task.
+     * @param generation The generation of the slot when the delayed task was stored.
+     */
+    TaskHandle(
+        std::weak_ptr<TaskManager> weak_task_manager,
+        std::uint32_t slot,
+        std::uint32_t generation) noexcept;
+
+    std::weak_ptr<TaskManager> m_weak_task_manager;
+    std::uint32_t m_slot {0};
+    std::uint32_t m_generation {0};
+    bool m_valid {false};
+};
+
+} // namespace fly
@@ -1,20 +1,102 @@
 #include "fly/task/task_manager.hpp"
 
 #include "fly/logger/logger.hpp"
+#include "fly/system/system.hpp"
+#include "fly/task/task_config.hpp"
 #include "fly/task/task_runner.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <string>
 #include <thread>
 
 namespace fly {
 
 namespace {
 
-    const std::chrono::milliseconds s_delay(10);
+    // With work stealing enabled, the number of tasks a worker thread retrieves between forced
+    // checks of the shared queue. Prime to avoid lining up with common task posting patterns.
+    constexpr const std::uint32_t s_shared_queue_interval = 61;
+
+    // The number of tasks a worker thread retrieves between giving the normal and background
+    // priority lanes the first pick. Prime for the same reason as above.
+    constexpr const std::uint32_t s_normal_lane_interval = 7;
+    constexpr const std::uint32_t s_background_lane_interval = 31;
+
+    using LaneOrder =
+        std::array<TaskPriority, static_cast<std::size_t>(TaskPriority::NumPriorities)>;
+
+    /**
+     * Determine the order in which a worker thread should check the priority lanes.
+     *
+     * @param tick The number of times the worker thread has requested a task.
+     *
+     * @return The order in which to check the priority lanes.
+     */
+    LaneOrder lane_order(std::uint32_t tick)
+    {
+        if ((tick % s_background_lane_interval) == 0)
+        {
+            return {TaskPriority::Background, TaskPriority::High, TaskPriority::Normal};
+        }
+        else if ((tick % s_normal_lane_interval) == 0)
+        {
+            return {TaskPriority::Normal, TaskPriority::High, TaskPriority::Background};
+        }
+
+        return {TaskPriority::High, TaskPriority::Normal, TaskPriority::Background};
+    }
+
+    // The order in which the priority lanes are checked for tasks to drop when the shared queues
+    // overflow with the drop-oldest policy.
+    constexpr const LaneOrder s_drop_order {
+        TaskPriority::Background,
+        TaskPriority::Normal,
+        TaskPriority::High};
+
+    /**
+     * Structure to identify the task manager and worker index of the calling thread, if any.
+     */
+    struct WorkerContext
+    {
+        const TaskManager *m_task_manager {nullptr};
+        std::uint32_t m_index {0};
+        std::uint32_t m_tick {0};
+    };
+
+    thread_local WorkerContext s_worker_context;
+
+    /**
+     * Comparator to form a min-heap of delayed tasks, ordered first by scheduled time and then by
+     * posting sequence.
+     */
+    template <typename DelayedTaskHolder>
+    bool scheduled_later(const DelayedTaskHolder &task1, const DelayedTaskHolder &task2)
+    {
+        const auto &schedule1 = task1.m_task_holder.m_schedule;
+        const auto &schedule2 = task2.m_task_holder.m_schedule;
+
+        if (schedule1 == schedule2)
+        {
+            return task1.m_sequence > task2.m_sequence;
+        }
+
+        return schedule1 > schedule2;
+    }
 
 } // namespace
 
 //==================================================================================================
 TaskManager::TaskManager(std::uint32_t num_workers) noexcept :
+    TaskManager(num_workers, std::make_shared<TaskConfig>())
+{
+}
+
+//==================================================================================================
+TaskManager::TaskManager(
+    std::uint32_t num_workers,
+    const std::shared_ptr<TaskConfig> &config) noexcept :
+    m_config(config),
     m_keep_running(false),
     m_num_workers(num_workers)
 {
@@ -28,11 +110,63 @@ bool TaskManager::start()
     if (m_keep_running.compare_exchange_strong(expected, true))
     {
         std::shared_ptr<TaskManager> task_manager = shared_from_this();
+        m_work_stealing = m_config->work_stealing();
+
+        if (m_config->instrument_tasks() && !m_task_metrics)
+        {
+            m_task_metrics = std::make_unique<TaskMetricsCollector>();
+        }
+
+        if (m_config->trace_tasks() && !m_task_tracer)
+        {
+            m_task_tracer = std::make_unique<TaskTracer>(m_config->trace_buffer_size());
+        }
+
+        if (!m_parallel_task_runner)
+        {
+            m_parallel_task_runner = create_task_runner<ParallelTaskRunner>();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_blocking_tasks_mutex);
+
+            m_max_blocking_threads = std::max(m_config->max_blocking_threads(), std::uint32_t(1));
+            m_blocking_thread_idle_timeout = m_config->blocking_thread_idle_timeout();
+
+            // Blocking tasks may have been posted before the task manager was started.
+            while ((m_blocking_threads < m_blocking_tasks.size()) &&
+                (m_blocking_threads < m_max_blocking_threads))
+            {
+                maybe_create_blocking_thread();
+            }
+        }
+
+        m_max_workers = std::max(m_config->max_workers(), m_num_workers);
+        m_elastic = m_max_workers > m_num_workers;
+        m_worker_spawn_latency = m_config->worker_spawn_latency();
+        m_worker_idle_timeout = m_config->worker_idle_timeout();
+        m_last_dequeue_time = std::chrono::steady_clock::now().time_since_epoch().count();
+        m_worker_cpu_affinity = m_config->worker_cpu_affinity();
+        m_queue_depth.set_limit({m_config->max_queued_tasks(), m_config->queue_overflow_policy()});
+
+        // Local queues are created for every slot of the pool up front, so that the queues do not
+        // need to be guarded against worker threads being created and retired.
+        m_worker_queues.clear();
+
+        if (m_work_stealing)
+        {
+            for (std::uint32_t i = 0; i < m_max_workers; ++i)
+            {
+                m_worker_queues.push_back(std::make_unique<WorkerQueue>());
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_workers_mutex);
+        m_active_workers.assign(m_max_workers, false);
 
         for (std::uint32_t i = 0; i < m_num_workers; ++i)
         {
-            m_futures.push_back(
-                std::async(std::launch::async, &TaskManager::worker_thread, task_manager));
+            create_worker();
         }
 
         m_futures.push_back(
@@ -51,7 +185,38 @@ bool TaskManager::stop()
 
     if (m_keep_running.compare_exchange_strong(expected, false))
     {
-        for (auto &future : m_futures)
+        {
+            std::lock_guard<std::mutex> lock(m_delayed_tasks_mutex);
+        }
+        m_delayed_tasks_condition.notify_all();
+
+        {
+            std::lock_guard<std::mutex> lock(m_parking_mutex);
+        }
+        m_parking_condition.notify_all();
+
+        std::vector<std::future<void>> blocking_futures;
+        {
+            std::lock_guard<std::mutex> lock(m_blocking_tasks_mutex);
+            blocking_futures = std::move(m_blocking_futures);
+        }
+        m_blocking_tasks_condition.notify_all();
+
+        for (auto &future : blocking_futures)
+        {
+            if (future.valid())
+            {
+                future.get();
+            }
+        }
+
+        std::vector<std::future<void>> futures;
+        {
+            std::lock_guard<std::mutex> lock(m_workers_mutex);
+            futures = std::move(m_futures);
+        }
+
+        for (auto &future : futures)
         {
             if (future.valid())
             {
@@ -59,96 +224,1029 @@ bool TaskManager::stop()
             }
         }
 
+        m_worker_count = 0;
         return true;
     }
 
     return false;
 }
 
+//==================================================================================================
+std::vector<TaskMetrics> TaskManager::task_metrics() const
+{
+    if (m_task_metrics)
+    {
+        return m_task_metrics->snapshot();
+    }
+
+    return {};
+}
+
+//==================================================================================================
+Json TaskManager::task_trace() const
+{
+    if (m_task_tracer)
+    {
+        return m_task_tracer->trace();
+    }
+
+    return nullptr;
+}
+
+//==================================================================================================
+std::uint32_t TaskManager::worker_count() const
+{
+    return m_worker_count.load();
+}
+
+//==================================================================================================
+TaskQueueMetrics TaskManager::queue_metrics() const
+{
+    return m_queue_depth.metrics();
+}
+
 //==================================================================================================
 void TaskManager::post_task(
     TaskLocation &&location,
     Task &&task,
+    TaskPriority priority,
     std::weak_ptr<TaskRunner> weak_task_runner)
 {
+    const auto now = std::chrono::steady_clock::now();
+
     TaskHolder wrapped_task {
         std::move(location),
         std::move(task),
         std::move(weak_task_runner),
-        std::chrono::steady_clock::now()};
+        now,
+        priority};
+
+    if (priority == TaskPriority::Blocking)
+    {
+        post_blocking_task(std::move(wrapped_task));
+        return;
+    }
+
+    m_queue_depth.reserve(1);
+    WorkerQueue *worker_queue = nullptr;
+
+    if (priority == TaskPriority::Normal)
+    {
+        worker_queue = local_worker_queue();
+    }
+
+    if (worker_queue != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(worker_queue->m_mutex);
+        worker_queue->m_tasks.push_back(std::move(wrapped_task));
+    }
+    else
+    {
+        task_lane(priority).push(std::move(wrapped_task));
+    }
+
+    wake_workers(1);
+    observe_post_latency(now);
+}
+
+//==================================================================================================
+void TaskManager::post_tasks(
+    TaskLocation &&location,
+    std::vector<Task> &&tasks,
+    TaskPriority priority,
+    std::weak_ptr<TaskRunner> weak_task_runner)
+{
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    std::vector<TaskHolder> wrapped_tasks;
+    wrapped_tasks.reserve(tasks.size());
+
+    for (Task &task : tasks)
+    {
+        wrapped_tasks.push_back({location, std::move(task), weak_task_runner, now, priority});
+    }
+
+    if (priority == TaskPriority::Blocking)
+    {
+        post_blocking_tasks(std::move(wrapped_tasks));
+        return;
+    }
+
+    m_queue_depth.reserve(wrapped_tasks.size());
+    WorkerQueue *worker_queue = nullptr;
+
+    if (priority == TaskPriority::Normal)
+    {
+        worker_queue = local_worker_queue();
+    }
+
+    if (worker_queue != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(worker_queue->m_mutex);
+
+        std::move(
+            wrapped_tasks.begin(),
+            wrapped_tasks.end(),
+            std::back_inserter(worker_queue->m_tasks));
+    }
+    else
+    {
+        task_lane(priority).push(wrapped_tasks.begin(), wrapped_tasks.end());
+    }
+
+    wake_workers(wrapped_tasks.size());
+    observe_post_latency(now);
+}
+
+//==================================================================================================
+void TaskManager::post_parallel_task(TaskLocation &&location, Task &&task)
+{
+    m_parallel_task_runner->post_admitted_task(
+        std::move(location),
+        std::move(task),
+        TaskPriority::Normal);
+}
+
+//==================================================================================================
+bool TaskManager::admit_tasks(TaskPriority priority, std::size_t count)
+{
+    if ((priority == TaskPriority::Blocking) || m_queue_depth.has_capacity(count) ||
+        !m_keep_running.load())
+    {
+        return true;
+    }
+
+    const TaskQueuePolicy policy = m_queue_depth.limit().m_policy;
+
+    if (policy == TaskQueuePolicy::Block)
+    {
+        // Worker threads help execute pending tasks while blocked, so that a task which floods the
+        // shared queues cannot deadlock the worker pool.
+        m_queue_depth.wait_until(
+            [this, count]()
+            {
+                return m_queue_depth.has_capacity(count) || !m_keep_running.load();
+            },
+            [this]()
+            {
+                return is_worker_thread() && execute_pending_task();
+            });
+    }
+    else if (policy == TaskQueuePolicy::DropOldest)
+    {
+        drop_oldest_tasks(m_queue_depth.overflow(count));
+    }
+    else
+    {
+        m_queue_depth.record_rejected(count);
+        return false;
+    }
+
+    return true;
+}
+
+//==================================================================================================
+void TaskManager::drop_oldest_tasks(std::size_t count)
+{
+    std::vector<TaskHolder> dropped_tasks;
+    TaskHolder task_holder;
 
-    m_tasks.push(std::move(wrapped_task));
+    for (const TaskPriority priority : s_drop_order)
+    {
+        while ((dropped_tasks.size() < count) &&
+            task_lane(priority).pop(task_holder, std::chrono::milliseconds(0)))
+        {
+            dropped_tasks.push_back(std::move(task_holder));
+        }
+    }
+
+    for (auto &worker_queue : m_worker_queues)
+    {
+        std::lock_guard<std::mutex> lock(worker_queue->m_mutex);
+
+        while ((dropped_tasks.size() < count) && !worker_queue->m_tasks.empty())
+        {
+            dropped_tasks.push_back(std::move(worker_queue->m_tasks.front()));
+            worker_queue->m_tasks.pop_front();
+        }
+    }
+
+    m_queue_depth.release(dropped_tasks.size());
+    m_queue_depth.record_dropped(dropped_tasks.size());
+
+    for (TaskHolder &dropped_task : dropped_tasks)
+    {
+        // The task is destroyed before notifying its task runner, as destroying a task may invoke
+        // arbitrary code (e.g. marking a future as dropped).
+        dropped_task.m_task = nullptr;
+
+        if (auto task_runner = dropped_task.m_weak_task_runner.lock(); task_runner)
+        {
+            task_runner->task_dropped(std::move(dropped_task.m_location));
+        }
+    }
 }
 
 //==================================================================================================
-void TaskManager::post_task_with_delay(
+TaskHandle TaskManager::post_task_with_delay(
     TaskLocation &&location,
     Task &&task,
+    TaskPriority priority,
     std::weak_ptr<TaskRunner> weak_task_runner,
-    std::chrono::milliseconds delay)
+    std::chrono::nanoseconds delay)
 {
     TaskHolder wrapped_task {
         std::move(location),
         std::move(task),
         std::move(weak_task_runner),
-        std::chrono::steady_clock::now() + delay};
+        std::chrono::steady_clock::now() + delay,
+        priority};
 
-    std::unique_lock<std::mutex> lock(m_delayed_tasks_mutex);
-    m_delayed_tasks.push_back(std::move(wrapped_task));
+    bool is_earliest_task = false;
+    std::uint32_t slot = 0;
+    std::uint32_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_delayed_tasks_mutex);
+
+        const std::uint64_t sequence = m_delayed_tasks_sequence++;
+        slot = push_delayed_task({std::move(wrapped_task), sequence});
+
+        generation = m_delayed_task_slots[slot].m_generation;
+        is_earliest_task = m_delayed_tasks.front().m_sequence == sequence;
+    }
+
+    if (is_earliest_task)
+    {
+        m_delayed_tasks_condition.notify_one();
+    }
+
+    return TaskHandle(weak_from_this(), slot, generation);
 }
 
 //==================================================================================================
-void TaskManager::worker_thread()
+bool TaskManager::cancel_delayed_task(std::uint32_t slot, std::uint32_t generation)
 {
-    TaskHolder task_holder;
-
-    while (m_keep_running.load())
+    TaskHolder cancelled_task;
     {
-        if (m_tasks.pop(task_holder, s_delay) && m_keep_running.load())
+        std::lock_guard<std::mutex> lock(m_delayed_tasks_mutex);
+
+        if (!is_delayed_task_pending_locked(slot, generation))
         {
-            if (auto task_runner = task_holder.m_weak_task_runner.lock(); task_runner)
-            {
-                TaskLocation location = std::move(task_holder.m_location);
-                Task task = std::move(task_holder.m_task);
+            return false;
+        }
 
-                task_runner->execute(std::move(location), std::move(task));
-            }
+        cancelled_task = pop_delayed_task(m_delayed_task_slots[slot].m_position);
+    }
+
+    // The cancelled task is destroyed here, outside of the lock, as destroying a task may invoke
+    // arbitrary code (e.g. marking a future as dropped).
+    return true;
+}
+
+//==================================================================================================
+bool TaskManager::is_delayed_task_pending(std::uint32_t slot, std::uint32_t generation)
+{
+    std::lock_guard<std::mutex> lock(m_delayed_tasks_mutex);
+    return is_delayed_task_pending_locked(slot, generation);
+}
+
+//==================================================================================================
+bool TaskManager::is_delayed_task_pending_locked(std::uint32_t slot, std::uint32_t generation) const
+{
+    return (slot < m_delayed_task_slots.size()) && m_delayed_task_slots[slot].m_in_use &&
+        (m_delayed_task_slots[slot].m_generation == generation);
+}
+
+//==================================================================================================
+std::uint32_t TaskManager::push_delayed_task(DelayedTaskHolder &&delayed_task)
+{
+    std::uint32_t slot = 0;
+
+    if (m_free_delayed_task_slots.empty())
+    {
+        slot = static_cast<std::uint32_t>(m_delayed_task_slots.size());
+        m_delayed_task_slots.emplace_back();
+    }
+    else
+    {
+        slot = m_free_delayed_task_slots.back();
+        m_free_delayed_task_slots.pop_back();
+    }
+
+    const std::size_t position = m_delayed_tasks.size();
+
+    delayed_task.m_slot = slot;
+    m_delayed_tasks.push_back(std::move(delayed_task));
+
+    m_delayed_task_slots[slot].m_position = position;
+    m_delayed_task_slots[slot].m_in_use = true;
+
+    sift_delayed_task_up(position);
+    return slot;
+}
+
+//==================================================================================================
+TaskManager::TaskHolder TaskManager::pop_delayed_task(std::size_t position)
+{
+    const std::size_t last = m_delayed_tasks.size() - 1;
+
+    if (position != last)
+    {
+        swap_delayed_tasks(position, last);
+    }
+
+    DelayedTaskHolder delayed_task = std::move(m_delayed_tasks.back());
+    m_delayed_tasks.pop_back();
+
+    // The task moved into the vacated position may belong either above or below that position.
+    if (position != last)
+    {
+        sift_delayed_task_up(position);
+        sift_delayed_task_down(m_delayed_task_slots[m_delayed_tasks[position].m_slot].m_position);
+    }
+
+    DelayedTaskSlot &slot = m_delayed_task_slots[delayed_task.m_slot];
+    slot.m_in_use = false;
+    ++slot.m_generation;
+
+    m_free_delayed_task_slots.push_back(delayed_task.m_slot);
+
+    return std::move(delayed_task.m_task_holder);
+}
+
+//==================================================================================================
+void TaskManager::sift_delayed_task_up(std::size_t position)
+{
+    while (position > 0)
+    {
+        const std::size_t parent = (position - 1) / 2;
+
+        if (!scheduled_later(m_delayed_tasks[parent], m_delayed_tasks[position]))
+        {
+            break;
         }
+
+        swap_delayed_tasks(parent, position);
+        position = parent;
     }
 }
 
 //==================================================================================================
-void TaskManager::timer_thread()
+void TaskManager::sift_delayed_task_down(std::size_t position)
 {
-    while (m_keep_running.load())
+    const std::size_t size = m_delayed_tasks.size();
+
+    while (true)
     {
-        auto now = std::chrono::steady_clock::now();
+        const std::size_t left = position * 2 + 1;
+        const std::size_t right = left + 1;
+        std::size_t earliest = position;
+
+        if ((left < size) && scheduled_later(m_delayed_tasks[earliest], m_delayed_tasks[left]))
+        {
+            earliest = left;
+        }
+        if ((right < size) && scheduled_later(m_delayed_tasks[earliest], m_delayed_tasks[right]))
         {
-            std::unique_lock<std::mutex> lock(m_delayed_tasks_mutex);
+            earliest = right;
+        }
 
-            for (auto it = m_delayed_tasks.begin(); it != m_delayed_tasks.end();)
-            {
-                if (it->m_schedule <= now)
-                {
-                    if (auto task_runner = it->m_weak_task_runner.lock(); task_runner)
-                    {
-                        TaskLocation location = std::move(it->m_location);
-                        Task task = std::move(it->m_task);
-
-                        task_runner->post_task_internal(std::move(location), std::move(task));
-                    }
-
-                    it = m_delayed_tasks.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
+        if (earliest == position)
+        {
+            break;
         }
 
-        std::this_thread::sleep_for(s_delay);
+        swap_delayed_tasks(position, earliest);
+        position = earliest;
     }
 }
 
+//==================================================================================================
+void TaskManager::swap_delayed_tasks(std::size_t position1, std::size_t position2)
+{
+    std::swap(m_delayed_tasks[position1], m_delayed_tasks[position2]);
+
+    m_delayed_task_slots[m_delayed_tasks[position1].m_slot].m_position = position1;
+    m_delayed_task_slots[m_delayed_tasks[position2].m_slot].m_position = position2;
+}
+
+//==================================================================================================
+void TaskManager::post_blocking_task(TaskHolder &&task_holder)
+{
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(m_blocking_tasks_mutex);
+        m_blocking_tasks.push_back(std::move(task_holder));
+
+        notify = m_idle_blocking_threads > 0;
+
+        if (m_keep_running.load())
+        {
+            maybe_create_blocking_thread();
+        }
+    }
+
+    if (notify)
+    {
+        m_blocking_tasks_condition.notify_one();
+    }
+}
+
+//==================================================================================================
+void TaskManager::post_blocking_tasks(std::vector<TaskHolder> &&task_holders)
+{
+    std::uint32_t idle_blocking_threads = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_blocking_tasks_mutex);
+
+        std::move(
+            task_holders.begin(),
+            task_holders.end(),
+            std::back_inserter(m_blocking_tasks));
+
+        idle_blocking_threads = m_idle_blocking_threads;
+
+        if (m_keep_running.load())
+        {
+            for (std::size_t i = 0; i < task_holders.size(); ++i)
+            {
+                maybe_create_blocking_thread();
+            }
+        }
+    }
+
+    if (idle_blocking_threads == 1)
+    {
+        m_blocking_tasks_condition.notify_one();
+    }
+    else if (idle_blocking_threads > 1)
+    {
+        m_blocking_tasks_condition.notify_all();
+    }
+}
+
+//==================================================================================================
+void TaskManager::maybe_create_blocking_thread()
+{
+    if ((m_idle_blocking_threads >= m_blocking_tasks.size()) ||
+        (m_blocking_threads >= m_max_blocking_threads))
+    {
+        return;
+    }
+
+    // Reap blocking threads which have since exited after being idle.
+    std::erase_if(
+        m_blocking_futures,
+        [](const std::future<void> &future)
+        {
+            return future.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+        });
+
+    m_blocking_futures.push_back(
+        std::async(std::launch::async, &TaskManager::blocking_thread, shared_from_this()));
+
+    ++m_blocking_threads;
+}
+
+//==================================================================================================
+void TaskManager::maybe_create_worker(std::chrono::steady_clock::duration latency)
+{
+    if (!m_elastic || (latency < m_worker_spawn_latency) ||
+        (m_worker_count.load() >= m_max_workers))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
+    const auto now = std::chrono::steady_clock::now();
+
+    if (!m_keep_running.load() || (m_worker_count.load() >= m_max_workers) ||
+        ((now - m_last_worker_creation) < m_worker_spawn_latency))
+    {
+        return;
+    }
+
+    // Reap worker threads which have since exited after being idle.
+    std::erase_if(
+        m_futures,
+        [](const std::future<void> &future)
+        {
+            return future.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+        });
+
+    create_worker();
+    m_last_worker_creation = now;
+}
+
+//==================================================================================================
+void TaskManager::create_worker()
+{
+    const auto it = std::find(m_active_workers.begin(), m_active_workers.end(), false);
+    const auto index = static_cast<std::uint32_t>(std::distance(m_active_workers.begin(), it));
+
+    *it = true;
+    ++m_worker_count;
+
+    m_futures.push_back(
+        std::async(std::launch::async, &TaskManager::worker_thread, shared_from_this(), index));
+}
+
+//==================================================================================================
+bool TaskManager::retire_worker()
+{
+    // The parked worker count has already been decremented, so a task posted after this check will
+    // not rely on this worker thread to execute it.
+    if (has_pending_tasks())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
+
+    if (m_worker_count.load() <= m_num_workers)
+    {
+        return false;
+    }
+
+    m_active_workers[s_worker_context.m_index] = false;
+    --m_worker_count;
+
+    return true;
+}
+
+//==================================================================================================
+void TaskManager::observe_post_latency(std::chrono::steady_clock::time_point now)
+{
+    if (m_elastic && (m_parked_workers.load() == 0))
+    {
+        const std::chrono::steady_clock::duration last_dequeue_time(m_last_dequeue_time.load());
+        maybe_create_worker(now.time_since_epoch() - last_dequeue_time);
+    }
+}
+
+//==================================================================================================
+void TaskManager::observe_queue_latency(const TaskHolder &task_holder)
+{
+    if (m_elastic)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        m_last_dequeue_time.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+
+        if (m_parked_workers.load() == 0)
+        {
+            maybe_create_worker(now - task_holder.m_schedule);
+        }
+    }
+}
+
+//==================================================================================================
+void TaskManager::worker_thread(std::uint32_t index)
+{
+    s_worker_context = {this, index, 0};
+    System::set_thread_name("fly-worker-" + std::to_string(index));
+
+    // Worker threads created for a slot of the pool are always pinned to the same CPU, so that
+    // an elastic pool does not shuffle retired and recreated workers between CPUs.
+    if (!m_worker_cpu_affinity.empty())
+    {
+        const std::uint32_t cpu = m_worker_cpu_affinity[index % m_worker_cpu_affinity.size()];
+
+        if (!System::set_thread_affinity(cpu))
+        {
+            LOGW("Could not pin worker thread %u to CPU %u", index, cpu);
+        }
+    }
+
+    if (m_task_metrics)
+    {
+        m_task_metrics->attach_thread();
+    }
+
+    if (m_task_tracer)
+    {
+        m_task_tracer->attach_thread("Worker " + std::to_string(index));
+    }
+
+    TaskHolder task_holder;
+
+    while (m_keep_running.load())
+    {
+        if (!next_task(index, ++s_worker_context.m_tick, task_holder))
+        {
+            if (!park_worker())
+            {
+                break;
+            }
+        }
+        else if (m_keep_running.load())
+        {
+            observe_queue_latency(task_holder);
+            execute_task(task_holder);
+        }
+    }
+
+    TaskMetricsCollector::detach_thread();
+    TaskTracer::detach_thread();
+    s_worker_context = {};
+}
+
+//==================================================================================================
+void TaskManager::blocking_thread()
+{
+    System::set_thread_name("fly-blocking");
+
+    auto has_task_or_stopped = [this]()
+    {
+        return !m_blocking_tasks.empty() || !m_keep_running.load();
+    };
+
+    std::unique_lock<std::mutex> lock(m_blocking_tasks_mutex);
+
+    while (m_keep_running.load())
+    {
+        if (m_blocking_tasks.empty())
+        {
+            ++m_idle_blocking_threads;
+
+            const bool woken = m_blocking_tasks_condition.wait_for(
+                lock,
+                m_blocking_thread_idle_timeout,
+                has_task_or_stopped);
+
+            --m_idle_blocking_threads;
+
+            if (!woken)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        TaskHolder task_holder = std::move(m_blocking_tasks.front());
+        m_blocking_tasks.pop_front();
+
+        lock.unlock();
+        execute_task(task_holder);
+        lock.lock();
+    }
+
+    --m_blocking_threads;
+}
+
+//==================================================================================================
+bool TaskManager::is_worker_thread() const
+{
+    return s_worker_context.m_task_manager == this;
+}
+
+//==================================================================================================
+bool TaskManager::execute_pending_task()
+{
+    TaskHolder task_holder;
+
+    if (next_task(s_worker_context.m_index, ++s_worker_context.m_tick, task_holder))
+    {
+        observe_queue_latency(task_holder);
+        execute_task(task_holder);
+        return true;
+    }
+
+    return false;
+}
+
+//==================================================================================================
+void TaskManager::execute_task(TaskHolder &task_holder)
+{
+    if (auto task_runner = task_holder.m_weak_task_runner.lock(); task_runner)
+    {
+        TaskLocation location = std::move(task_holder.m_location);
+        Task task = std::move(task_holder.m_task);
+
+        task_runner->execute(std::move(location), std::move(task), task_holder.m_schedule);
+    }
+}
+
+//==================================================================================================
+bool TaskManager::next_task(std::uint32_t index, std::uint32_t tick, TaskHolder &task_holder)
+{
+    for (const TaskPriority priority : lane_order(tick))
+    {
+        const bool found = (priority == TaskPriority::Normal) ?
+            next_normal_task(index, tick, task_holder) :
+            task_lane(priority).pop(task_holder, std::chrono::milliseconds(0));
+
+        if (found)
+        {
+            m_queue_depth.release(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//==================================================================================================
+bool TaskManager::next_normal_task(std::uint32_t index, std::uint32_t tick, TaskHolder &task_holder)
+{
+    LockFreeQueue<TaskHolder> &tasks = task_lane(TaskPriority::Normal);
+
+    if (m_work_stealing)
+    {
+        if (((tick % s_shared_queue_interval) == 0) &&
+            tasks.pop(task_holder, std::chrono::milliseconds(0)))
+        {
+            return true;
+        }
+
+        WorkerQueue *worker_queue = m_worker_queues[index].get();
+        {
+            std::lock_guard<std::mutex> lock(worker_queue->m_mutex);
+
+            if (!worker_queue->m_tasks.empty())
+            {
+                task_holder = std::move(worker_queue->m_tasks.front());
+                worker_queue->m_tasks.pop_front();
+
+                return true;
+            }
+        }
+
+        if (tasks.pop(task_holder, std::chrono::milliseconds(0)) || steal_task(index, task_holder))
+        {
+            return true;
+        }
+    }
+
+    return tasks.pop(task_holder, std::chrono::milliseconds(0));
+}
+
+//==================================================================================================
+LockFreeQueue<TaskManager::TaskHolder> &TaskManager::task_lane(TaskPriority priority)
+{
+    return m_tasks[static_cast<std::size_t>(priority)];
+}
+
+//==================================================================================================
+bool TaskManager::steal_task(std::uint32_t index, TaskHolder &task_holder)
+{
+    const auto num_queues = static_cast<std::uint32_t>(m_worker_queues.size());
+    std::deque<TaskHolder> stolen_tasks;
+
+    for (std::uint32_t i = 1; i < num_queues; ++i)
+    {
+        WorkerQueue *victim = m_worker_queues[(index + i) % num_queues].get();
+        std::lock_guard<std::mutex> lock(victim->m_mutex);
+
+        if (!victim->m_tasks.empty())
+        {
+            const std::size_t steal_count = (victim->m_tasks.size() + 1) / 2;
+            const auto begin = victim->m_tasks.end() - static_cast<std::ptrdiff_t>(steal_count);
+
+            std::move(begin, victim->m_tasks.end(), std::back_inserter(stolen_tasks));
+            victim->m_tasks.erase(begin, victim->m_tasks.end());
+
+            break;
+        }
+    }
+
+    if (stolen_tasks.empty())
+    {
+        return false;
+    }
+
+    task_holder = std::move(stolen_tasks.front());
+    stolen_tasks.pop_front();
+
+    if (!stolen_tasks.empty())
+    {
+        WorkerQueue *worker_queue = m_worker_queues[index].get();
+        std::lock_guard<std::mutex> lock(worker_queue->m_mutex);
+
+        std::move(
+            stolen_tasks.begin(),
+            stolen_tasks.end(),
+            std::back_inserter(worker_queue->m_tasks));
+    }
+
+    return true;
+}
+
+//==================================================================================================
+bool TaskManager::has_pending_tasks()
+{
+    for (const auto &tasks : m_tasks)
+    {
+        if (!tasks.empty())
+        {
+            return true;
+        }
+    }
+
+    for (auto &worker_queue : m_worker_queues)
+    {
+        std::lock_guard<std::mutex> lock(worker_queue->m_mutex);
+
+        if (!worker_queue->m_tasks.empty())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//==================================================================================================
+bool TaskManager::park_worker()
+{
+    // The parked worker count must be incremented before checking for pending tasks. A task posted
+    // after the check will then observe this worker as parked and issue a wakeup.
+    m_parked_workers.fetch_add(1);
+    bool timed_out = false;
+
+    if (!has_pending_tasks())
+    {
+        std::unique_lock<std::mutex> lock(m_parking_mutex);
+
+        auto woken_or_stopped = [this]()
+        {
+            return (m_pending_wakeups > 0) || !m_keep_running.load();
+        };
+
+        if (m_elastic)
+        {
+            timed_out =
+                !m_parking_condition.wait_for(lock, m_worker_idle_timeout, woken_or_stopped);
+        }
+        else
+        {
+            m_parking_condition.wait(lock, woken_or_stopped);
+        }
+
+        if (m_pending_wakeups > 0)
+        {
+            --m_pending_wakeups;
+        }
+    }
+
+    m_parked_workers.fetch_sub(1);
+
+    return !timed_out || !retire_worker();
+}
+
+//==================================================================================================
+void TaskManager::park_waiting_worker(const detail::TaskFutureStateBase &state)
+{
+    // As with park_worker, the parked worker count must be incremented before checking for pending
+    // tasks so that a task posted after the check issues a wakeup.
+    m_parked_workers.fetch_add(1);
+    bool forward_wakeup = false;
+
+    if (!has_pending_tasks())
+    {
+        std::unique_lock<std::mutex> lock(m_parking_mutex);
+
+        auto woken_or_ready = [this, &state]()
+        {
+            return (m_pending_wakeups > 0) || state.is_ready() || !m_keep_running.load();
+        };
+
+        m_parking_condition.wait(lock, woken_or_ready);
+
+        if (m_pending_wakeups > 0)
+        {
+            // If the future state is ready, this worker will resume the task which was waiting on
+            // it rather than execute the newly posted task, so leave the wakeup for another worker.
+            if (state.is_ready())
+            {
+                forward_wakeup = true;
+            }
+            else
+            {
+                --m_pending_wakeups;
+            }
+        }
+    }
+
+    m_parked_workers.fetch_sub(1);
+
+    if (forward_wakeup)
+    {
+        m_parking_condition.notify_one();
+    }
+}
+
+//==================================================================================================
+void TaskManager::wake_waiting_workers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_parking_mutex);
+    }
+
+    m_parking_condition.notify_all();
+}
+
+//==================================================================================================
+void TaskManager::wake_workers(std::size_t count)
+{
+    if (const std::uint32_t parked_workers = m_parked_workers.load(); parked_workers > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_parking_mutex);
+
+            if (m_pending_wakeups < parked_workers)
+            {
+                const std::uint32_t available = parked_workers - m_pending_wakeups;
+                m_pending_wakeups += static_cast<std::uint32_t>(
+                    std::min(count, static_cast<std::size_t>(available)));
+            }
+        }
+
+        if (count == 1)
+        {
+            m_parking_condition.notify_one();
+        }
+        else
+        {
+            m_parking_condition.notify_all();
+        }
+    }
+}
+
+//==================================================================================================
+TaskManager::WorkerQueue *TaskManager::local_worker_queue()
+{
+    if ((s_worker_context.m_task_manager == this) && m_work_stealing)
+    {
+        return m_worker_queues[s_worker_context.m_index].get();
+    }
+
+    return nullptr;
+}
+
+//==================================================================================================
+void TaskManager::timer_thread()
+{
+    System::set_thread_name("fly-timer");
+
+    std::vector<TaskHolder> expired_tasks;
+    std::unique_lock<std::mutex> lock(m_delayed_tasks_mutex);
+
+    while (m_keep_running.load())
+    {
+        if (m_delayed_tasks.empty())
+        {
+            m_delayed_tasks_condition.wait(lock);
+            continue;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto schedule = m_delayed_tasks.front().m_task_holder.m_schedule;
+
+        if (schedule > now)
+        {
+            m_delayed_tasks_condition.wait_until(lock, schedule);
+            continue;
+        }
+
+        while (!m_delayed_tasks.empty() &&
+            (m_delayed_tasks.front().m_task_holder.m_schedule <= now))
+        {
+            expired_tasks.push_back(pop_delayed_task(0));
+        }
+
+        lock.unlock();
+
+        for (TaskHolder &expired_task : expired_tasks)
+        {
+            if (auto task_runner = expired_task.m_weak_task_runner.lock(); task_runner)
+            {
+                task_runner->post_admitted_task(
+                    std::move(expired_task.m_location),
+                    std::move(expired_task.m_task),
+                    expired_task.m_priority);
+            }
+        }
+
+        expired_tasks.clear();
+        lock.lock();
+    }
+}
+
+//==================================================================================================
+std::size_t TaskManager::parallel_concurrency() const
+{
+    if (m_keep_running.load() && m_parallel_task_runner)
+    {
+        return static_cast<std::size_t>(m_worker_count.load()) + 1;
+    }
+
+    return 1;
+}
+
 } // namespace fly
@@ -1,19 +1,39 @@
 #pragma once
 
+#include "fly/task/task_handle.hpp"
+#include "fly/task/task_metrics.hpp"
+#include "fly/task/task_parallel.hpp"
+#include "fly/task/task_queue_limit.hpp"
+#include "fly/task/task_tracer.hpp"
 #include "fly/task/task_types.hpp"
-#include "fly/types/concurrency/concurrent_queue.hpp"
+#include "fly/types/concurrency/lock_free_queue.hpp"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <future>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <type_traits>
 #include <vector>
 
 namespace fly {
 
+class TaskConfig;
 class TaskRunner;
 
+namespace detail {
+    class TaskFutureStateBase;
+} // namespace detail
+
 /**
  * Class to manage a pool of threads for executing tasks posted by any task runner. Also manages a
  * timer thread to hold delayed tasks until their scheduled time.
@@ -23,12 +43,18 @@ class TaskRunner;
  * controlled by the task runners. A task runner may hold on to a task in accordance with its
  * defined behavior until it is ready for the task manager to execute the task.
  *
+ * Tasks are queued in separate lanes according to their priority, and blocking tasks are executed
+ * by a separate pool of blocking threads. Optional behaviors, such as an elastic worker pool, work
+ * stealing, instrumentation, tracing, and queue limits, are enabled through the TaskConfig.
+ *
  * @author Timothy Flynn (trflynn89@pm.me)
  * @version August 12, 2018
  */
 class TaskManager : public std::enable_shared_from_this<TaskManager>
 {
+    friend class TaskHandle;
     friend class TaskRunner;
+    friend class detail::TaskFutureStateBase;
 
 public:
     /**
@@ -38,6 +64,15 @@ class TaskManager : public std::enable_shared_from_this<TaskManager>
      */
     explicit TaskManager(std::uint32_t num_workers) noexcept;
 
+    /**
+     * Constructor.
+     *
+     * @param num_workers Number of worker threads to create. With an elastic worker pool, this is
+     *        the minimum number of worker threads.
+     * @param config Reference to the task configuration.
+     */
+    TaskManager(std::uint32_t num_workers, const std::shared_ptr<TaskConfig> &config) noexcept;
+
     /**
      * Create the worker threads and timer thread.
      *
@@ -63,10 +98,146 @@ class TaskManager : public std::enable_shared_from_this<TaskManager>
      *
      * @tparam TaskRunnerType The type of task runner to create.
      *
+     * @param priority The default priority with which tasks posted to the task runner are
+     *        dispatched.
+     * @param limit The limit on the number of tasks which may be queued by the task runner, and
+     *        the policy applied once that limit is reached. Unbounded by default.
+     *
      * @return The created task runner.
      */
     template <typename TaskRunnerType>
-    std::shared_ptr<TaskRunnerType> create_task_runner();
+    std::shared_ptr<TaskRunnerType> create_task_runner(
+        TaskPriority priority = TaskPriority::Normal,
+        TaskQueueLimit limit = {});
+
+    /**
+     * Take a snapshot of the instrumentation recorded for every task location. Instrumentation must
+     * be enabled in the task configuration before the task manager is started. Each worker thread
+     * records the queueing delay and execution time of its tasks into its own histograms.
+     *
+     * @return The recorded instrumentation of each task location, or an empty list if
+     *         instrumentation is disabled.
+     */
+    std::vector<TaskMetrics> task_metrics() const;
+
+    /**
+     * Format the trace of the most recently executed tasks as a Chrome trace event JSON object.
+     * Tracing must be enabled in the task configuration before the task manager is started. Each
+     * worker thread retains its most recent tasks in a ring buffer (see TaskTracer).
+     *
+     * @return The formatted trace, or null if tracing is disabled.
+     */
+    Json task_trace() const;
+
+    /**
+     * @return The number of worker threads currently in the pool. With an elastic worker pool, this
+     *         varies between the minimum and maximum size of the pool.
+     */
+    std::uint32_t worker_count() const;
+
+    /**
+     * The shared queues may be bounded in the task configuration. Once at capacity, posting threads
+     * either block until space is available, have their tasks rejected, or have the oldest queued
+     * tasks dropped in favor of their tasks. Blocking tasks are not counted toward the limit, and
+     * tasks continuing already accepted work are counted but never blocked or rejected.
+     *
+     * @return A snapshot of the number of tasks queued in the shared queues, and of the tasks which
+     *         were rejected or dropped by the configured limit.
+     */
+    TaskQueueMetrics queue_metrics() const;
+
+    /**
+     * Invoke a function for each value in a range, in parallel. The range is split into chunks of
+     * adaptive size, which are executed by the calling thread and by any worker threads which are
+     * available. Blocks until the function has been invoked for every value in the range.
+     *
+     * The calling thread does not wait on worker threads which are busy with other tasks, so this
+     * may be safely invoked from within a task. If the function throws, no further chunks are
+     * started, and the first exception thrown is rethrown once all participating threads are done.
+     * The same holds for parallel_transform_reduce and parallel_sort. For example:
+     *
+     *       task_manager->parallel_for(
+     *           FROM_HERE,
+     *           std::size_t(0),
+     *           values.size(),
+     *           [&values](std::size_t index)
+     *           {
+     *               values[index] *= 2;
+     *           });
+     *
+     * @tparam IndexType Integral or random access iterator type of the range.
+     * @tparam Function Callable type of the function, invocable with a single IndexType.
+     *
+     * @param location The location from which the loop was invoked (use FROM_HERE).
+     * @param begin The first value in the range.
+     * @param end The value following the last value in the range.
+     * @param function The function to invoke for each value.
+     * @param grain_size The minimum number of values in a chunk. If zero, a grain size is chosen
+     *        based on the number of worker threads.
+     */
+    template <typename IndexType, typename Function>
+    void parallel_for(
+        TaskLocation &&location,
+        IndexType begin,
+        IndexType end,
+        Function &&function,
+        std::size_t grain_size = 0);
+
+    /**
+     * Transform each element in a range, and reduce the transformed elements with an initial
+     * value, in parallel. Each participating thread reduces the chunks it executes into a partial
+     * result, and the partial results are then reduced into the initial value. The reduction must
+     * therefore be both associative and commutative, as with std::transform_reduce.
+     *
+     * @tparam Iterator Random access iterator type of the range.
+     * @tparam T Type of the result.
+     * @tparam ReduceFunction Callable type of the reduction, invocable with two values of type T.
+     * @tparam TransformFunction Callable type of the transformation, invocable with an element of
+     *         the range.
+     *
+     * @param location The location from which the reduction was invoked (use FROM_HERE).
+     * @param begin Iterator to the first element in the range.
+     * @param end Iterator to the element following the last element in the range.
+     * @param init The initial value of the result.
+     * @param reduce The reduction to apply to the transformed elements.
+     * @param transform The transformation to apply to each element.
+     * @param grain_size The minimum number of elements in a chunk. If zero, a grain size is chosen
+     *        based on the number of worker threads.
+     *
+     * @return The reduced result.
+     */
+    template <typename Iterator, typename T, typename ReduceFunction, typename TransformFunction>
+    T parallel_transform_reduce(
+        TaskLocation &&location,
+        Iterator begin,
+        Iterator end,
+        T init,
+        ReduceFunction &&reduce,
+        TransformFunction &&transform,
+        std::size_t grain_size = 0);
+
+    /**
+     * Sort a range, in parallel. The range is split into blocks which are sorted in parallel, and
+     * the sorted blocks are then merged pairwise until a single sorted range remains. Each merge is
+     * itself split into independent parts by binary search, so that every merge pass (including
+     * the final merge) is executed in parallel. Merges alternate between the range and a buffer
+     * which is allocated once per sort. Ranges which are too small to benefit from parallelism are
+     * sorted on the calling thread. Like std::sort, the sort is not stable.
+     *
+     * @tparam Iterator Random access iterator type of the range.
+     * @tparam Compare Callable type of the comparator.
+     *
+     * @param location The location from which the sort was invoked (use FROM_HERE).
+     * @param begin Iterator to the first element in the range.
+     * @param end Iterator to the element following the last element in the range.
+     * @param compare The comparator with which to order the elements.
+     */
+    template <typename Iterator, typename Compare = std::less<>>
+    void parallel_sort(
+        TaskLocation &&location,
+        Iterator begin,
+        Iterator end,
+        Compare compare = Compare());
 
 private:
     /**
@@ -79,62 +250,802 @@ class TaskManager : public std::enable_shared_from_this<TaskManager>
         Task m_task;
         std::weak_ptr<TaskRunner> m_weak_task_runner;
         std::chrono::steady_clock::time_point m_schedule;
+        TaskPriority m_priority {TaskPriority::Normal};
+    };
+
+    /**
+     * A worker thread's local task queue, used when work stealing is enabled. Tasks posted from a
+     * worker thread are pushed onto its local queue rather than the shared queue. The owning worker
+     * pops tasks from the front of the queue, while other workers steal tasks from the back of the
+     * queue. Access from either end is guarded by the queue's mutex.
+     */
+    struct WorkerQueue
+    {
+        std::mutex m_mutex;
+        std::deque<TaskHolder> m_tasks;
+    };
+
+    /**
+     * Wrapper structure to order delayed tasks in the timer heap. Tasks with the same scheduled
+     * time are ordered by the sequence in which they were posted.
+     */
+    struct DelayedTaskHolder
+    {
+        TaskHolder m_task_holder;
+        std::uint64_t m_sequence {0};
+        std::uint32_t m_slot {0};
+    };
+
+    /**
+     * Structure to track the position of a delayed task in the timer heap, so that a delayed task
+     * may be cancelled in logarithmic time. Slots are recycled, so posting and cancelling delayed
+     * tasks does not allocate once the heap has reached its working size. The generation of a slot
+     * is incremented each time the slot is released, so that handles to a task which has since
+     * expired or been cancelled do not match a newer task stored in the same slot.
+     */
+    struct DelayedTaskSlot
+    {
+        std::size_t m_position {0};
+        std::uint32_t m_generation {0};
+        bool m_in_use {false};
     };
 
     /**
-     * Post a task to be executed as soon as a worker thread is available.
+     * Post a task to be executed as soon as a worker thread is available. The task must have
+     * already been admitted against the limit of the shared queues (see admit_tasks).
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      * @param weak_task_runner The task runner posting the task.
      */
-    void
-    post_task(TaskLocation &&location, Task &&task, std::weak_ptr<TaskRunner> weak_task_runner);
+    void post_task(
+        TaskLocation &&location,
+        Task &&task,
+        TaskPriority priority,
+        std::weak_ptr<TaskRunner> weak_task_runner);
+
+    /**
+     * Post a batch of tasks to be executed as soon as worker threads are available. The tasks are
+     * enqueued with a single operation, and idle worker threads are woken once. The tasks must have
+     * already been admitted against the limit of the shared queues (see admit_tasks).
+     *
+     * @param location The location from which the tasks were posted.
+     * @param tasks The tasks to be executed.
+     * @param priority The priority with which to dispatch the tasks.
+     * @param weak_task_runner The task runner posting the tasks.
+     */
+    void post_tasks(
+        TaskLocation &&location,
+        std::vector<Task> &&tasks,
+        TaskPriority priority,
+        std::weak_ptr<TaskRunner> weak_task_runner);
+
+    /**
+     * Post a helper task of a data-parallel algorithm. Helper tasks are posted through the
+     * task manager's own parallel task runner, bypassing the limit of the shared queues.
+     *
+     * @param location The location from which the algorithm was invoked.
+     * @param task The helper task to be executed.
+     */
+    void post_parallel_task(TaskLocation &&location, Task &&task);
+
+    /**
+     * Apply the limit of the shared queues to tasks which are about to be posted. Depending on the
+     * configured overflow policy, blocks until the shared queues have space for the tasks, rejects
+     * the tasks, or drops the oldest queued tasks to make space for the tasks. Blocking tasks, and
+     * tasks posted while the task manager is not running, are always admitted.
+     *
+     * @param priority The priority with which the tasks will be dispatched.
+     * @param count The number of tasks.
+     *
+     * @return True if the tasks were admitted.
+     */
+    bool admit_tasks(TaskPriority priority, std::size_t count);
+
+    /**
+     * Drop the oldest tasks queued in the shared queues, starting with the lowest priority lane,
+     * and then from the worker threads' local queues. The task runner of each dropped task is
+     * notified so that it may release any state held for the task.
+     *
+     * @param count The number of tasks to drop.
+     */
+    void drop_oldest_tasks(std::size_t count);
 
     /**
      * Schedule a task to be posted for execution after some delay.
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      * @param weak_task_runner The task runner posting the task.
      * @param delay Delay before posting the task.
+     *
+     * @return A handle through which the delayed task may be cancelled.
      */
-    void post_task_with_delay(
+    TaskHandle post_task_with_delay(
         TaskLocation &&location,
         Task &&task,
+        TaskPriority priority,
         std::weak_ptr<TaskRunner> weak_task_runner,
-        std::chrono::milliseconds delay);
+        std::chrono::nanoseconds delay);
+
+    /**
+     * Remove a delayed task from the timer heap, if its delay has not yet expired. The task is
+     * destroyed without being executed.
+     *
+     * @param slot The slot holding the delayed task.
+     * @param generation The generation of the slot when the delayed task was stored.
+     *
+     * @return True if the delayed task was removed.
+     */
+    bool cancel_delayed_task(std::uint32_t slot, std::uint32_t generation);
+
+    /**
+     * @param slot The slot holding the delayed task.
+     * @param generation The generation of the slot when the delayed task was stored.
+     *
+     * @return True if the delayed task is still in the timer heap.
+     */
+    bool is_delayed_task_pending(std::uint32_t slot, std::uint32_t generation);
+
+    /**
+     * Variant of is_delayed_task_pending to be used while the delayed tasks mutex is held.
+     *
+     * @param slot The slot holding the delayed task.
+     * @param generation The generation of the slot when the delayed task was stored.
+     *
+     * @return True if the delayed task is still in the timer heap.
+     */
+    bool is_delayed_task_pending_locked(std::uint32_t slot, std::uint32_t generation) const;
+
+    /**
+     * Insert a delayed task into the timer heap, storing its position in a free slot. The delayed
+     * tasks mutex must be held.
+     *
+     * @param delayed_task The delayed task to insert.
+     *
+     * @return The slot holding the delayed task.
+     */
+    std::uint32_t push_delayed_task(DelayedTaskHolder &&delayed_task);
+
+    /**
+     * Remove the delayed task at a position in the timer heap, releasing its slot. The delayed
+     * tasks mutex must be held.
+     *
+     * @param position The position of the delayed task in the heap.
+     *
+     * @return The removed task.
+     */
+    TaskHolder pop_delayed_task(std::size_t position);
+
+    /**
+     * Move the delayed task at a position in the timer heap towards the root of the heap until the
+     * heap is ordered. The delayed tasks mutex must be held.
+     *
+     * @param position The position of the delayed task in the heap.
+     */
+    void sift_delayed_task_up(std::size_t position);
+
+    /**
+     * Move the delayed task at a position in the timer heap away from the root of the heap until
+     * the heap is ordered. The delayed tasks mutex must be held.
+     *
+     * @param position The position of the delayed task in the heap.
+     */
+    void sift_delayed_task_down(std::size_t position);
+
+    /**
+     * Swap two delayed tasks in the timer heap, updating the positions stored in their slots. The
+     * delayed tasks mutex must be held.
+     *
+     * @param position1 The position of the first delayed task in the heap.
+     * @param position2 The position of the second delayed task in the heap.
+     */
+    void swap_delayed_tasks(std::size_t position1, std::size_t position2);
+
+    /**
+     * Queue a task to be executed by a blocking thread, creating a new blocking thread if none are
+     * idle.
+     *
+     * @param task_holder The task to be executed.
+     */
+    void post_blocking_task(TaskHolder &&task_holder);
+
+    /**
+     * Queue a batch of tasks to be executed by blocking threads, creating new blocking threads if
+     * not enough are idle.
+     *
+     * @param task_holders The tasks to be executed.
+     */
+    void post_blocking_tasks(std::vector<TaskHolder> &&task_holders);
+
+    /**
+     * Create a blocking thread if there are more queued blocking tasks than idle blocking threads,
+     * and the maximum number of blocking threads has not been reached. The blocking tasks mutex
+     * must be held.
+     */
+    void maybe_create_blocking_thread();
+
+    /**
+     * Create a worker thread if the worker pool is elastic, the observed queueing latency exceeds
+     * the configured spawn latency, no worker thread has been created within the last spawn latency
+     * interval, and the maximum number of worker threads has not been reached.
+     *
+     * @param latency The observed queueing latency.
+     */
+    void maybe_create_worker(std::chrono::steady_clock::duration latency);
+
+    /**
+     * Create a worker thread in the first unused slot of the pool. The workers mutex must be held.
+     */
+    void create_worker();
+
+    /**
+     * Remove the calling worker thread from the pool, if there are no pending tasks and the pool is
+     * larger than its minimum size.
+     *
+     * @return True if the calling worker thread was removed from the pool, and should exit.
+     */
+    bool retire_worker();
 
     /**
-     * Worker thread for executing tasks.
+     * Check whether an elastic worker pool should grow after posting tasks. If no worker thread is
+     * idle, the time since a worker thread last retrieved a task is a lower bound on the latency of
+     * the tasks which are queued.
+     *
+     * @param now The time at which the tasks were posted.
      */
-    void worker_thread();
+    void observe_post_latency(std::chrono::steady_clock::time_point now);
 
     /**
-     * Timer thread for holding delayed tasks until their scheduled time.
+     * Record that a worker thread has retrieved a task, to track the queueing latency observed by
+     * an elastic worker pool.
+     *
+     * @param task_holder The retrieved task.
+     */
+    void observe_queue_latency(const TaskHolder &task_holder);
+
+    /**
+     * Worker thread for executing tasks. Threads created by the task manager are named (e.g.
+     * "fly-worker-0") so that they may be identified by system tools, and are optionally pinned to
+     * a CPU.
+     *
+     * @param index The index of the worker thread in the pool.
+     */
+    void worker_thread(std::uint32_t index);
+
+    /**
+     * Blocking thread for executing blocking tasks. The thread exits once it has been idle for the
+     * configured timeout, or the task manager is stopped. Blocking tasks are not instrumented or
+     * traced.
+     */
+    void blocking_thread();
+
+    /**
+     * @return True if the calling thread is a worker thread of this task manager.
+     */
+    bool is_worker_thread() const;
+
+    /**
+     * Execute the next pending task, if any, on the calling worker thread. Allows worker threads
+     * which are waiting on the result of another task to help execute pending tasks, rather than
+     * blocking. The calling thread must be a worker thread of this task manager.
+     *
+     * @return True if a task was executed.
+     */
+    bool execute_pending_task();
+
+    /**
+     * Park the calling worker thread, which is waiting on the given future state, until it is woken
+     * by a newly posted task, the future state becomes ready, or the task manager is stopped. If
+     * there are already tasks pending, returns immediately. The calling thread must be a worker
+     * thread of this task manager.
+     *
+     * @param state The future state being waited on.
+     */
+    void park_waiting_worker(const detail::TaskFutureStateBase &state);
+
+    /**
+     * Wake all parked worker threads, so that any which are waiting on a future state that has
+     * become ready may resume.
+     */
+    void wake_waiting_workers();
+
+    /**
+     * Execute a task retrieved for a worker thread, if its task runner still exists.
+     *
+     * @param task_holder The task to execute.
+     */
+    void execute_task(TaskHolder &task_holder);
+
+    /**
+     * Retrieve the next task for a worker thread to execute, without blocking. The priority lanes
+     * are checked in order of priority, except that lower priority lanes are periodically checked
+     * first so that lower priority tasks are not starved.
+     *
+     * @param index The index of the worker thread in the pool.
+     * @param tick The number of times the worker thread has requested a task.
+     * @param task_holder Location to store the retrieved task.
+     *
+     * @return True if a task was retrieved.
+     */
+    bool next_task(std::uint32_t index, std::uint32_t tick, TaskHolder &task_holder);
+
+    /**
+     * Retrieve the next normal priority task for a worker thread to execute, without blocking.
+     * With work stealing enabled, the worker's local queue is checked first, then the shared queue,
+     * and finally other workers' local queues. The shared queue is also periodically checked first
+     * so that tasks posted from outside of the worker pool are not starved.
+     *
+     * @param index The index of the worker thread in the pool.
+     * @param tick The number of times the worker thread has requested a task.
+     * @param task_holder Location to store the retrieved task.
+     *
+     * @return True if a task was retrieved.
+     */
+    bool next_normal_task(std::uint32_t index, std::uint32_t tick, TaskHolder &task_holder);
+
+    /**
+     * @return The shared queue of tasks with the given priority.
+     */
+    LockFreeQueue<TaskHolder> &task_lane(TaskPriority priority);
+
+    /**
+     * Steal tasks from another worker thread's local queue. Up to half of the tasks in the first
+     * non-empty queue found are moved into the stealing worker's local queue.
+     *
+     * @param index The index of the stealing worker thread in the pool.
+     * @param task_holder Location to store the first stolen task.
+     *
+     * @return True if a task was stolen.
+     */
+    bool steal_task(std::uint32_t index, TaskHolder &task_holder);
+
+    /**
+     * @return True if there are any tasks in the shared queues or in any worker's local queue.
+     */
+    bool has_pending_tasks();
+
+    /**
+     * Park the calling worker thread on a condition variable until it is woken by a newly posted
+     * task, or until the task manager is stopped, so that an idle task manager consumes no CPU
+     * time. If there are already tasks pending, returns immediately. With an elastic worker pool,
+     * the worker thread is retired if it is not woken within the idle timeout.
+     *
+     * @return False if the calling worker thread was retired, and should exit.
+     */
+    bool park_worker();
+
+    /**
+     * Wake parked worker threads, if there are any, to execute newly posted tasks.
+     *
+     * @param count The number of newly posted tasks.
+     */
+    void wake_workers(std::size_t count);
+
+    /**
+     * @return If the calling thread is a worker thread of this task manager, and work stealing is
+     *         enabled, that worker's local queue. Otherwise, null. Only normal priority tasks are
+     *         pushed onto local queues.
+     */
+    WorkerQueue *local_worker_queue();
+
+    /**
+     * Timer thread for holding delayed tasks until their scheduled time. The thread sleeps until
+     * the earliest scheduled task is due, then hands all due tasks back to their task runners.
      */
     void timer_thread();
 
-    ConcurrentQueue<TaskHolder> m_tasks;
+    /**
+     * @return The maximum number of threads which may participate in a data-parallel algorithm,
+     *         including the calling thread.
+     */
+    std::size_t parallel_concurrency() const;
+
+    /**
+     * Execute a data-parallel loop over the index range [0, size). Helper tasks are posted for the
+     * worker threads to join the loop, and the calling thread then participates in the loop itself
+     * before waiting for any worker threads which joined the loop to finish.
+     *
+     * @tparam Participant Callable type of the loop body, invocable with a ParallelLoop from which
+     *         the participant claims chunks of the range.
+     *
+     * @param location The location from which the loop was invoked.
+     * @param size The size of the index range.
+     * @param grain_size The minimum size of a chunk. If zero, a grain size is chosen based on the
+     *        number of worker threads.
+     * @param participant The loop body to be executed by each participating thread.
+     */
+    template <typename Participant>
+    void parallel_execute(
+        TaskLocation &&location,
+        std::size_t size,
+        std::size_t grain_size,
+        Participant &participant);
+
+    // With an automatically chosen grain size, the number of chunks each participant of a
+    // data-parallel loop would execute if the range were split evenly.
+    static constexpr std::size_t s_parallel_chunks_per_participant = 16;
+
+    // The minimum number of elements in each block sorted by parallel_sort.
+    static constexpr std::size_t s_parallel_sort_block_size = 2048;
+
+    std::shared_ptr<TaskConfig> m_config;
+    std::unique_ptr<TaskMetricsCollector> m_task_metrics;
+    std::unique_ptr<TaskTracer> m_task_tracer;
+
+    std::array<LockFreeQueue<TaskHolder>, static_cast<std::size_t>(TaskPriority::NumPriorities)>
+        m_tasks;
+    detail::TaskQueueDepth m_queue_depth;
+
+    bool m_work_stealing {false};
+    std::vector<std::unique_ptr<WorkerQueue>> m_worker_queues;
+
+    std::mutex m_parking_mutex;
+    std::condition_variable m_parking_condition;
+    std::atomic<std::uint32_t> m_parked_workers {0};
+    std::uint32_t m_pending_wakeups {0};
+
+    std::mutex m_blocking_tasks_mutex;
+    std::condition_variable m_blocking_tasks_condition;
+    std::deque<TaskHolder> m_blocking_tasks;
+    std::vector<std::future<void>> m_blocking_futures;
+    std::uint32_t m_blocking_threads {0};
+    std::uint32_t m_idle_blocking_threads {0};
+    std::uint32_t m_max_blocking_threads {0};
+    std::chrono::milliseconds m_blocking_thread_idle_timeout {0};
 
     std::mutex m_delayed_tasks_mutex;
-    std::vector<TaskHolder> m_delayed_tasks;
+    std::condition_variable m_delayed_tasks_condition;
+    std::vector<DelayedTaskHolder> m_delayed_tasks;
+    std::vector<DelayedTaskSlot> m_delayed_task_slots;
+    std::vector<std::uint32_t> m_free_delayed_task_slots;
+    std::uint64_t m_delayed_tasks_sequence {0};
 
     std::atomic_bool m_keep_running;
 
+    std::mutex m_workers_mutex;
     std::vector<std::future<void>> m_futures;
+    std::vector<bool> m_active_workers;
+    std::atomic<std::uint32_t> m_worker_count {0};
+    std::chrono::steady_clock::time_point m_last_worker_creation;
+
+    bool m_elastic {false};
+    std::uint32_t m_max_workers {0};
+    std::chrono::microseconds m_worker_spawn_latency {0};
+    std::chrono::milliseconds m_worker_idle_timeout {0};
+    std::atomic<std::chrono::steady_clock::rep> m_last_dequeue_time {0};
+
+    std::vector<std::uint32_t> m_worker_cpu_affinity;
+
+    std::shared_ptr<TaskRunner> m_parallel_task_runner;
 
     std::uint32_t m_num_workers;
 };
 
 //==================================================================================================
 template <typename TaskRunnerType>
-std::shared_ptr<TaskRunnerType> TaskManager::create_task_runner()
+std::shared_ptr<TaskRunnerType>
+TaskManager::create_task_runner(TaskPriority priority, TaskQueueLimit limit)
 {
     static_assert(std::is_base_of_v<TaskRunner, TaskRunnerType>);
 
     const std::shared_ptr<TaskManager> task_manager = shared_from_this();
-    return std::shared_ptr<TaskRunnerType>(new TaskRunnerType(task_manager));
+
+    auto task_runner = std::shared_ptr<TaskRunnerType>(new TaskRunnerType(task_manager));
+    task_runner->m_priority = priority;
+    task_runner->m_queue_depth.set_limit(limit);
+
+    return task_runner;
+}
+
+//==================================================================================================
+template <typename IndexType, typename Function>
+void TaskManager::parallel_for(
+    TaskLocation &&location,
+    IndexType begin,
+    IndexType end,
+    Function &&function,
+    std::size_t grain_size)
+{
+    using DifferenceType = decltype(end - begin);
+
+    if (!(begin < end))
+    {
+        return;
+    }
+
+    auto participant = [&begin, &function](detail::ParallelLoop &loop)
+    {
+        std::size_t chunk_begin = 0;
+        std::size_t chunk_end = 0;
+
+        while (loop.next_chunk(chunk_begin, chunk_end))
+        {
+            for (std::size_t i = chunk_begin; i < chunk_end; ++i)
+            {
+                std::invoke(function, begin + static_cast<DifferenceType>(i));
+            }
+        }
+    };
+
+    parallel_execute(
+        std::move(location),
+        static_cast<std::size_t>(end - begin),
+        grain_size,
+        participant);
+}
+
+//==================================================================================================
+template <typename Iterator, typename T, typename ReduceFunction, typename TransformFunction>
+T TaskManager::parallel_transform_reduce(
+    TaskLocation &&location,
+    Iterator begin,
+    Iterator end,
+    T init,
+    ReduceFunction &&reduce,
+    TransformFunction &&transform,
+    std::size_t grain_size)
+{
+    using DifferenceType = decltype(end - begin);
+
+    if (!(begin < end))
+    {
+        return init;
+    }
+
+    std::mutex result_mutex;
+    T result = std::move(init);
+
+    auto participant = [&](detail::ParallelLoop &loop)
+    {
+        std::optional<T> partial;
+        std::size_t chunk_begin = 0;
+        std::size_t chunk_end = 0;
+
+        while (loop.next_chunk(chunk_begin, chunk_end))
+        {
+            for (std::size_t i = chunk_begin; i < chunk_end; ++i)
+            {
+                auto &&element = *(begin + static_cast<DifferenceType>(i));
+
+                if (partial)
+                {
+                    *partial = std::invoke(
+                        reduce,
+                        std::move(*partial),
+                        std::invoke(transform, element));
+                }
+                else
+                {
+                    partial.emplace(std::invoke(transform, element));
+                }
+            }
+        }
+
+        if (partial)
+        {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            result = std::invoke(reduce, std::move(result), std::move(*partial));
+        }
+    };
+
+    parallel_execute(
+        std::move(location),
+        static_cast<std::size_t>(end - begin),
+        grain_size,
+        participant);
+
+    return result;
+}
+
+//==================================================================================================
+template <typename Iterator, typename Compare>
+void TaskManager::parallel_sort(
+    TaskLocation &&location,
+    Iterator begin,
+    Iterator end,
+    Compare compare)
+{
+    using DifferenceType = decltype(end - begin);
+    using ValueType = typename std::iterator_traits<Iterator>::value_type;
+
+    const auto size = static_cast<std::size_t>(std::max(end - begin, DifferenceType(0)));
+    const std::size_t concurrency = parallel_concurrency();
+
+    // Use a power-of-two number of blocks so that the blocks may be merged pairwise, with a few
+    // blocks per participant to balance the load of sorting blocks.
+    std::size_t blocks =
+        std::bit_floor(std::min(size / s_parallel_sort_block_size, concurrency * 4));
+
+    // Each merge pass moves the range between the buffer and the range itself. The blocks are
+    // sorted in the buffer, so use an odd number of merge passes for the result to end up in the
+    // range.
+    if ((std::bit_width(blocks) % 2) == 1)
+    {
+        blocks /= 2;
+    }
+
+    if (blocks <= 1)
+    {
+        std::sort(begin, end, compare);
+        return;
+    }
+
+    std::vector<ValueType> buffer(std::make_move_iterator(begin), std::make_move_iterator(end));
+
+    auto bound = [size, blocks](std::size_t index)
+    {
+        return static_cast<DifferenceType>(size * index / blocks);
+    };
+
+    auto sort_block = [&buffer, &bound, &compare](std::size_t index)
+    {
+        std::sort(buffer.begin() + bound(index), buffer.begin() + bound(index + 1), compare);
+    };
+
+    parallel_for(TaskLocation(location), std::size_t(0), blocks, sort_block, 1);
+
+    // Find the number of elements from the sorted run [first1, first1 + size1) which precede the
+    // element at the given position of the merge of that run with [first2, first2 + size2).
+    auto split = [&compare](
+                     auto first1,
+                     std::size_t size1,
+                     auto first2,
+                     std::size_t size2,
+                     std::size_t position)
+    {
+        std::size_t low = (position > size2) ? (position - size2) : 0;
+        std::size_t high = std::min(position, size1);
+
+        while (low < high)
+        {
+            const std::size_t index = low + (high - low) / 2;
+            const auto other = static_cast<DifferenceType>(position - index);
+
+            if (compare(first2[other - 1], first1[static_cast<DifferenceType>(index)]))
+            {
+                high = index;
+            }
+            else
+            {
+                low = index + 1;
+            }
+        }
+
+        return low;
+    };
+
+    // The merge of each pair of runs is split into parts of equal size. All split points are found
+    // before any part is merged, as merging a part moves elements out of the source.
+    std::vector<std::size_t> splits;
+
+    auto merge_pass = [&](auto source, auto destination, std::size_t width)
+    {
+        const std::size_t pairs = blocks / (width * 2);
+        const std::size_t parts = std::max(concurrency * 2 / pairs, std::size_t(1));
+
+        auto run_bounds = [&bound, width](std::size_t pair)
+        {
+            return std::array<DifferenceType, 3> {
+                bound(pair * width * 2),
+                bound(pair * width * 2 + width),
+                bound(pair * width * 2 + width * 2)};
+        };
+
+        splits.resize(pairs * (parts + 1));
+
+        for (std::size_t pair = 0; pair < pairs; ++pair)
+        {
+            const auto [first, middle, last] = run_bounds(pair);
+            const auto size1 = static_cast<std::size_t>(middle - first);
+            const auto size2 = static_cast<std::size_t>(last - middle);
+
+            for (std::size_t part = 0; part <= parts; ++part)
+            {
+                const std::size_t position = (size1 + size2) * part / parts;
+
+                splits[pair * (parts + 1) + part] =
+                    split(source + first, size1, source + middle, size2, position);
+            }
+        }
+
+        auto merge_part = [&](std::size_t task)
+        {
+            const std::size_t pair = task / parts;
+            const std::size_t part = task % parts;
+
+            const auto [first, middle, last] = run_bounds(pair);
+            const auto merged_size = static_cast<std::size_t>(last - first);
+
+            const std::size_t part_begin = merged_size * part / parts;
+            const std::size_t part_end = merged_size * (part + 1) / parts;
+
+            const auto begin1 = static_cast<DifferenceType>(splits[pair * (parts + 1) + part]);
+            const auto end1 = static_cast<DifferenceType>(splits[pair * (parts + 1) + part + 1]);
+            const auto begin2 = static_cast<DifferenceType>(part_begin) - begin1;
+            const auto end2 = static_cast<DifferenceType>(part_end) - end1;
+
+            std::merge(
+                std::make_move_iterator(source + first + begin1),
+                std::make_move_iterator(source + first + end1),
+                std::make_move_iterator(source + middle + begin2),
+                std::make_move_iterator(source + middle + end2),
+                destination + first + static_cast<DifferenceType>(part_begin),
+                compare);
+        };
+
+        parallel_for(TaskLocation(location), std::size_t(0), pairs * parts, merge_part, 1);
+    };
+
+    for (std::size_t width = 1; width < blocks; width *= 2)
+    {
+        if ((std::bit_width(width) % 2) == 1)
+        {
+            merge_pass(buffer.begin(), begin, width);
+        }
+        else
+        {
+            merge_pass(begin, buffer.begin(), width);
+        }
+    }
+}
+
+//==================================================================================================
+template <typename Participant>
+void TaskManager::parallel_execute(
+    TaskLocation &&location,
+    std::size_t size,
+    std::size_t grain_size,
+    Participant &participant)
+{
+    const std::size_t concurrency = parallel_concurrency();
+
+    if (grain_size == 0)
+    {
+        grain_size = size / (concurrency * s_parallel_chunks_per_participant);
+        grain_size = std::max(grain_size, std::size_t(1));
+    }
+
+    const std::size_t chunks = (size + grain_size - 1) / grain_size;
+    const std::size_t helpers = std::min(concurrency, chunks) - 1;
+
+    auto loop = std::make_shared<detail::ParallelLoop>(size, grain_size, helpers + 1);
+
+    for (std::size_t i = 0; i < helpers; ++i)
+    {
+        auto helper = [loop, &participant](TaskRunner *, TaskLocation)
+        {
+            if (loop->enter())
+            {
+                detail::ParallelLoopParticipant scoped_participant(*loop);
+
+                try
+                {
+                    participant(*loop);
+                }
+                catch (...)
+                {
+                    loop->fail(std::current_exception());
+                }
+            }
+        };
+
+        post_parallel_task(TaskLocation(location), std::move(helper));
+    }
+
+    try
+    {
+        participant(*loop);
+    }
+    catch (...)
+    {
+        loop->fail(std::current_exception());
+    }
+
+    // Rethrows the first exception thrown by any participant, including the calling thread.
+    loop->close_and_wait();
 }
 
 } // namespace fly
@@ -0,0 +1,292 @@
+#include "fly/task/task_metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace fly {
+
+namespace {
+
+    /**
+     * Convert the time between two points to a non-negative number of nanoseconds.
+     *
+     * @param start The starting point.
+     * @param end The ending point.
+     *
+     * @return The number of nanoseconds between the points, or zero if the end precedes the start.
+     */
+    std::uint64_t elapsed_nanoseconds(
+        std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end)
+    {
+        if (end <= start)
+        {
+            return 0;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        return static_cast<std::uint64_t>(elapsed.count());
+    }
+
+} // namespace
+
+thread_local TaskMetricsCollector::ThreadMetrics *TaskMetricsCollector::s_thread_metrics = nullptr;
+
+//==================================================================================================
+void LogLinearHistogram::record(std::uint64_t value, std::uint64_t count)
+{
+    record_bucket(bucket_index(value), count);
+}
+
+//==================================================================================================
+void LogLinearHistogram::record_bucket(std::size_t index, std::uint64_t count)
+{
+    m_buckets[index] += count;
+    m_count += count;
+}
+
+//==================================================================================================
+void LogLinearHistogram::merge(const LogLinearHistogram &histogram)
+{
+    for (std::size_t i = 0; i < s_bucket_count; ++i)
+    {
+        m_buckets[i] += histogram.m_buckets[i];
+    }
+
+    m_count += histogram.m_count;
+}
+
+//==================================================================================================
+std::uint64_t LogLinearHistogram::count() const
+{
+    return m_count;
+}
+
+//==================================================================================================
+std::uint64_t LogLinearHistogram::bucket(std::size_t index) const
+{
+    return m_buckets[index];
+}
+
+//==================================================================================================
+std::uint64_t LogLinearHistogram::percentile(double percentile) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+
+    const auto target = std::max(
+        static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(m_count))),
+        std::uint64_t(1));
+
+    std::uint64_t cumulative = 0;
+
+    for (std::size_t i = 0; i < s_bucket_count; ++i)
+    {
+        cumulative += m_buckets[i];
+
+        if (cumulative >= target)
+        {
+            return bucket_upper_bound(i);
+        }
+    }
+
+    return bucket_upper_bound(s_bucket_count - 1);
+}
+
+//==================================================================================================
+std::size_t LogLinearHistogram::bucket_index(std::uint64_t value)
+{
+    if (value < s_sub_bucket_count)
+    {
+        return static_cast<std::size_t>(value);
+    }
+
+    const auto exponent = static_cast<std::size_t>(std::bit_width(value)) - 1;
+    const auto group = exponent - s_sub_bucket_bits + 1;
+    const auto sub_bucket = static_cast<std::size_t>(value >> (exponent - s_sub_bucket_bits));
+
+    return (group * s_sub_bucket_count) + (sub_bucket - s_sub_bucket_count);
+}
+
+//==================================================================================================
+std::uint64_t LogLinearHistogram::bucket_lower_bound(std::size_t index)
+{
+    if (index < s_sub_bucket_count)
+    {
+        return static_cast<std::uint64_t>(index);
+    }
+
+    const std::size_t shift = (index / s_sub_bucket_count) - 1;
+    const std::size_t sub_bucket = index % s_sub_bucket_count;
+
+    return static_cast<std::uint64_t>(s_sub_bucket_count + sub_bucket) << shift;
+}
+
+//==================================================================================================
+std::uint64_t LogLinearHistogram::bucket_upper_bound(std::size_t index)
+{
+    if ((index + 1) >= s_bucket_count)
+    {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+
+    return bucket_lower_bound(index + 1) - 1;
+}
+
+//==================================================================================================
+void TaskMetricsCollector::attach_thread()
+{
+    std::lock_guard<std::mutex> lock(m_threads_mutex);
+
+    for (auto &thread_metrics : m_threads)
+    {
+        if (!thread_metrics->m_attached.load(std::memory_order_acquire))
+        {
+            thread_metrics->m_attached.store(true, std::memory_order_relaxed);
+            s_thread_metrics = thread_metrics.get();
+
+            return;
+        }
+    }
+
+    auto thread_metrics = std::make_unique<ThreadMetrics>();
+    s_thread_metrics = thread_metrics.get();
+
+    m_threads.push_back(std::move(thread_metrics));
+}
+
+//==================================================================================================
+void TaskMetricsCollector::detach_thread()
+{
+    if (s_thread_metrics != nullptr)
+    {
+        s_thread_metrics->m_attached.store(false, std::memory_order_release);
+        s_thread_metrics = nullptr;
+    }
+}
+
+//==================================================================================================
+void TaskMetricsCollector::record(
+    const TaskLocation &location,
+    std::chrono::steady_clock::time_point ready_time,
+    std::chrono::steady_clock::time_point start_time,
+    std::chrono::steady_clock::time_point end_time)
+{
+    if (s_thread_metrics != nullptr)
+    {
+        LocationMetrics &metrics = location_metrics(*s_thread_metrics, location);
+
+        metrics.m_queue_delay.record(elapsed_nanoseconds(ready_time, start_time));
+        metrics.m_execution_time.record(elapsed_nanoseconds(start_time, end_time));
+    }
+}
+
+//==================================================================================================
+bool TaskMetricsCollector::is_thread_attached()
+{
+    return s_thread_metrics != nullptr;
+}
+
+//==================================================================================================
+std::vector<TaskMetrics> TaskMetricsCollector::snapshot() const
+{
+    std::vector<TaskMetrics> snapshot;
+    std::unordered_map<LocationKey, std::size_t, LocationKeyHash> indices;
+
+    std::lock_guard<std::mutex> threads_lock(m_threads_mutex);
+
+    for (const auto &thread_metrics : m_threads)
+    {
+        std::lock_guard<std::mutex> lock(thread_metrics->m_mutex);
+
+        for (const auto &[key, location_metrics] : thread_metrics->m_locations)
+        {
+            auto it = indices.find(key);
+
+            if (it == indices.end())
+            {
+                it = indices.emplace(key, snapshot.size()).first;
+                snapshot.push_back({location_metrics->m_location, {}, {}});
+            }
+
+            TaskMetrics &metrics = snapshot[it->second];
+            location_metrics->m_queue_delay.snapshot_into(metrics.m_queue_delay);
+            location_metrics->m_execution_time.snapshot_into(metrics.m_execution_time);
+        }
+    }
+
+    return snapshot;
+}
+
+//==================================================================================================
+auto TaskMetricsCollector::location_metrics(
+    ThreadMetrics &thread_metrics,
+    const TaskLocation &location) -> LocationMetrics &
+{
+    const LocationKey key {location.m_file, location.m_function, location.m_line};
+
+    if (LocationMetrics *last = thread_metrics.m_last_location; last != nullptr)
+    {
+        const LocationKey last_key {
+            last->m_location.m_file,
+            last->m_location.m_function,
+            last->m_location.m_line};
+
+        if (key == last_key)
+        {
+            return *last;
+        }
+    }
+
+    auto it = thread_metrics.m_locations.find(key);
+
+    if (it == thread_metrics.m_locations.end())
+    {
+        auto metrics = std::make_unique<LocationMetrics>();
+        metrics->m_location = location;
+
+        std::lock_guard<std::mutex> lock(thread_metrics.m_mutex);
+        it = thread_metrics.m_locations.emplace(key, std::move(metrics)).first;
+    }
+
+    thread_metrics.m_last_location = it->second.get();
+    return *thread_metrics.m_last_location;
+}
+
+//==================================================================================================
+void TaskMetricsCollector::AtomicHistogram::record(std::uint64_t value)
+{
+    std::atomic<std::uint64_t> &bucket = m_buckets[LogLinearHistogram::bucket_index(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+//==================================================================================================
+void TaskMetricsCollector::AtomicHistogram::snapshot_into(LogLinearHistogram &histogram) const
+{
+    for (std::size_t i = 0; i < LogLinearHistogram::s_bucket_count; ++i)
+    {
+        if (const std::uint64_t count = m_buckets[i].load(std::memory_order_relaxed); count > 0)
+        {
+            histogram.record_bucket(i, count);
+        }
+    }
+}
+
+//==================================================================================================
+std::size_t TaskMetricsCollector::LocationKeyHash::operator()(const LocationKey &key) const
+{
+    const std::size_t file = std::hash<const char *>()(key.m_file);
+    const std::size_t function = std::hash<const char *>()(key.m_function);
+    const std::size_t line = std::hash<std::uint32_t>()(key.m_line);
+
+    return file ^ (function << 1) ^ (line << 2);
+}
+
+} // namespace fly
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "fly/task/task_types.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace fly {
+
+/**
+ * A histogram of unsigned integer values with log-linear buckets. Each power-of-two range of values
+ * is divided into a fixed number of linearly spaced buckets, so the relative error of any bucket is
+ * bounded (12.5%) while the full range of 64-bit values fits in a few hundred buckets. Values below
+ * the number of sub-buckets per range are counted exactly.
+ */
+class LogLinearHistogram
+{
+public:
+    static constexpr std::size_t s_sub_bucket_bits = 3;
+    static constexpr std::size_t s_sub_bucket_count = std::size_t(1) << s_sub_bucket_bits;
+    static constexpr std::size_t s_bucket_count = (64 - s_sub_bucket_bits + 1) * s_sub_bucket_count;
+
+    /**
+     * Record a value in the histogram.
+     *
+     * @param value The value to record.
+     * @param count The number of times to record the value.
+     */
+    void record(std::uint64_t value, std::uint64_t count = 1);
+
+    /**
+     * Add the number of values recorded in a single bucket to the histogram.
+     *
+     * @param index The index of the bucket.
+     * @param count The number of values recorded in the bucket.
+     */
+    void record_bucket(std::size_t index, std::uint64_t count);
+
+    /**
+     * Merge all values recorded in another histogram into this histogram.
+     *
+     * @param histogram The histogram to merge.
+     */
+    void merge(const LogLinearHistogram &histogram);
+
+    /**
+     * @return The total number of values recorded in the histogram.
+     */
+    std::uint64_t count() const;
+
+    /**
+     * @return The number of values recorded in the bucket with the given index.
+     */
+    std::uint64_t bucket(std::size_t index) const;
+
+    /**
+     * Approximate the value at a percentile of the recorded values. The returned value is the upper
+     * bound of the bucket containing the percentile.
+     *
+     * @param percentile The percentile to compute, in the range [0, 100].
+     *
+     * @return The approximate value at the percentile, or zero if the histogram is empty.
+     */
+    std::uint64_t percentile(double percentile) const;
+
+    /**
+     * @return The index of the bucket which holds the given value.
+     */
+    static std::size_t bucket_index(std::uint64_t value);
+
+    /**
+     * @return The smallest value which is held by the bucket with the given index.
+     */
+    static std::uint64_t bucket_lower_bound(std::size_t index);
+
+    /**
+     * @return The largest value which is held by the bucket with the given index.
+     */
+    static std::uint64_t bucket_upper_bound(std::size_t index);
+
+private:
+    std::array<std::uint64_t, s_bucket_count> m_buckets {};
+    std::uint64_t m_count {0};
+};
+
+/**
+ * Snapshot of the instrumentation recorded for all tasks posted from a single location. Durations
+ * are recorded in nanoseconds.
+ *
+ * The queueing delay of a task is the time between the task being ready to execute (i.e. when it
+ * was handed to the task manager, or when its scheduled delay expired) and the task starting to
+ * execute. Tasks executed as part of a sequenced task runner's batch are ready to execute as soon
+ * as the task before them completes.
+ */
+struct TaskMetrics
+{
+    TaskLocation m_location;
+    LogLinearHistogram m_queue_delay;
+    LogLinearHistogram m_execution_time;
+};
+
+/**
+ * Class to collect instrumentation of task execution. Each thread which executes tasks attaches
+ * itself to the collector, and then records into histograms owned solely by that thread. Recording
+ * thus never takes a lock nor performs an atomic read-modify-write operation; a lock is only taken
+ * the first time a thread executes a task from a particular location, and when a snapshot is taken.
+ *
+ * Tasks are identified by the location from which they were posted. Locations created with the
+ * FROM_HERE macro refer to string literals, so locations are compared by pointer identity.
+ *
+ * The histograms of a thread which has detached are reused by the next thread to attach, so that
+ * threads which are repeatedly created and destroyed (e.g. by an elastic worker pool) do not grow
+ * the collector without bound.
+ */
+class TaskMetricsCollector
+{
+public:
+    /**
+     * Attach the calling thread to this collector. Tasks subsequently executed by the calling
+     * thread are recorded by this collector until the thread is detached. If another thread has
+     * detached from this collector, its histograms are reused by the calling thread.
+     */
+    void attach_thread();
+
+    /**
+     * Detach the calling thread from whichever collector it is attached to, if any. Values already
+     * recorded by the thread are retained by the collector.
+     */
+    static void detach_thread();
+
+    /**
+     * If the calling thread is attached to a collector, record the execution of a task.
+     *
+     * @param location The location from which the task was posted.
+     * @param ready_time The time at which the task was ready to execute.
+     * @param start_time The time at which the task started executing.
+     * @param end_time The time at which the task finished executing.
+     */
+    static void record(
+        const TaskLocation &location,
+        std::chrono::steady_clock::time_point ready_time,
+        std::chrono::steady_clock::time_point start_time,
+        std::chrono::steady_clock::time_point end_time);
+
+    /**
+     * @return True if the calling thread is attached to a collector.
+     */
+    static bool is_thread_attached();
+
+    /**
+     * Merge the values recorded by every thread into a snapshot of all task locations.
+     *
+     * @return The recorded instrumentation of each task location.
+     */
+    std::vector<TaskMetrics> snapshot() const;
+
+private:
+    /**
+     * Histograms updated by a single thread and read by snapshots. Buckets are relaxed atomics so
+     * that concurrent snapshots are well-defined; as there is only a single writer, increments are
+     * a plain load and store.
+     */
+    struct AtomicHistogram
+    {
+        void record(std::uint64_t value);
+
+        void snapshot_into(LogLinearHistogram &histogram) const;
+
+        std::array<std::atomic<std::uint64_t>, LogLinearHistogram::s_bucket_count> m_buckets {};
+    };
+
+    /**
+     * The instrumentation recorded by a single thread for a single task location.
+     */
+    struct LocationMetrics
+    {
+        TaskLocation m_location;
+        AtomicHistogram m_queue_delay;
+        AtomicHistogram m_execution_time;
+    };
+
+    /**
+     * Key to identify a task location by the identity of its file and function names.
+     */
+    struct LocationKey
+    {
+        const char *m_file;
+        const char *m_function;
+        std::uint32_t m_line;
+
+        bool operator==(const LocationKey &other) const = default;
+    };
+
+    struct LocationKeyHash
+    {
+        std::size_t operator()(const LocationKey &key) const;
+    };
+
+    /**
+     * The instrumentation recorded by a single thread. Only the owning thread modifies the map of
+     * locations, under the lock, so it may look up locations without the lock.
+     */
+    struct ThreadMetrics
+    {
+        std::atomic_bool m_attached {true};
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<LocationKey, std::unique_ptr<LocationMetrics>, LocationKeyHash>
+            m_locations;
+        LocationMetrics *m_last_location {nullptr};
+    };
+
+    /**
+     * Find or create the instrumentation recorded by the calling thread for a task location.
+     *
+     * @param thread_metrics The instrumentation recorded by the calling thread.
+     * @param location The location from which the task was posted.
+     *
+     * @return The instrumentation recorded for the task location.
+     */
+    static LocationMetrics &
+    location_metrics(ThreadMetrics &thread_metrics, const TaskLocation &location);
+
+    static thread_local ThreadMetrics *s_thread_metrics;
+
+    mutable std::mutex m_threads_mutex;
+    std::vector<std::unique_ptr<ThreadMetrics>> m_threads;
+};
+
+} // namespace fly
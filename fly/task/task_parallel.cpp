@@ -0,0 +1,126 @@
+#include "fly/task/task_parallel.hpp"
+
+#include <algorithm>
+
+namespace fly::detail {
+
+//==================================================================================================
+ParallelLoop::ParallelLoop(
+    std::size_t size,
+    std::size_t grain_size,
+    std::size_t participants) noexcept :
+    m_size(size),
+    m_grain_size(std::max(grain_size, std::size_t(1))),
+    m_participants(std::max(participants, std::size_t(1)))
+{
+}
+
+//==================================================================================================
+bool ParallelLoop::next_chunk(std::size_t &begin, std::size_t &end)
+{
+    std::size_t next = m_next.load(std::memory_order_relaxed);
+    std::size_t chunk_size = 0;
+
+    do
+    {
+        if (next >= m_size)
+        {
+            return false;
+        }
+
+        // Split the remaining range between the participants, with room for each participant to
+        // claim a second chunk, so that the final chunks are small enough to balance the load.
+        const std::size_t remaining = m_size - next;
+        chunk_size = std::max(remaining / (m_participants * 2), m_grain_size);
+        chunk_size = std::min(chunk_size, remaining);
+    } while (!m_next.compare_exchange_weak(
+        next,
+        next + chunk_size,
+        std::memory_order_relaxed,
+        std::memory_order_relaxed));
+
+    begin = next;
+    end = next + chunk_size;
+
+    return true;
+}
+
+//==================================================================================================
+bool ParallelLoop::enter()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_closed)
+    {
+        return false;
+    }
+
+    ++m_active_participants;
+    return true;
+}
+
+//==================================================================================================
+void ParallelLoop::leave()
+{
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        notify = (--m_active_participants == 0) && m_closed;
+    }
+
+    if (notify)
+    {
+        m_condition.notify_one();
+    }
+}
+
+//==================================================================================================
+void ParallelLoop::cancel()
+{
+    m_next.store(m_size, std::memory_order_relaxed);
+}
+
+//==================================================================================================
+void ParallelLoop::fail(std::exception_ptr exception)
+{
+    cancel();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_exception)
+    {
+        m_exception = std::move(exception);
+    }
+}
+
+//==================================================================================================
+void ParallelLoop::close_and_wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_closed = true;
+
+    m_condition.wait(
+        lock,
+        [this]()
+        {
+            return m_active_participants == 0;
+        });
+
+    if (m_exception)
+    {
+        std::rethrow_exception(m_exception);
+    }
+}
+
+//==================================================================================================
+ParallelLoopParticipant::ParallelLoopParticipant(ParallelLoop &loop) noexcept : m_loop(loop)
+{
+}
+
+//==================================================================================================
+ParallelLoopParticipant::~ParallelLoopParticipant()
+{
+    m_loop.leave();
+}
+
+} // namespace fly::detail
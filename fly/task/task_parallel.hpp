@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+
+namespace fly::detail {
+
+/**
+ * The state shared between the participants of a data-parallel loop over the index range
+ * [0, size). Participants (the calling thread and any worker threads which join the loop) claim
+ * chunks of the range until the range is exhausted.
+ *
+ * Chunks are sized adaptively: each chunk is a fraction of the remaining range, split between the
+ * participants, but no smaller than the loop's grain size. Early chunks are large to minimize
+ * contention on the shared range, while later chunks become smaller so that participants finish at
+ * roughly the same time, even if some participants join late or execute slower than others.
+ *
+ * Worker threads may only join the loop while it is open. The calling thread closes the loop once
+ * it finds no remaining chunks, and then waits for the participants which did join to finish their
+ * chunks. Worker threads which attempt to join after the loop is closed do nothing, so the calling
+ * thread never waits on worker threads which have not yet started.
+ *
+ * If any participant throws an exception, the loop is canceled, and the first exception thrown is
+ * rethrown to the calling thread once all participants have left the loop.
+ */
+class ParallelLoop
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param size The size of the index range.
+     * @param grain_size The minimum size of a chunk.
+     * @param participants The maximum number of participants in the loop.
+     */
+    ParallelLoop(std::size_t size, std::size_t grain_size, std::size_t participants) noexcept;
+
+    /**
+     * Claim the next chunk of the index range.
+     *
+     * @param begin Location to store the first index of the chunk.
+     * @param end Location to store the index following the last index of the chunk.
+     *
+     * @return True if a chunk was claimed, or false if the range has been exhausted.
+     */
+    bool next_chunk(std::size_t &begin, std::size_t &end);
+
+    /**
+     * Join the loop as a worker thread participant. Must be paired with a call to leave() if
+     * successful.
+     *
+     * @return True if the loop was still open.
+     */
+    bool enter();
+
+    /**
+     * Leave the loop as a worker thread participant, waking the calling thread if it is waiting on
+     * this participant.
+     */
+    void leave();
+
+    /**
+     * Exhaust the index range, so that participants stop claiming new chunks.
+     */
+    void cancel();
+
+    /**
+     * Cancel the loop due to an exception thrown by a participant. Only the first exception is
+     * stored to be rethrown.
+     *
+     * @param exception The exception thrown by the participant.
+     */
+    void fail(std::exception_ptr exception);
+
+    /**
+     * Close the loop to new participants, and block until all participants which joined the loop
+     * have left. Afterwards, rethrow the first exception thrown by any participant, if any.
+     */
+    void close_and_wait();
+
+private:
+    const std::size_t m_size;
+    const std::size_t m_grain_size;
+    const std::size_t m_participants;
+
+    std::atomic<std::size_t> m_next {0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::size_t m_active_participants {0};
+    bool m_closed {false};
+
+    std::exception_ptr m_exception;
+};
+
+/**
+ * RAII helper to leave a data-parallel loop when a worker thread participant is done with it,
+ * regardless of how the participant exits.
+ */
+class ParallelLoopParticipant
+{
+public:
+    /**
+     * Constructor. The worker thread must have already joined the loop.
+     *
+     * @param loop The loop which the worker thread joined.
+     */
+    explicit ParallelLoopParticipant(ParallelLoop &loop) noexcept;
+
+    /**
+     * Destructor. Leave the loop.
+     */
+    ~ParallelLoopParticipant();
+
+    ParallelLoopParticipant(const ParallelLoopParticipant &) = delete;
+    ParallelLoopParticipant &operator=(const ParallelLoopParticipant &) = delete;
+
+private:
+    ParallelLoop &m_loop;
+};
+
+} // namespace fly::detail
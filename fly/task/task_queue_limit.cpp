@@ -0,0 +1,128 @@
+#include "fly/task/task_queue_limit.hpp"
+
+namespace fly::detail {
+
+//==================================================================================================
+void TaskQueueDepth::set_limit(TaskQueueLimit limit)
+{
+    m_limit = limit;
+}
+
+//==================================================================================================
+const TaskQueueLimit &TaskQueueDepth::limit() const
+{
+    return m_limit;
+}
+
+//==================================================================================================
+bool TaskQueueDepth::is_bounded() const
+{
+    return m_limit.m_capacity > 0;
+}
+
+//==================================================================================================
+bool TaskQueueDepth::has_capacity(std::size_t count) const
+{
+    return overflow(count) == 0;
+}
+
+//==================================================================================================
+std::size_t TaskQueueDepth::overflow(std::size_t count) const
+{
+    const std::size_t depth = m_depth.load();
+
+    if (is_bounded() && (depth > 0) && ((depth + count) > m_limit.m_capacity))
+    {
+        return depth + count - m_limit.m_capacity;
+    }
+
+    return 0;
+}
+
+//==================================================================================================
+bool TaskQueueDepth::try_reserve(std::size_t count)
+{
+    if (!is_bounded())
+    {
+        reserve(count);
+        return true;
+    }
+
+    std::size_t depth = m_depth.load();
+
+    do
+    {
+        if ((depth > 0) && ((depth + count) > m_limit.m_capacity))
+        {
+            return false;
+        }
+    } while (!m_depth.compare_exchange_weak(depth, depth + count));
+
+    update_peak_depth(depth + count);
+    return true;
+}
+
+//==================================================================================================
+std::size_t TaskQueueDepth::reserve(std::size_t count)
+{
+    const std::size_t depth = m_depth.fetch_add(count) + count;
+    update_peak_depth(depth);
+
+    if (is_bounded() && (depth > m_limit.m_capacity))
+    {
+        return depth - m_limit.m_capacity;
+    }
+
+    return 0;
+}
+
+//==================================================================================================
+void TaskQueueDepth::release(std::size_t count)
+{
+    m_depth.fetch_sub(count);
+
+    if (m_waiters.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+
+        m_condition.notify_all();
+    }
+}
+
+//==================================================================================================
+void TaskQueueDepth::record_rejected(std::size_t count)
+{
+    m_rejected.fetch_add(count, std::memory_order_relaxed);
+}
+
+//==================================================================================================
+void TaskQueueDepth::record_dropped(std::size_t count)
+{
+    m_dropped.fetch_add(count, std::memory_order_relaxed);
+}
+
+//==================================================================================================
+TaskQueueMetrics TaskQueueDepth::metrics() const
+{
+    return {
+        m_depth.load(),
+        m_peak_depth.load(),
+        m_limit.m_capacity,
+        m_rejected.load(std::memory_order_relaxed),
+        m_dropped.load(std::memory_order_relaxed)};
+}
+
+//==================================================================================================
+void TaskQueueDepth::update_peak_depth(std::size_t depth)
+{
+    std::size_t peak_depth = m_peak_depth.load(std::memory_order_relaxed);
+
+    while ((depth > peak_depth) &&
+           !m_peak_depth.compare_exchange_weak(peak_depth, depth, std::memory_order_relaxed))
+    {
+    }
+}
+
+} // namespace fly::detail
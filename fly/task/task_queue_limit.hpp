@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace fly {
+
+/**
+ * Policy applied when tasks are posted to a task queue which is at capacity.
+ */
+enum class TaskQueuePolicy : std::uint8_t
+{
+    // Block the posting thread until the queue has space for the tasks. Worker threads execute
+    // other pending tasks while blocked.
+    Block,
+
+    // Reject the tasks, such that the posting method returns false.
+    Reject,
+
+    // Drop the oldest queued tasks to make space for the tasks.
+    DropOldest,
+};
+
+/**
+ * Limit on the number of tasks which may be queued, and the policy applied once that limit is
+ * reached. A capacity of zero denotes an unbounded queue.
+ */
+struct TaskQueueLimit
+{
+    std::size_t m_capacity {0};
+    TaskQueuePolicy m_policy {TaskQueuePolicy::Reject};
+};
+
+/**
+ * Snapshot of the depth of a task queue, and of the tasks its limit has turned away.
+ */
+struct TaskQueueMetrics
+{
+    std::size_t m_depth {0};
+    std::size_t m_peak_depth {0};
+    std::size_t m_capacity {0};
+    std::size_t m_rejected {0};
+    std::size_t m_dropped {0};
+};
+
+namespace detail {
+
+    /**
+     * Class to track the number of tasks queued in a task queue against the queue's limit. The
+     * queue's owner reserves space before queueing tasks, and releases that space once the tasks
+     * are dequeued, so the depth is tracked without inspecting the queue itself.
+     */
+    class TaskQueueDepth
+    {
+    public:
+        /**
+         * Set the limit of the queue. Must not be called while tasks are being queued.
+         *
+         * @param limit The limit of the queue.
+         */
+        void set_limit(TaskQueueLimit limit);
+
+        /**
+         * @return The limit of the queue.
+         */
+        const TaskQueueLimit &limit() const;
+
+        /**
+         * @return True if the queue has a capacity.
+         */
+        bool is_bounded() const;
+
+        /**
+         * Check whether the queue has space for a number of tasks. An empty queue always has space,
+         * even if the number of tasks exceeds the capacity.
+         *
+         * @param count The number of tasks.
+         *
+         * @return True if the queue has space for the tasks.
+         */
+        bool has_capacity(std::size_t count) const;
+
+        /**
+         * Determine the number of queued tasks which would need to be removed for the queue to have
+         * space for a number of tasks.
+         *
+         * @param count The number of tasks.
+         *
+         * @return The number of tasks by which the queue would exceed its capacity.
+         */
+        std::size_t overflow(std::size_t count) const;
+
+        /**
+         * Reserve space for a number of tasks, if the queue has space for them (see has_capacity).
+         *
+         * @param count The number of tasks.
+         *
+         * @return True if space was reserved.
+         */
+        bool try_reserve(std::size_t count);
+
+        /**
+         * Reserve space for a number of tasks, regardless of the capacity of the queue.
+         *
+         * @param count The number of tasks.
+         *
+         * @return The number of tasks by which the queue now exceeds its capacity.
+         */
+        std::size_t reserve(std::size_t count);
+
+        /**
+         * Block until a condition is satisfied, e.g. until space has been reserved for a number of
+         * tasks. While blocked, the given helper is invoked to allow the calling thread to make
+         * progress on the queue (e.g. by executing pending tasks). If the helper does not make
+         * progress, the calling thread waits for space to be released for a short interval before
+         * checking the condition again.
+         *
+         * @tparam Condition Callable type of the condition, returning true once satisfied.
+         * @tparam Helper Callable type of the helper, returning true if it made progress.
+         *
+         * @param condition The condition to wait on.
+         * @param helper The helper to invoke while blocked.
+         */
+        template <typename Condition, typename Helper>
+        void wait_until(Condition &&condition, Helper &&helper);
+
+        /**
+         * Release the space held by a number of tasks which have been dequeued or dropped, waking
+         * any threads blocked on the queue.
+         *
+         * @param count The number of tasks.
+         */
+        void release(std::size_t count);
+
+        /**
+         * Record that a number of tasks were rejected by the queue's limit.
+         *
+         * @param count The number of tasks.
+         */
+        void record_rejected(std::size_t count);
+
+        /**
+         * Record that a number of queued tasks were dropped by the queue's limit.
+         *
+         * @param count The number of tasks.
+         */
+        void record_dropped(std::size_t count);
+
+        /**
+         * @return A snapshot of the depth of the queue.
+         */
+        TaskQueueMetrics metrics() const;
+
+    private:
+        /**
+         * Update the peak depth of the queue.
+         *
+         * @param depth The current depth of the queue.
+         */
+        void update_peak_depth(std::size_t depth);
+
+        // The interval at which a blocked thread retries reserving space.
+        static constexpr std::chrono::milliseconds s_wait_interval {1};
+
+        TaskQueueLimit m_limit;
+
+        std::atomic<std::size_t> m_depth {0};
+        std::atomic<std::size_t> m_peak_depth {0};
+        std::atomic<std::size_t> m_rejected {0};
+        std::atomic<std::size_t> m_dropped {0};
+
+        std::atomic<std::uint32_t> m_waiters {0};
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+    };
+
+    //==============================================================================================
+    template <typename Condition, typename Helper>
+    void TaskQueueDepth::wait_until(Condition &&condition, Helper &&helper)
+    {
+        // The waiter count must be incremented before checking the condition. Space released after
+        // the check will then observe this thread as waiting and issue a notification.
+        m_waiters.fetch_add(1);
+
+        while (!condition())
+        {
+            if (!helper())
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait_for(lock, s_wait_interval);
+            }
+        }
+
+        m_waiters.fetch_sub(1);
+    }
+
+} // namespace detail
+
+} // namespace fly
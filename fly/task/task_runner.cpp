@@ -1,9 +1,17 @@
 #include "fly/task/task_runner.hpp"
 
+#include "fly/task/task_config.hpp"
 #include "fly/task/task_manager.hpp"
+#include "fly/task/task_metrics.hpp"
+#include "fly/task/task_tracer.hpp"
+
+#include <algorithm>
+#include <utility>
 
 namespace fly {
 
+thread_local TaskRunner *TaskRunner::s_current_task_runner = nullptr;
+
 //==================================================================================================
 TaskRunner::TaskRunner(std::weak_ptr<TaskManager> weak_task_manager) noexcept :
     m_weak_task_manager(std::move(weak_task_manager))
@@ -11,7 +19,53 @@ TaskRunner::TaskRunner(std::weak_ptr<TaskManager> weak_task_manager) noexcept :
 }
 
 //==================================================================================================
-bool TaskRunner::post_task_to_task_manager(TaskLocation &&location, Task &&task)
+ScheduleAwaitable TaskRunner::schedule(TaskLocation &&location)
+{
+    return ScheduleAwaitable(
+        shared_from_this(),
+        std::move(location),
+        std::chrono::nanoseconds::zero());
+}
+
+//==================================================================================================
+ScheduleAwaitable TaskRunner::delay(TaskLocation &&location, std::chrono::nanoseconds delay)
+{
+    return ScheduleAwaitable(shared_from_this(), std::move(location), delay);
+}
+
+//==================================================================================================
+TaskQueueMetrics TaskRunner::queue_metrics() const
+{
+    return m_queue_depth.metrics();
+}
+
+//==================================================================================================
+bool TaskRunner::admit_and_post_task(TaskLocation &&location, Task &&task, TaskPriority priority)
+{
+    if (!admit_tasks(priority, 1))
+    {
+        return false;
+    }
+
+    return post_task_internal(std::move(location), std::move(task), priority);
+}
+
+//==================================================================================================
+bool TaskRunner::admit_and_post_tasks(
+    TaskLocation &&location,
+    std::vector<Task> &&tasks,
+    TaskPriority priority)
+{
+    if (!admit_tasks(priority, tasks.size()))
+    {
+        return false;
+    }
+
+    return post_tasks_internal(std::move(location), std::move(tasks), priority);
+}
+
+//==================================================================================================
+bool TaskRunner::admit_tasks(TaskPriority priority, std::size_t count)
 {
     std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock();
     if (!task_manager)
@@ -19,17 +73,88 @@ bool TaskRunner::post_task_to_task_manager(TaskLocation &&location, Task &&task)
         return false;
     }
 
-    std::weak_ptr<TaskRunner> task_runner = shared_from_this();
-    task_manager->post_task(std::move(location), std::move(task), std::move(task_runner));
+    if (!reserve_tasks(*task_manager, count))
+    {
+        m_queue_depth.record_rejected(count);
+        return false;
+    }
+
+    if (!task_manager->admit_tasks(priority, count))
+    {
+        m_queue_depth.release(count);
+        return false;
+    }
 
     return true;
 }
 
 //==================================================================================================
-bool TaskRunner::post_task_to_task_manager_with_delay(
+bool TaskRunner::reserve_tasks(TaskManager &task_manager, std::size_t count)
+{
+    if (m_queue_depth.try_reserve(count))
+    {
+        return true;
+    }
+
+    const TaskQueuePolicy policy = m_queue_depth.limit().m_policy;
+
+    if (policy == TaskQueuePolicy::Block)
+    {
+        // The queue cannot drain while this task runner is executing the posting task, nor while
+        // the task manager is stopped, so the tasks are admitted over capacity in those cases.
+        if ((s_current_task_runner != this) && task_manager.m_keep_running.load())
+        {
+            bool reserved = false;
+
+            m_queue_depth.wait_until(
+                [this, &task_manager, &reserved, count]()
+                {
+                    reserved = m_queue_depth.try_reserve(count);
+                    return reserved || !task_manager.m_keep_running.load();
+                },
+                [&task_manager]()
+                {
+                    return task_manager.is_worker_thread() && task_manager.execute_pending_task();
+                });
+
+            if (reserved)
+            {
+                return true;
+            }
+        }
+
+        m_queue_depth.reserve(count);
+        return true;
+    }
+    else if (policy == TaskQueuePolicy::DropOldest)
+    {
+        if (const std::size_t overflow = m_queue_depth.reserve(count); overflow == 0)
+        {
+            return true;
+        }
+        else if (drop_oldest_tasks(overflow) > 0)
+        {
+            return true;
+        }
+
+        m_queue_depth.release(count);
+    }
+
+    return false;
+}
+
+//==================================================================================================
+bool TaskRunner::post_admitted_task(TaskLocation &&location, Task &&task, TaskPriority priority)
+{
+    m_queue_depth.reserve(1);
+    return post_task_internal(std::move(location), std::move(task), priority);
+}
+
+//==================================================================================================
+bool TaskRunner::post_task_to_task_manager(
     TaskLocation &&location,
     Task &&task,
-    std::chrono::milliseconds delay)
+    TaskPriority priority)
 {
     std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock();
     if (!task_manager)
@@ -38,19 +163,107 @@ bool TaskRunner::post_task_to_task_manager_with_delay(
     }
 
     std::weak_ptr<TaskRunner> task_runner = shared_from_this();
-    task_manager
-        ->post_task_with_delay(std::move(location), std::move(task), std::move(task_runner), delay);
+    task_manager->post_task(
+        std::move(location),
+        std::move(task),
+        priority,
+        std::move(task_runner));
 
     return true;
 }
 
 //==================================================================================================
-void TaskRunner::execute(TaskLocation &&location, Task &&task)
+bool TaskRunner::post_tasks_to_task_manager(
+    TaskLocation &&location,
+    std::vector<Task> &&tasks,
+    TaskPriority priority)
+{
+    std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock();
+    if (!task_manager)
+    {
+        return false;
+    }
+
+    std::weak_ptr<TaskRunner> task_runner = shared_from_this();
+    task_manager->post_tasks(
+        std::move(location),
+        std::move(tasks),
+        priority,
+        std::move(task_runner));
+
+    return true;
+}
+
+//==================================================================================================
+TaskHandle TaskRunner::post_task_to_task_manager_with_delay(
+    TaskLocation &&location,
+    Task &&task,
+    TaskPriority priority,
+    std::chrono::nanoseconds delay)
+{
+    std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock();
+    if (!task_manager)
+    {
+        return {};
+    }
+
+    std::weak_ptr<TaskRunner> task_runner = shared_from_this();
+
+    return task_manager->post_task_with_delay(
+        std::move(location),
+        std::move(task),
+        priority,
+        std::move(task_runner),
+        delay);
+}
+
+//==================================================================================================
+std::shared_ptr<TaskConfig> TaskRunner::task_config() const
 {
-    std::move(task)(this, location);
+    if (std::shared_ptr<TaskManager> task_manager = m_weak_task_manager.lock(); task_manager)
+    {
+        return task_manager->m_config;
+    }
+
+    return nullptr;
+}
+
+//==================================================================================================
+void TaskRunner::execute(
+    TaskLocation &&location,
+    Task &&task,
+    std::chrono::steady_clock::time_point ready_time)
+{
+    run_task(location, std::move(task), ready_time);
     task_complete(std::move(location));
 }
 
+//==================================================================================================
+void TaskRunner::run_task(
+    const TaskLocation &location,
+    Task &&task,
+    std::chrono::steady_clock::time_point ready_time)
+{
+    // Coroutines suspended by this task are resumed on this task runner.
+    TaskRunner *previous_task_runner = std::exchange(s_current_task_runner, this);
+
+    if (TaskMetricsCollector::is_thread_attached() || TaskTracer::is_thread_attached())
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+        std::move(task)(this, location);
+        const auto end_time = std::chrono::steady_clock::now();
+
+        TaskMetricsCollector::record(location, ready_time, start_time, end_time);
+        TaskTracer::record(location, ready_time, start_time, end_time);
+    }
+    else
+    {
+        std::move(task)(this, location);
+    }
+
+    s_current_task_runner = previous_task_runner;
+}
+
 //==================================================================================================
 ParallelTaskRunner::ParallelTaskRunner(std::weak_ptr<TaskManager> weak_task_manager) noexcept :
     TaskRunner(std::move(weak_task_manager))
@@ -58,9 +271,35 @@ ParallelTaskRunner::ParallelTaskRunner(std::weak_ptr<TaskManager> weak_task_mana
 }
 
 //==================================================================================================
-bool ParallelTaskRunner::post_task_internal(TaskLocation &&location, Task &&task)
+bool ParallelTaskRunner::post_task_internal(
+    TaskLocation &&location,
+    Task &&task,
+    TaskPriority priority)
 {
-    return post_task_to_task_manager(std::move(location), std::move(task));
+    if (post_task_to_task_manager(std::move(location), std::move(task), priority))
+    {
+        return true;
+    }
+
+    m_queue_depth.release(1);
+    return false;
+}
+
+//==================================================================================================
+bool ParallelTaskRunner::post_tasks_internal(
+    TaskLocation &&location,
+    std::vector<Task> &&tasks,
+    TaskPriority priority)
+{
+    const std::size_t count = tasks.size();
+
+    if (post_tasks_to_task_manager(std::move(location), std::move(tasks), priority))
+    {
+        return true;
+    }
+
+    m_queue_depth.release(count);
+    return false;
 }
 
 //==================================================================================================
@@ -68,26 +307,191 @@ void ParallelTaskRunner::task_complete(TaskLocation &&)
 {
 }
 
+//==================================================================================================
+void ParallelTaskRunner::task_dropped(TaskLocation &&)
+{
+    m_queue_depth.release(1);
+}
+
+//==================================================================================================
+std::size_t ParallelTaskRunner::drop_oldest_tasks(std::size_t)
+{
+    return 0;
+}
+
+//==================================================================================================
+void ParallelTaskRunner::execute(
+    TaskLocation &&location,
+    Task &&task,
+    std::chrono::steady_clock::time_point ready_time)
+{
+    m_queue_depth.release(1);
+    TaskRunner::execute(std::move(location), std::move(task), ready_time);
+}
+
 //==================================================================================================
 SequencedTaskRunner::SequencedTaskRunner(std::weak_ptr<TaskManager> weak_task_manager) noexcept :
     TaskRunner(std::move(weak_task_manager))
 {
+    if (std::shared_ptr<TaskConfig> config = task_config(); config)
+    {
+        m_batch_size = std::max(config->sequenced_batch_size(), std::uint32_t(1));
+        m_batch_duration = config->sequenced_batch_duration();
+    }
 }
 
 //==================================================================================================
-bool SequencedTaskRunner::post_task_internal(TaskLocation &&location, Task &&task)
+bool SequencedTaskRunner::post_task_internal(
+    TaskLocation &&location,
+    Task &&task,
+    TaskPriority priority)
 {
-    return maybe_post_task(std::move(location), std::move(task));
+    return maybe_post_task(std::move(location), std::move(task), priority);
+}
+
+//==================================================================================================
+bool SequencedTaskRunner::post_tasks_internal(
+    TaskLocation &&location,
+    std::vector<Task> &&tasks,
+    TaskPriority priority)
+{
+    std::lock_guard<std::mutex> lock(m_pending_tasks_mutex);
+
+    for (Task &task : tasks)
+    {
+        m_pending_tasks.push({location, std::move(task), priority});
+    }
+
+    if (m_has_running_task || m_pending_tasks.empty())
+    {
+        return true;
+    }
+
+    PendingTask pending_task = std::move(m_pending_tasks.front());
+    m_pending_tasks.pop();
+    m_queue_depth.release(1);
+
+    m_has_running_task = post_task_to_task_manager(
+        std::move(pending_task.m_location),
+        std::move(pending_task.m_task),
+        pending_task.m_priority);
+
+    return m_has_running_task;
 }
 
 //==================================================================================================
 void SequencedTaskRunner::task_complete(TaskLocation &&)
 {
-    maybe_post_task({}, {});
 }
 
 //==================================================================================================
-bool SequencedTaskRunner::maybe_post_task(TaskLocation &&location, Task &&task)
+void SequencedTaskRunner::task_dropped(TaskLocation &&)
+{
+    maybe_post_task({}, {}, TaskPriority::Normal);
+}
+
+//==================================================================================================
+std::size_t SequencedTaskRunner::drop_oldest_tasks(std::size_t count)
+{
+    std::vector<PendingTask> dropped_tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_tasks_mutex);
+
+        while ((dropped_tasks.size() < count) && !m_pending_tasks.empty())
+        {
+            dropped_tasks.push_back(std::move(m_pending_tasks.front()));
+            m_pending_tasks.pop();
+        }
+    }
+
+    m_queue_depth.release(dropped_tasks.size());
+    m_queue_depth.record_dropped(dropped_tasks.size());
+
+    // The dropped tasks are destroyed here, outside of the lock, as destroying a task may invoke
+    // arbitrary code (e.g. marking a future as dropped).
+    return dropped_tasks.size();
+}
+
+//==================================================================================================
+void SequencedTaskRunner::execute(
+    TaskLocation &&location,
+    Task &&task,
+    std::chrono::steady_clock::time_point ready_time)
+{
+    // The batch state is held on this thread's stack rather than in the task runner. Once the
+    // sequence is released, another worker thread may immediately begin executing its next task,
+    // so no batch state may be shared between the two.
+    std::chrono::steady_clock::time_point batch_deadline;
+    std::uint32_t batch_count = 0;
+
+    if (m_batch_duration > std::chrono::microseconds::zero())
+    {
+        batch_deadline = std::chrono::steady_clock::now() + m_batch_duration;
+    }
+
+    PendingTask current_task {std::move(location), std::move(task)};
+
+    while (true)
+    {
+        run_task(current_task.m_location, std::move(current_task.m_task), ready_time);
+
+        std::optional<PendingTask> batched_task = continue_batch(++batch_count, batch_deadline);
+
+        if (!batched_task)
+        {
+            // This releases the sequence, after which no member of this task runner may be used.
+            maybe_post_task({}, {}, TaskPriority::Normal);
+            task_complete(std::move(current_task.m_location));
+            break;
+        }
+
+        task_complete(std::move(current_task.m_location));
+        current_task = *std::move(batched_task);
+
+        if (TaskMetricsCollector::is_thread_attached() || TaskTracer::is_thread_attached())
+        {
+            ready_time = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+//==================================================================================================
+std::optional<SequencedTaskRunner::PendingTask> SequencedTaskRunner::continue_batch(
+    std::uint32_t batch_count,
+    std::chrono::steady_clock::time_point batch_deadline)
+{
+    if (batch_count >= m_batch_size)
+    {
+        return std::nullopt;
+    }
+    else if (
+        (m_batch_duration > std::chrono::microseconds::zero()) &&
+        (std::chrono::steady_clock::now() >= batch_deadline))
+    {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(m_pending_tasks_mutex);
+
+    // Blocking tasks are always dispatched to the task manager's blocking threads, rather than
+    // executed within a batch on a worker thread.
+    if (m_pending_tasks.empty() || (m_pending_tasks.front().m_priority == TaskPriority::Blocking))
+    {
+        return std::nullopt;
+    }
+
+    PendingTask batched_task = std::move(m_pending_tasks.front());
+    m_pending_tasks.pop();
+    m_queue_depth.release(1);
+
+    return batched_task;
+}
+
+//==================================================================================================
+bool SequencedTaskRunner::maybe_post_task(
+    TaskLocation &&location,
+    Task &&task,
+    TaskPriority priority)
 {
     bool posted_or_queued = false;
 
@@ -99,14 +503,19 @@ bool SequencedTaskRunner::maybe_post_task(TaskLocation &&location, Task &&task)
         {
             PendingTask pending_task = std::move(m_pending_tasks.front());
             m_pending_tasks.pop();
+            m_queue_depth.release(1);
 
             posted_or_queued = post_task_to_task_manager(
                 std::move(pending_task.m_location),
-                std::move(pending_task.m_task));
+                std::move(pending_task.m_task),
+                pending_task.m_priority);
         }
         else if (task != nullptr)
         {
-            posted_or_queued = post_task_to_task_manager(std::move(location), std::move(task));
+            m_queue_depth.release(1);
+
+            posted_or_queued =
+                post_task_to_task_manager(std::move(location), std::move(task), priority);
             task = nullptr;
         }
 
@@ -115,7 +524,7 @@ bool SequencedTaskRunner::maybe_post_task(TaskLocation &&location, Task &&task)
 
     if (task != nullptr)
     {
-        m_pending_tasks.push({std::move(location), std::move(task)});
+        m_pending_tasks.push({std::move(location), std::move(task), priority});
         posted_or_queued = true;
     }
 
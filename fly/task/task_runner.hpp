@@ -1,15 +1,22 @@
 #pragma once
 
 #include "fly/fly.hpp"
+#include "fly/task/task_coroutine.hpp"
+#include "fly/task/task_future.hpp"
+#include "fly/task/task_handle.hpp"
+#include "fly/task/task_queue_limit.hpp"
 #include "fly/task/task_types.hpp"
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <functional>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <type_traits>
+#include <vector>
 
 /**
  * Helper macro to create a TaskLocation from the current location.
@@ -18,15 +25,17 @@
 
 namespace fly {
 
+class TaskConfig;
+class TaskGraph;
 class TaskManager;
 
 /**
  * Base class for controlling the execution of tasks. Concrete task runners control the ordering and
  * execution of tasks.
  *
- * Tasks may generally be any callable type (lambda, std::function, etc.). Specific posting methods
- * may place restrictions on the callable type, on either the return type of the invocation or the
- * arguments the task accepts.
+ * Tasks may generally be any callable type (lambda, std::function, etc.), including move-only
+ * types. Specific posting methods may place restrictions on the callable type, on either the return
+ * type of the invocation or the arguments the task accepts.
  *
  * Tasks whose result is a non-void type may pass their result to a reply task. For example:
  *
@@ -66,6 +75,31 @@ class TaskManager;
  * Reply tasks are not executed immediately after a task is complete. Rather, they are posted for
  * execution on the same task runner on which that task was posted.
  *
+ * Alternatively, the result of a task may be retrieved through a future. Waiting on the future from
+ * a worker thread executes other pending tasks until the task is complete (see TaskFuture). For
+ * example:
+ *
+ *       auto task = []() -> int
+ *       {
+ *           // Task body here.
+ *           return 12389;
+ *       };
+ *
+ *       auto future = task_runner->post_task_with_future(FROM_HERE, std::move(task));
+ *       assert(future.get() == 12389);
+ *
+ * Coroutines may also await task runners, either to resume on a task runner (optionally after a
+ * delay), or to await the result of a task without blocking a worker thread (see TaskCoroutine).
+ * For example:
+ *
+ *       fly::TaskCoroutine coroutine(std::shared_ptr<fly::TaskRunner> task_runner)
+ *       {
+ *           co_await task_runner->schedule(FROM_HERE);
+ *
+ *           int result = co_await task_runner->post_task_with_awaitable(FROM_HERE, task);
+ *           assert(result == 12389);
+ *       }
+ *
  * Once a task is posted, it may be attempted to be cancelled in a number of ways:
  *
  * 1. Use one of the posting methods which accepts a weak pointer to the owner of the task. When the
@@ -105,12 +139,54 @@ class TaskManager;
  * 2. Deleting the task runner onto which the task was posted. This will only cancel the task if the
  *    task manager has not yet instructed the task runner to execute the task.
  *
+ * 3. Delayed tasks may be cancelled through the handle returned when posting the task. This will
+ *    only cancel the task if its delay has not yet expired, and immediately removes the task from
+ *    the task manager's timer (see TaskHandle). For example:
+ *
+ *       fly::TaskHandle handle = task_runner->post_task_with_delay(FROM_HERE, std::move(task), 1s);
+ *       handle.cancel();
+ *
+ * Each task runner has a default priority, chosen when the task runner is created, with which its
+ * tasks are dispatched by the task manager. Individual tasks may be posted with a different
+ * priority with post_task_with_priority. Reply tasks and delayed tasks are dispatched with the
+ * default priority of the task runner.
+ *
+ * Many tasks may be posted at once with post_tasks. The tasks are handed to the task manager as a
+ * single batch, which is enqueued with a single operation on the task manager's queue and wakes the
+ * idle worker threads once, rather than once per task. For example:
+ *
+ *       std::vector<std::function<void()>> tasks;
+ *
+ *       for (auto &value : values)
+ *       {
+ *           tasks.emplace_back([&value]() { process(value); });
+ *       }
+ *
+ *       task_runner->post_tasks(FROM_HERE, std::move(tasks));
+ *
+ * Tasks which block for an extended period of time (e.g. waiting in a system call) should be posted
+ * with post_blocking_task, so that they are executed on the task manager's blocking threads rather
+ * than occupying a worker thread.
+ *
+ * Task runners may be created with a limit on the number of tasks they may queue (see
+ * TaskManager::create_task_runner), in addition to any limit on the task manager's shared queues.
+ * When tasks are posted while a queue is at capacity, the queue's overflow policy is applied: the
+ * posting thread blocks until space is available, the tasks are rejected (the posting method
+ * returns false, and futures are marked as dropped), or the oldest queued tasks are dropped in
+ * favor of the new tasks. Tasks posted from within one of a task runner's own tasks are never
+ * blocked by that task runner's limit, as the task runner may be unable to make progress until the
+ * posting task completes. Delayed tasks are held by the task manager's timer rather than queued,
+ * and are only counted toward the limits once their delay expires. The depth of a task runner's
+ * queue may be observed with queue_metrics().
+ *
  * @author Timothy Flynn (trflynn89@pm.me)
  * @version August 12, 2018
  */
 class TaskRunner : public std::enable_shared_from_this<TaskRunner>
 {
+    friend class TaskGraph;
     friend class TaskManager;
+    friend class detail::CoroutineScheduler;
 
 public:
     /**
@@ -149,6 +225,119 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
     template <typename TaskType, typename OwnerType>
     bool post_task(TaskLocation &&location, TaskType &&task, std::weak_ptr<OwnerType> weak_owner);
 
+    /**
+     * Post a range of tasks for execution as a single batch. The tasks may be any callable type,
+     * and are moved out of the range. The tasks are posted in the order of the range, and are all
+     * attributed to the same location.
+     *
+     * @tparam TaskRange Type of the range of tasks.
+     *
+     * @param location The location from which the tasks were posted (use FROM_HERE).
+     * @param tasks The tasks to be executed.
+     *
+     * @return True if the tasks were posted for execution.
+     */
+    template <typename TaskRange>
+    bool post_tasks(TaskLocation &&location, TaskRange &&tasks);
+
+    /**
+     * Post a range of tasks for execution as a single batch, each with protection by the provided
+     * weak pointer. The tasks may be any callable type which accepts a single argument, a locked
+     * shared pointer obtained from the weak pointer, and are moved out of the range. When each task
+     * is ready to be executed, if the weak pointer fails to be locked, the task is dropped.
+     *
+     * @tparam TaskRange Type of the range of tasks.
+     * @tparam OwnerType Type of the owner of the tasks.
+     *
+     * @param location The location from which the tasks were posted (use FROM_HERE).
+     * @param tasks The tasks to be executed.
+     * @param weak_owner A weak pointer to the owner of the tasks.
+     *
+     * @return True if the tasks were posted for execution.
+     */
+    template <typename TaskRange, typename OwnerType>
+    bool
+    post_tasks(TaskLocation &&location, TaskRange &&tasks, std::weak_ptr<OwnerType> weak_owner);
+
+    /**
+     * Post a task for execution with a specific priority, rather than the default priority of this
+     * task runner. The task may be any callable type.
+     *
+     * @tparam TaskType Callable type of the task.
+     *
+     * @param location The location from which the task was posted (use FROM_HERE).
+     * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
+     *
+     * @return True if the task was posted for execution.
+     */
+    template <typename TaskType>
+    bool
+    post_task_with_priority(TaskLocation &&location, TaskType &&task, TaskPriority priority);
+
+    /**
+     * Post a task for execution with a specific priority, rather than the default priority of this
+     * task runner, with protection by the provided weak pointer. The task may be any callable type
+     * which accepts a single argument, a locked shared pointer obtained from the weak pointer. When
+     * the task is ready to be executed, if the weak pointer fails to be locked, the task is
+     * dropped.
+     *
+     * @tparam TaskType Callable type of the task.
+     * @tparam OwnerType Type of the owner of the task.
+     *
+     * @param location The location from which the task was posted (use FROM_HERE).
+     * @param task The task to be executed.
+     * @param weak_owner A weak pointer to the owner of the task.
+     * @param priority The priority with which to dispatch the task.
+     *
+     * @return True if the task was posted for execution.
+     */
+    template <typename TaskType, typename OwnerType>
+    bool post_task_with_priority(
+        TaskLocation &&location,
+        TaskType &&task,
+        std::weak_ptr<OwnerType> weak_owner,
+        TaskPriority priority);
+
+    /**
+     * Post a task which may block for an extended period of time (e.g. waiting in a system call)
+     * for execution. The task is executed in accordance with this task runner's policy, but on one
+     * of the task manager's blocking threads rather than on a worker thread. The task may be any
+     * callable type.
+     *
+     * @tparam TaskType Callable type of the task.
+     *
+     * @param location The location from which the task was posted (use FROM_HERE).
+     * @param task The task to be executed.
+     *
+     * @return True if the task was posted for execution.
+     */
+    template <typename TaskType>
+    bool post_blocking_task(TaskLocation &&location, TaskType &&task);
+
+    /**
+     * Post a task which may block for an extended period of time (e.g. waiting in a system call)
+     * for execution with protection by the provided weak pointer. The task is executed in
+     * accordance with this task runner's policy, but on one of the task manager's blocking threads
+     * rather than on a worker thread. The task may be any callable type which accepts a single
+     * argument, a locked shared pointer obtained from the weak pointer. When the task is ready to
+     * be executed, if the weak pointer fails to be locked, the task is dropped.
+     *
+     * @tparam TaskType Callable type of the task.
+     * @tparam OwnerType Type of the owner of the task.
+     *
+     * @param location The location from which the task was posted (use FROM_HERE).
+     * @param task The task to be executed.
+     * @param weak_owner A weak pointer to the owner of the task.
+     *
+     * @return True if the task was posted for execution.
+     */
+    template <typename TaskType, typename OwnerType>
+    bool post_blocking_task(
+        TaskLocation &&location,
+        TaskType &&task,
+        std::weak_ptr<OwnerType> weak_owner);
+
     /**
      * Post a task for execution. The task may be any callable type.
      *
@@ -198,6 +387,24 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
         ReplyType reply,
         std::weak_ptr<OwnerType> weak_owner);
 
+    /**
+     * Post a task for execution, and retrieve a future through which the result of the task may be
+     * obtained. The task may be any callable type which is invocable without any arguments.
+     *
+     * If the task fails to be posted, or is dropped before it is executed, the future is made
+     * ready without a result.
+     *
+     * @tparam TaskType Callable type of the task.
+     *
+     * @param location The location from which the task was posted (use FROM_HERE).
+     * @param task The task to be executed.
+     *
+     * @return The future through which the result of the task may be obtained.
+     */
+    template <typename TaskType>
+    TaskFuture<std::invoke_result_t<TaskType>>
+    post_task_with_future(TaskLocation &&location, TaskType &&task);
+
     /**
      * Schedule a task to be posted after a delay. The task may be any callable type.
      *
@@ -207,11 +414,12 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
      * @param task The task to be executed.
      * @param delay Delay before posting the task.
      *
-     * @return True if the task was posted for delayed execution.
+     * @return A handle through which the delayed task may be cancelled, which is invalid if the
+     *         task was not posted for delayed execution.
      */
     template <typename TaskType>
-    bool
-    post_task_with_delay(TaskLocation &&location, TaskType &&task, std::chrono::milliseconds delay);
+    TaskHandle
+    post_task_with_delay(TaskLocation &&location, TaskType &&task, std::chrono::nanoseconds delay);
 
     /**
      * Schedule a task to be posted after a delay with protection by the provided weak pointer. The
@@ -227,14 +435,15 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
      * @param weak_owner A weak pointer to the owner of the task.
      * @param delay Delay before posting the task.
      *
-     * @return True if the task was posted for delayed execution.
+     * @return A handle through which the delayed task may be cancelled, which is invalid if the
+     *         task was not posted for delayed execution.
      */
     template <typename TaskType, typename OwnerType>
-    bool post_task_with_delay(
+    TaskHandle post_task_with_delay(
         TaskLocation &&location,
         TaskType &&task,
         std::weak_ptr<OwnerType> weak_owner,
-        std::chrono::milliseconds delay);
+        std::chrono::nanoseconds delay);
 
     /**
      * Schedule a task to be posted after a delay. The task may be any callable type.
@@ -251,14 +460,15 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
      * @param reply The reply to be executed with the result of the task.
      * @param delay Delay before posting the task.
      *
-     * @return True if the task was posted for execution.
+     * @return A handle through which the delayed task may be cancelled, which is invalid if the
+     *         task was not posted for delayed execution.
      */
     template <typename TaskType, typename ReplyType>
-    bool post_task_with_delay_and_reply(
+    TaskHandle post_task_with_delay_and_reply(
         TaskLocation &&location,
         TaskType &&task,
         ReplyType &&reply,
-        std::chrono::milliseconds delay);
+        std::chrono::nanoseconds delay);
 
     /**
      * Schedule a task to be posted after a delay with protection by the provided weak pointer. The
@@ -282,15 +492,84 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
      * @param weak_owner A weak pointer to the owner of the task.
      * @param delay Delay before posting the task.
      *
-     * @return True if the task was posted for execution.
+     * @return A handle through which the delayed task may be cancelled, which is invalid if the
+     *         task was not posted for delayed execution.
      */
     template <typename TaskType, typename ReplyType, typename OwnerType>
-    bool post_task_with_delay_and_reply(
+    TaskHandle post_task_with_delay_and_reply(
         TaskLocation &&location,
         TaskType &&task,
         ReplyType &&reply,
         std::weak_ptr<OwnerType> weak_owner,
-        std::chrono::milliseconds delay);
+        std::chrono::nanoseconds delay);
+
+    /**
+     * Schedule a task to be posted after a delay, and retrieve a future through which the result of
+     * the task may be obtained. The task may be any callable type which is invocable without any
+     * arguments.
+     *
+     * If the task fails to be posted, or is dropped before it is executed, the future is made
+     * ready without a result.
+     *
+     * @tparam TaskType Callable type of the task.
+     *
+     * @param location The location from which the task was posted (use FROM_HERE).
+     * @param task The task to be executed.
+     * @param delay Delay before posting the task.
+     *
+     * @return The future through which the result of the task may be obtained.
+     */
+    template <typename TaskType>
+    TaskFuture<std::invoke_result_t<TaskType>> post_task_with_delay_and_future(
+        TaskLocation &&location,
+        TaskType &&task,
+        std::chrono::nanoseconds delay);
+
+    /**
+     * Create an awaitable which, when awaited by a coroutine, suspends the coroutine and resumes it
+     * as a task executed by this task runner.
+     *
+     * @param location The location from which the coroutine was suspended (use FROM_HERE).
+     *
+     * @return The awaitable.
+     */
+    ScheduleAwaitable schedule(TaskLocation &&location);
+
+    /**
+     * Create an awaitable which, when awaited by a coroutine, suspends the coroutine and resumes it
+     * as a task executed by this task runner after a delay.
+     *
+     * @param location The location from which the coroutine was suspended (use FROM_HERE).
+     * @param delay Delay before resuming the coroutine.
+     *
+     * @return The awaitable.
+     */
+    ScheduleAwaitable delay(TaskLocation &&location, std::chrono::nanoseconds delay);
+
+    /**
+     * @return A snapshot of the number of tasks queued by this task runner, and of the tasks which
+     *         were rejected or dropped by its limit.
+     */
+    TaskQueueMetrics queue_metrics() const;
+
+    /**
+     * Create an awaitable which, when awaited by a coroutine, suspends the coroutine and posts a
+     * task for execution. The task may be any callable type which is invocable without any
+     * arguments. Once the task has been executed, the coroutine is resumed with the result of the
+     * task, on the task runner which was executing the coroutine when it was suspended (if any).
+     *
+     * If the task is dropped before it is executed, the suspended coroutine is destroyed.
+     *
+     * @tparam TaskType Callable type of the task.
+     *
+     * @param location The location from which the task was posted (use FROM_HERE).
+     * @param task The task to be executed.
+     *
+     * @return The awaitable.
+     */
+    template <typename TaskType>
+    TaskAwaitable<std::decay_t<TaskType>>
+    post_task_with_awaitable(TaskLocation &&location, TaskType &&task);
 
 protected:
     /**
@@ -301,14 +580,34 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
     TaskRunner(std::weak_ptr<TaskManager> weak_task_manager) noexcept;
 
     /**
-     * Post a task for execution in accordance with the concrete task runner's policy.
+     * Post a task for execution in accordance with the concrete task runner's policy. The task has
+     * already been counted toward the task runner's queue depth, which the concrete task runner
+     * must release once the task is no longer queued.
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      *
      * @return True if the task was posted for execution.
      */
-    virtual bool post_task_internal(TaskLocation &&location, Task &&task) = 0;
+    virtual bool
+    post_task_internal(TaskLocation &&location, Task &&task, TaskPriority priority) = 0;
+
+    /**
+     * Post a batch of tasks for execution in accordance with the concrete task runner's policy. The
+     * tasks have already been counted toward the task runner's queue depth, which the concrete task
+     * runner must release once the tasks are no longer queued.
+     *
+     * @param location The location from which the tasks were posted.
+     * @param tasks The tasks to be executed.
+     * @param priority The priority with which to dispatch the tasks.
+     *
+     * @return True if the tasks were posted for execution.
+     */
+    virtual bool post_tasks_internal(
+        TaskLocation &&location,
+        std::vector<Task> &&tasks,
+        TaskPriority priority) = 0;
 
     /**
      * Completion notification triggered by the task manager that a task has finished execution.
@@ -317,15 +616,49 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
      */
     virtual void task_complete(TaskLocation &&location) = 0;
 
+    /**
+     * Notification triggered by the task manager that a task was dropped from its shared queues
+     * without being executed, to make space for newer tasks.
+     *
+     * @param location The location from which the task was posted.
+     */
+    virtual void task_dropped(TaskLocation &&location) = 0;
+
+    /**
+     * Drop the oldest tasks queued by the task runner, to make space for newer tasks. The dropped
+     * tasks are destroyed without being executed.
+     *
+     * @param count The number of tasks to drop.
+     *
+     * @return The number of tasks which were dropped.
+     */
+    virtual std::size_t drop_oldest_tasks(std::size_t count) = 0;
+
     /**
      * Forward a task to the task manager to be executed as soon as a worker thread is available.
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      *
      * @return True if the task was posted for execution.
      */
-    bool post_task_to_task_manager(TaskLocation &&location, Task &&task);
+    bool post_task_to_task_manager(TaskLocation &&location, Task &&task, TaskPriority priority);
+
+    /**
+     * Forward a batch of tasks to the task manager to be executed as soon as worker threads are
+     * available.
+     *
+     * @param location The location from which the tasks were posted.
+     * @param tasks The tasks to be executed.
+     * @param priority The priority with which to dispatch the tasks.
+     *
+     * @return True if the tasks were posted for execution.
+     */
+    bool post_tasks_to_task_manager(
+        TaskLocation &&location,
+        std::vector<Task> &&tasks,
+        TaskPriority priority);
 
     /**
      * Forward a task to the task manager to be scheduled for excution after a delay. The task will
@@ -334,16 +667,116 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      * @param delay Delay before posting the task.
      *
-     * @return True if the task was posted for delayed execution.
+     * @return A handle through which the delayed task may be cancelled, which is invalid if the
+     *         task was not posted for delayed execution.
      */
-    bool post_task_to_task_manager_with_delay(
+    TaskHandle post_task_to_task_manager_with_delay(
         TaskLocation &&location,
         Task &&task,
-        std::chrono::milliseconds delay);
+        TaskPriority priority,
+        std::chrono::nanoseconds delay);
+
+    /**
+     * @return The configuration of the task manager, or null if the task manager has been deleted.
+     */
+    std::shared_ptr<TaskConfig> task_config() const;
+
+    /**
+     * Execute a task, and then trigger its completion notification. If the calling thread is
+     * recording task instrumentation, the queueing delay and execution time of the task are
+     * recorded.
+     *
+     * @param location The location from which the task was posted.
+     * @param task The task to be executed.
+     * @param ready_time The time at which the task was ready to be executed.
+     */
+    virtual void execute(
+        TaskLocation &&location,
+        Task &&task,
+        std::chrono::steady_clock::time_point ready_time);
+
+    /**
+     * Execute a task without triggering its completion notification. If the calling thread is
+     * recording task instrumentation, the queueing delay and execution time of the task are
+     * recorded.
+     *
+     * @param location The location from which the task was posted.
+     * @param task The task to be executed.
+     * @param ready_time The time at which the task was ready to be executed.
+     */
+    void run_task(
+        const TaskLocation &location,
+        Task &&task,
+        std::chrono::steady_clock::time_point ready_time);
+
+    detail::TaskQueueDepth m_queue_depth;
 
 private:
+    /**
+     * Admit a task against the task runner's limit and the task manager's limit, and then post the
+     * task for execution in accordance with the concrete task runner's policy.
+     *
+     * @param location The location from which the task was posted.
+     * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
+     *
+     * @return True if the task was admitted and posted for execution.
+     */
+    bool admit_and_post_task(TaskLocation &&location, Task &&task, TaskPriority priority);
+
+    /**
+     * Admit a batch of tasks against the task runner's limit and the task manager's limit, and then
+     * post the tasks for execution in accordance with the concrete task runner's policy.
+     *
+     * @param location The location from which the tasks were posted.
+     * @param tasks The tasks to be executed.
+     * @param priority The priority with which to dispatch the tasks.
+     *
+     * @return True if the tasks were admitted and posted for execution.
+     */
+    bool admit_and_post_tasks(
+        TaskLocation &&location,
+        std::vector<Task> &&tasks,
+        TaskPriority priority);
+
+    /**
+     * Apply the task runner's limit, and then the task manager's limit, to tasks which are about to
+     * be posted. Once admitted, the tasks are counted toward the task runner's queue depth.
+     *
+     * @param priority The priority with which the tasks will be dispatched.
+     * @param count The number of tasks.
+     *
+     * @return True if the tasks were admitted.
+     */
+    bool admit_tasks(TaskPriority priority, std::size_t count);
+
+    /**
+     * Reserve space in the task runner's queue for tasks which are about to be posted, applying the
+     * task runner's overflow policy if the queue is at capacity.
+     *
+     * @param task_manager The task manager.
+     * @param count The number of tasks.
+     *
+     * @return True if space was reserved.
+     */
+    bool reserve_tasks(TaskManager &task_manager, std::size_t count);
+
+    /**
+     * Post a task which continues work that was already accepted by the task system (e.g. an
+     * expired delayed task or a resumed coroutine). The task is counted toward the task runner's
+     * queue depth, but is never blocked or rejected by the limits.
+     *
+     * @param location The location from which the task was posted.
+     * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
+     *
+     * @return True if the task was posted for execution.
+     */
+    bool post_admitted_task(TaskLocation &&location, Task &&task, TaskPriority priority);
+
     /**
      * Wrap a task in a generic lambda to be agnostic to the return type of the task.
      *
@@ -412,14 +845,25 @@ class TaskRunner : public std::enable_shared_from_this<TaskRunner>
     Task wrap_task(TaskType &&task, ReplyType &&reply, std::weak_ptr<OwnerType> weak_owner);
 
     /**
-     * Execute a task.
+     * Wrap a task in a generic lambda to be agnostic to the return type of the task. When the task
+     * has been executed, its result (if any) is provided to the given promise.
+     *
+     * @tparam TaskType Callable type of the task.
      *
-     * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param promise The promise through which to provide the result of the task.
+     *
+     * @return The wrapped task.
      */
-    void execute(TaskLocation &&location, Task &&task);
+    template <typename TaskType>
+    Task wrap_task_with_promise(
+        TaskType &&task,
+        detail::TaskPromise<std::invoke_result_t<TaskType>> promise);
+
+    static thread_local TaskRunner *s_current_task_runner;
 
     std::weak_ptr<TaskManager> m_weak_task_manager;
+    TaskPriority m_priority {TaskPriority::Normal};
 };
 
 /**
@@ -441,10 +885,25 @@ class ParallelTaskRunner : public TaskRunner
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      *
      * @return True if the task was posted for execution.
      */
-    bool post_task_internal(TaskLocation &&location, Task &&task) override;
+    bool post_task_internal(TaskLocation &&location, Task &&task, TaskPriority priority) override;
+
+    /**
+     * Post a batch of tasks for execution immediately.
+     *
+     * @param location The location from which the tasks were posted.
+     * @param tasks The tasks to be executed.
+     * @param priority The priority with which to dispatch the tasks.
+     *
+     * @return True if the tasks were posted for execution.
+     */
+    bool post_tasks_internal(
+        TaskLocation &&location,
+        std::vector<Task> &&tasks,
+        TaskPriority priority) override;
 
     /**
      * This implementation does nothing.
@@ -452,6 +911,36 @@ class ParallelTaskRunner : public TaskRunner
      * @param location The location from which the task was posted.
      */
     void task_complete(TaskLocation &&location) override;
+
+    /**
+     * Release the dropped task from the task runner's queue depth.
+     *
+     * @param location The location from which the task was posted.
+     */
+    void task_dropped(TaskLocation &&location) override;
+
+    /**
+     * This implementation drops no tasks. Tasks posted to this task runner are queued directly in
+     * the task manager's shared queues, from which the task runner cannot remove them, so the
+     * drop-oldest policy rejects new tasks instead.
+     *
+     * @param count The number of tasks to drop.
+     *
+     * @return Zero.
+     */
+    std::size_t drop_oldest_tasks(std::size_t count) override;
+
+    /**
+     * Release the task from the task runner's queue depth, and then execute the task.
+     *
+     * @param location The location from which the task was posted.
+     * @param task The task to be executed.
+     * @param ready_time The time at which the task was ready to be executed.
+     */
+    void execute(
+        TaskLocation &&location,
+        Task &&task,
+        std::chrono::steady_clock::time_point ready_time) override;
 };
 
 /**
@@ -459,10 +948,21 @@ class ParallelTaskRunner : public TaskRunner
  * runner will execute at a time. Tasks are executed in a FIFO manner; once one task completes, the
  * next task in line will be posted for execution.
  *
+ * The task runner may be configured to execute pending tasks in batches. In that mode, once a task
+ * completes, the next pending task is executed immediately on the same worker thread, rather than
+ * being posted to the task manager, until either the configured number of tasks have executed or
+ * the configured time budget has elapsed. The remaining pending tasks are then posted to the task
+ * manager as usual, yielding the worker thread to other task runners. Batching does not affect the
+ * order in which tasks are executed.
+ *
  * The caveat is with delayed tasks. If task A is posted with some delay, then task B is posted with
  * no delay, task B will be posted for execution first. Task A will only be posted for execution
  * once its delay has expired.
  *
+ * The limit of the task runner applies to its pending queue, i.e. tasks which are waiting for the
+ * task before them to complete. With the drop-oldest policy, the oldest pending tasks are dropped;
+ * the task which has already been posted for execution is never dropped by the task runner.
+ *
  * @author Timothy Flynn (trflynn89@pm.me)
  * @version August 12, 2018
  */
@@ -480,18 +980,67 @@ class SequencedTaskRunner : public TaskRunner
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      *
      * @return True if the task was posted for execution.
      */
-    bool post_task_internal(TaskLocation &&location, Task &&task) override;
+    bool post_task_internal(TaskLocation &&location, Task &&task, TaskPriority priority) override;
+
+    /**
+     * Post a batch of tasks for execution within this sequence. The tasks are queued behind any
+     * pending tasks with a single lock, and the first task is posted for execution if a task is not
+     * already running.
+     *
+     * @param location The location from which the tasks were posted.
+     * @param tasks The tasks to be executed.
+     * @param priority The priority with which to dispatch the tasks.
+     *
+     * @return True if the tasks were posted for execution or added to the pending queue.
+     */
+    bool post_tasks_internal(
+        TaskLocation &&location,
+        std::vector<Task> &&tasks,
+        TaskPriority priority) override;
 
     /**
-     * When a task is complete, post the next task in the pending queue.
+     * Completion notification triggered after a task has finished execution. The next task in the
+     * pending queue is posted by the worker thread which executed the completed task, once its
+     * batch is complete.
      *
      * @param location The location from which the task was posted.
      */
     void task_complete(TaskLocation &&location) override;
 
+    /**
+     * When a task is dropped by the task manager, post the next task in the pending queue.
+     *
+     * @param location The location from which the task was posted.
+     */
+    void task_dropped(TaskLocation &&location) override;
+
+    /**
+     * Drop the oldest tasks in the pending queue.
+     *
+     * @param count The number of tasks to drop.
+     *
+     * @return The number of tasks which were dropped.
+     */
+    std::size_t drop_oldest_tasks(std::size_t count) override;
+
+    /**
+     * Execute a task, followed by as many pending tasks as allowed by the batch limits, and then
+     * post the next task in the pending queue. Pending tasks executed within the batch are
+     * considered ready to be executed as soon as the task before them completes.
+     *
+     * @param location The location from which the task was posted.
+     * @param task The task to be executed.
+     * @param ready_time The time at which the task was ready to be executed.
+     */
+    void execute(
+        TaskLocation &&location,
+        Task &&task,
+        std::chrono::steady_clock::time_point ready_time) override;
+
 private:
     /**
      * Structure to hold a task until it is ready to be executed within its sequence.
@@ -500,8 +1049,23 @@ class SequencedTaskRunner : public TaskRunner
     {
         TaskLocation m_location;
         Task m_task;
+        TaskPriority m_priority {TaskPriority::Normal};
     };
 
+    /**
+     * If the current batch has not exhausted its limits, remove the first task in the pending queue
+     * (if there is one) to be executed next within the current batch.
+     *
+     * @param batch_count The number of tasks executed so far within the current batch.
+     * @param batch_deadline The time at which the current batch expires, if batches are limited by
+     *        duration.
+     *
+     * @return If available, the task to be executed next within the current batch.
+     */
+    std::optional<PendingTask> continue_batch(
+        std::uint32_t batch_count,
+        std::chrono::steady_clock::time_point batch_deadline);
+
     /**
      * If no task has been posted for execution, post either the first task in the pending queue (if
      * there is one) or the given task (if non-null). If a task is currently posted for execution,
@@ -509,21 +1073,25 @@ class SequencedTaskRunner : public TaskRunner
      *
      * @param location The location from which the task was posted.
      * @param task The task to be executed.
+     * @param priority The priority with which to dispatch the task.
      *
      * @return True if the task was posted for execution or added to the pending queue.
      */
-    bool maybe_post_task(TaskLocation &&location, Task &&task);
+    bool maybe_post_task(TaskLocation &&location, Task &&task, TaskPriority priority);
 
     std::mutex m_pending_tasks_mutex;
     std::queue<PendingTask> m_pending_tasks;
     bool m_has_running_task {false};
+
+    std::uint32_t m_batch_size {1};
+    std::chrono::microseconds m_batch_duration {0};
 };
 
 //==================================================================================================
 template <typename TaskType>
 bool TaskRunner::post_task(TaskLocation &&location, TaskType &&task)
 {
-    return post_task_internal(std::move(location), wrap_task(std::move(task)));
+    return admit_and_post_task(std::move(location), wrap_task(std::move(task)), m_priority);
 }
 
 //==================================================================================================
@@ -533,16 +1101,100 @@ bool TaskRunner::post_task(
     TaskType &&task,
     std::weak_ptr<OwnerType> weak_owner)
 {
-    return post_task_internal(
+    return admit_and_post_task(
+        std::move(location),
+        wrap_task(std::move(task), std::move(weak_owner)),
+        m_priority);
+}
+
+//==================================================================================================
+template <typename TaskRange>
+bool TaskRunner::post_tasks(TaskLocation &&location, TaskRange &&tasks)
+{
+    std::vector<Task> wrapped_tasks;
+    wrapped_tasks.reserve(
+        static_cast<std::size_t>(std::distance(std::begin(tasks), std::end(tasks))));
+
+    for (auto &task : tasks)
+    {
+        wrapped_tasks.push_back(wrap_task(std::move(task)));
+    }
+
+    return admit_and_post_tasks(std::move(location), std::move(wrapped_tasks), m_priority);
+}
+
+//==================================================================================================
+template <typename TaskRange, typename OwnerType>
+bool TaskRunner::post_tasks(
+    TaskLocation &&location,
+    TaskRange &&tasks,
+    std::weak_ptr<OwnerType> weak_owner)
+{
+    std::vector<Task> wrapped_tasks;
+    wrapped_tasks.reserve(
+        static_cast<std::size_t>(std::distance(std::begin(tasks), std::end(tasks))));
+
+    for (auto &task : tasks)
+    {
+        wrapped_tasks.push_back(wrap_task(std::move(task), weak_owner));
+    }
+
+    return admit_and_post_tasks(std::move(location), std::move(wrapped_tasks), m_priority);
+}
+
+//==================================================================================================
+template <typename TaskType>
+bool TaskRunner::post_task_with_priority(
+    TaskLocation &&location,
+    TaskType &&task,
+    TaskPriority priority)
+{
+    return admit_and_post_task(std::move(location), wrap_task(std::move(task)), priority);
+}
+
+//==================================================================================================
+template <typename TaskType, typename OwnerType>
+bool TaskRunner::post_task_with_priority(
+    TaskLocation &&location,
+    TaskType &&task,
+    std::weak_ptr<OwnerType> weak_owner,
+    TaskPriority priority)
+{
+    return admit_and_post_task(
+        std::move(location),
+        wrap_task(std::move(task), std::move(weak_owner)),
+        priority);
+}
+
+//==================================================================================================
+template <typename TaskType>
+bool TaskRunner::post_blocking_task(TaskLocation &&location, TaskType &&task)
+{
+    return post_task_with_priority(std::move(location), std::move(task), TaskPriority::Blocking);
+}
+
+//==================================================================================================
+template <typename TaskType, typename OwnerType>
+bool TaskRunner::post_blocking_task(
+    TaskLocation &&location,
+    TaskType &&task,
+    std::weak_ptr<OwnerType> weak_owner)
+{
+    return post_task_with_priority(
         std::move(location),
-        wrap_task(std::move(task), std::move(weak_owner)));
+        std::move(task),
+        std::move(weak_owner),
+        TaskPriority::Blocking);
 }
 
 //==================================================================================================
 template <typename TaskType, typename ReplyType>
 bool TaskRunner::post_task_with_reply(TaskLocation &&location, TaskType &&task, ReplyType reply)
 {
-    return post_task_internal(std::move(location), wrap_task(std::move(task), std::move(reply)));
+    return admit_and_post_task(
+        std::move(location),
+        wrap_task(std::move(task), std::move(reply)),
+        m_priority);
 }
 
 //==================================================================================================
@@ -553,67 +1205,124 @@ bool TaskRunner::post_task_with_reply(
     ReplyType reply,
     std::weak_ptr<OwnerType> weak_owner)
 {
-    return post_task_internal(
+    return admit_and_post_task(
+        std::move(location),
+        wrap_task(std::move(task), std::move(reply), std::move(weak_owner)),
+        m_priority);
+}
+
+//==================================================================================================
+template <typename TaskType>
+TaskFuture<std::invoke_result_t<TaskType>>
+TaskRunner::post_task_with_future(TaskLocation &&location, TaskType &&task)
+{
+    using ResultType = std::invoke_result_t<TaskType>;
+
+    auto state = std::make_shared<detail::TaskFutureState<ResultType>>(m_weak_task_manager);
+    TaskFuture<ResultType> future(state);
+
+    admit_and_post_task(
         std::move(location),
-        wrap_task(std::move(task), std::move(reply), std::move(weak_owner)));
+        wrap_task_with_promise(std::move(task), detail::TaskPromise<ResultType>(std::move(state))),
+        m_priority);
+
+    return future;
 }
 
 //==================================================================================================
 template <typename TaskType>
-bool TaskRunner::post_task_with_delay(
+TaskHandle TaskRunner::post_task_with_delay(
     TaskLocation &&location,
     TaskType &&task,
-    std::chrono::milliseconds delay)
+    std::chrono::nanoseconds delay)
 {
     return post_task_to_task_manager_with_delay(
         std::move(location),
         wrap_task(std::move(task)),
+        m_priority,
         delay);
 }
 
 //==================================================================================================
 template <typename TaskType, typename OwnerType>
-bool TaskRunner::post_task_with_delay(
+TaskHandle TaskRunner::post_task_with_delay(
     TaskLocation &&location,
     TaskType &&task,
     std::weak_ptr<OwnerType> weak_owner,
-    std::chrono::milliseconds delay)
+    std::chrono::nanoseconds delay)
 {
     return post_task_to_task_manager_with_delay(
         std::move(location),
         wrap_task(std::move(task), std::move(weak_owner)),
+        m_priority,
         delay);
 }
 
 //==================================================================================================
 template <typename TaskType, typename ReplyType>
-bool TaskRunner::post_task_with_delay_and_reply(
+TaskHandle TaskRunner::post_task_with_delay_and_reply(
     TaskLocation &&location,
     TaskType &&task,
     ReplyType &&reply,
-    std::chrono::milliseconds delay)
+    std::chrono::nanoseconds delay)
 {
     return post_task_to_task_manager_with_delay(
         std::move(location),
         wrap_task(std::move(task), std::move(reply)),
+        m_priority,
         delay);
 }
 
 //==================================================================================================
 template <typename TaskType, typename ReplyType, typename OwnerType>
-bool TaskRunner::post_task_with_delay_and_reply(
+TaskHandle TaskRunner::post_task_with_delay_and_reply(
     TaskLocation &&location,
     TaskType &&task,
     ReplyType &&reply,
     std::weak_ptr<OwnerType> weak_owner,
-    std::chrono::milliseconds delay)
+    std::chrono::nanoseconds delay)
 {
     return post_task_to_task_manager_with_delay(
         std::move(location),
         wrap_task(std::move(task), std::move(reply), std::move(weak_owner)),
+        m_priority,
         delay);
 }
 
+//==================================================================================================
+template <typename TaskType>
+TaskFuture<std::invoke_result_t<TaskType>> TaskRunner::post_task_with_delay_and_future(
+    TaskLocation &&location,
+    TaskType &&task,
+    std::chrono::nanoseconds delay)
+{
+    using ResultType = std::invoke_result_t<TaskType>;
+
+    auto state = std::make_shared<detail::TaskFutureState<ResultType>>(m_weak_task_manager);
+    TaskFuture<ResultType> future(state);
+
+    post_task_to_task_manager_with_delay(
+        std::move(location),
+        wrap_task_with_promise(std::move(task), detail::TaskPromise<ResultType>(std::move(state))),
+        m_priority,
+        delay);
+
+    return future;
+}
+
+//==================================================================================================
+template <typename TaskType>
+TaskAwaitable<std::decay_t<TaskType>>
+TaskRunner::post_task_with_awaitable(TaskLocation &&location, TaskType &&task)
+{
+    static_assert(std::is_invocable_v<TaskType>, "Task must be invocable without any arguments");
+
+    return TaskAwaitable<std::decay_t<TaskType>>(
+        shared_from_this(),
+        std::move(location),
+        std::forward<TaskType>(task));
+}
+
 //==================================================================================================
 template <typename TaskType>
 Task TaskRunner::wrap_task(TaskType &&task)
@@ -675,7 +1384,13 @@ Task TaskRunner::wrap_task(TaskType &&task, ReplyType &&reply)
         else
         {
             auto result = std::move(task)();
-            runner->post_task(std::move(location), std::bind(std::move(reply), std::move(result)));
+
+            auto bound_reply = [reply = std::move(reply), result = std::move(result)]() mutable
+            {
+                std::move(reply)(std::move(result));
+            };
+
+            runner->post_task(std::move(location), std::move(bound_reply));
         }
     };
 }
@@ -719,12 +1434,30 @@ Task TaskRunner::wrap_task(TaskType &&task, ReplyType &&reply, std::weak_ptr<Own
         {
             auto result = std::move(task)(std::move(owner));
 
-            runner->post_task(
-                std::move(location),
-                std::bind(std::move(reply), std::move(result), std::placeholders::_1),
-                std::move(weak_owner));
+            auto bound_reply = [reply = std::move(reply), result = std::move(result)](
+                                   StrongOwnerType strong_owner) mutable
+            {
+                std::move(reply)(std::move(result), std::move(strong_owner));
+            };
+
+            runner->post_task(std::move(location), std::move(bound_reply), std::move(weak_owner));
         }
     };
 }
 
+//==================================================================================================
+template <typename TaskType>
+Task TaskRunner::wrap_task_with_promise(
+    TaskType &&task,
+    detail::TaskPromise<std::invoke_result_t<TaskType>> promise)
+{
+    static_assert(std::is_invocable_v<TaskType>, "Task must be invocable without any arguments");
+
+    return [task = std::move(task),
+            promise = std::move(promise)](TaskRunner *, TaskLocation) mutable
+    {
+        promise.fulfill(std::move(task));
+    };
+}
+
 } // namespace fly
@@ -0,0 +1,159 @@
+#include "fly/task/task_tracer.hpp"
+
+#include <algorithm>
+
+namespace fly {
+
+namespace {
+
+    // Tasks are only traced within the current process, so a fixed process ID is used.
+    constexpr const std::uint32_t s_process_id = 1;
+
+    /**
+     * @return The given string, or an empty string if the given string is null.
+     */
+    const char *or_empty(const char *string)
+    {
+        return (string == nullptr) ? "" : string;
+    }
+
+} // namespace
+
+thread_local TaskTracer::ThreadTrace *TaskTracer::s_thread_trace = nullptr;
+
+//==================================================================================================
+TaskTracer::TaskTracer(std::size_t buffer_size) noexcept :
+    m_buffer_size(std::max(buffer_size, std::size_t(1))),
+    m_epoch(std::chrono::steady_clock::now())
+{
+}
+
+//==================================================================================================
+void TaskTracer::attach_thread(std::string name)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_threads_mutex);
+
+        for (auto &thread_trace : m_threads)
+        {
+            if ((thread_trace->m_name == name) &&
+                !thread_trace->m_attached.load(std::memory_order_acquire))
+            {
+                thread_trace->m_attached.store(true, std::memory_order_relaxed);
+                s_thread_trace = thread_trace.get();
+
+                return;
+            }
+        }
+    }
+
+    auto thread_trace = std::make_unique<ThreadTrace>();
+    thread_trace->m_name = std::move(name);
+    thread_trace->m_events.resize(m_buffer_size);
+
+    s_thread_trace = thread_trace.get();
+
+    std::lock_guard<std::mutex> lock(m_threads_mutex);
+    thread_trace->m_thread_id = static_cast<std::uint32_t>(m_threads.size() + 1);
+    m_threads.push_back(std::move(thread_trace));
+}
+
+//==================================================================================================
+void TaskTracer::detach_thread()
+{
+    if (s_thread_trace != nullptr)
+    {
+        s_thread_trace->m_attached.store(false, std::memory_order_release);
+        s_thread_trace = nullptr;
+    }
+}
+
+//==================================================================================================
+void TaskTracer::record(
+    const TaskLocation &location,
+    std::chrono::steady_clock::time_point ready_time,
+    std::chrono::steady_clock::time_point start_time,
+    std::chrono::steady_clock::time_point end_time)
+{
+    if (ThreadTrace *thread_trace = s_thread_trace; thread_trace != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(thread_trace->m_mutex);
+
+        const std::size_t index = thread_trace->m_event_count++ % thread_trace->m_events.size();
+        thread_trace->m_events[index] = {location, ready_time, start_time, end_time};
+    }
+}
+
+//==================================================================================================
+bool TaskTracer::is_thread_attached()
+{
+    return s_thread_trace != nullptr;
+}
+
+//==================================================================================================
+Json TaskTracer::trace() const
+{
+    Json events = JsonTraits::array_type();
+    events.push_back(
+        {{"name", "process_name"},
+         {"ph", "M"},
+         {"pid", s_process_id},
+         {"args", {{"name", "libfly"}}}});
+
+    std::lock_guard<std::mutex> threads_lock(m_threads_mutex);
+
+    for (const auto &thread_trace : m_threads)
+    {
+        events.push_back(
+            {{"name", "thread_name"},
+             {"ph", "M"},
+             {"pid", s_process_id},
+             {"tid", thread_trace->m_thread_id},
+             {"args", {{"name", thread_trace->m_name}}}});
+
+        std::lock_guard<std::mutex> lock(thread_trace->m_mutex);
+
+        const std::uint64_t buffer_size = thread_trace->m_events.size();
+        const std::uint64_t event_count = std::min(thread_trace->m_event_count, buffer_size);
+        const std::uint64_t first_event = thread_trace->m_event_count - event_count;
+
+        for (std::uint64_t i = first_event; i < thread_trace->m_event_count; ++i)
+        {
+            const TraceEvent &event = thread_trace->m_events[i % buffer_size];
+
+            const auto queue_delay = std::max(
+                event.m_start_time - event.m_ready_time,
+                std::chrono::steady_clock::duration::zero());
+            const auto queue_delay_us =
+                std::chrono::duration<double, std::micro>(queue_delay).count();
+
+            const auto duration = event.m_end_time - event.m_start_time;
+            const auto duration_us = std::chrono::duration<double, std::micro>(duration).count();
+
+            // Tasks are recorded when they finish, so a task executed while another task waits on
+            // the same thread is recorded first. Complete events may be emitted in any order.
+            events.push_back(
+                {{"name", or_empty(event.m_location.m_function)},
+                 {"cat", "task"},
+                 {"ph", "X"},
+                 {"ts", timestamp(event.m_start_time)},
+                 {"dur", duration_us},
+                 {"pid", s_process_id},
+                 {"tid", thread_trace->m_thread_id},
+                 {"args",
+                  {{"file", or_empty(event.m_location.m_file)},
+                   {"line", event.m_location.m_line},
+                   {"queue_delay_us", queue_delay_us}}}});
+        }
+    }
+
+    return {{"traceEvents", std::move(events)}, {"displayTimeUnit", "ns"}};
+}
+
+//==================================================================================================
+double TaskTracer::timestamp(std::chrono::steady_clock::time_point time) const
+{
+    return std::chrono::duration<double, std::micro>(time - m_epoch).count();
+}
+
+} // namespace fly
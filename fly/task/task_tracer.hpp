@@ -0,0 +1,126 @@
+#pragma once
+
+#include "fly/task/task_types.hpp"
+#include "fly/types/json/json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fly {
+
+/**
+ * Class to trace the execution of tasks. Each thread which executes tasks attaches itself to the
+ * tracer, and then records the execution of each task into a ring buffer owned by that thread.
+ * Once a thread's ring buffer is full, the oldest events recorded by that thread are overwritten.
+ *
+ * Traces are formatted as Chrome trace event JSON, which may be loaded into chrome://tracing or
+ * Perfetto. Each task is emitted as a single complete event, with a start time and duration, on the
+ * thread which executed it, named after the function from which the task was posted. Tasks which
+ * were executed while another task on the same thread was waiting are nested within that task's
+ * event. The posting location and the task's queueing delay (see TaskMetrics) are attached to each
+ * event, so scheduling gaps, head-of-line blocking, and timer drift are all visible in the trace.
+ */
+class TaskTracer
+{
+public:
+    /**
+     * Constructor. Timestamps in the trace are relative to the time the tracer is created.
+     *
+     * @param buffer_size The maximum number of tasks to retain per thread.
+     */
+    explicit TaskTracer(std::size_t buffer_size) noexcept;
+
+    /**
+     * Attach the calling thread to this tracer. Tasks subsequently executed by the calling thread
+     * are recorded by this tracer until the thread is detached. If a thread with the same name has
+     * detached from this tracer, its ring buffer is reused by the calling thread, so that the
+     * threads are shown as a single thread in the trace.
+     *
+     * @param name The name with which to label the calling thread in the trace.
+     */
+    void attach_thread(std::string name);
+
+    /**
+     * Detach the calling thread from whichever tracer it is attached to, if any. Events already
+     * recorded by the thread are retained by the tracer.
+     */
+    static void detach_thread();
+
+    /**
+     * If the calling thread is attached to a tracer, record the execution of a task.
+     *
+     * @param location The location from which the task was posted.
+     * @param ready_time The time at which the task was ready to execute.
+     * @param start_time The time at which the task started executing.
+     * @param end_time The time at which the task finished executing.
+     */
+    static void record(
+        const TaskLocation &location,
+        std::chrono::steady_clock::time_point ready_time,
+        std::chrono::steady_clock::time_point start_time,
+        std::chrono::steady_clock::time_point end_time);
+
+    /**
+     * @return True if the calling thread is attached to a tracer.
+     */
+    static bool is_thread_attached();
+
+    /**
+     * Format the events recorded by every thread as a Chrome trace event JSON object.
+     *
+     * @return The formatted trace.
+     */
+    Json trace() const;
+
+private:
+    /**
+     * The execution of a single task.
+     */
+    struct TraceEvent
+    {
+        TaskLocation m_location;
+        std::chrono::steady_clock::time_point m_ready_time;
+        std::chrono::steady_clock::time_point m_start_time;
+        std::chrono::steady_clock::time_point m_end_time;
+    };
+
+    /**
+     * The ring buffer of events recorded by a single thread. The buffer is allocated up front when
+     * the thread is attached. The lock is only contended while a trace is being formatted.
+     */
+    struct ThreadTrace
+    {
+        std::string m_name;
+        std::uint32_t m_thread_id {0};
+        std::atomic_bool m_attached {true};
+
+        mutable std::mutex m_mutex;
+        std::vector<TraceEvent> m_events;
+        std::uint64_t m_event_count {0};
+    };
+
+    /**
+     * Convert a point in time to the number of microseconds since the tracer was created.
+     *
+     * @param time The point in time to convert.
+     *
+     * @return The number of microseconds since the tracer was created.
+     */
+    double timestamp(std::chrono::steady_clock::time_point time) const;
+
+    static thread_local ThreadTrace *s_thread_trace;
+
+    const std::size_t m_buffer_size;
+    const std::chrono::steady_clock::time_point m_epoch;
+
+    mutable std::mutex m_threads_mutex;
+    std::vector<std::unique_ptr<ThreadTrace>> m_threads;
+};
+
+} // namespace fly
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "fly/task/basic_task.hpp"
+
+#include <cstddef>
 #include <cstdint>
-#include <functional>
 
 namespace fly {
 
@@ -17,9 +19,37 @@ struct TaskLocation
     std::uint32_t m_line {0};
 };
 
+/**
+ * Priority lanes in which tasks are dispatched by the task manager. Worker threads prefer tasks
+ * with a higher priority, but periodically give lower priority tasks the first pick to avoid
+ * starving them.
+ *
+ * Tasks which may block for an extended period of time (e.g. waiting in a system call) should be
+ * posted with the blocking priority. Blocking tasks are not placed in a priority lane; they are
+ * instead dispatched to a separate pool of threads which grows on demand, so that they never
+ * occupy the worker threads.
+ */
+enum class TaskPriority : std::uint8_t
+{
+    High,
+    Normal,
+    Background,
+
+    NumPriorities,
+
+    Blocking = NumPriorities,
+};
+
+/**
+ * The size (in bytes) of the inline storage of a task. Callables which fit within this size, such
+ * as lambdas capturing a few pointers, a weak pointer, and a moved payload, are posted without any
+ * heap allocation.
+ */
+inline constexpr std::size_t s_task_inline_size = 128;
+
 /**
  * Tasks posted to a task runner are wrapped in a generic lambda to be agnostic to return types.
  */
-using Task = std::function<void(TaskRunner *, TaskLocation)>;
+using Task = BasicTask<void(TaskRunner *, TaskLocation), s_task_inline_size>;
 
 } // namespace fly
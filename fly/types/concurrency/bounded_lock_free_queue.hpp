@@ -0,0 +1,327 @@
+#pragma once
+
+#include "fly/types/concurrency/detail/wait_notifier.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace fly {
+
+/**
+ * A bounded, lock-free, multi-producer multi-consumer FIFO queue. The queue is backed by a ring
+ * buffer of a fixed capacity; each slot in the ring buffer holds a sequence number which producers
+ * and consumers use to claim the slot, so pushing and popping items never takes a lock.
+ *
+ * This queue provides the same API as fly::ConcurrentQueue. Pushing onto a full queue blocks until
+ * space is available; use try_push to fail instead. Popping from an empty queue blocks (optionally
+ * with a timeout) until an item is available.
+ */
+template <typename T>
+class BoundedLockFreeQueue
+{
+public:
+    using size_type = std::size_t;
+    using value_type = T;
+
+    static constexpr size_type s_default_capacity = 1024;
+
+    /**
+     * Constructor. Allocate the ring buffer, rounding the given capacity up to the nearest power
+     * of two.
+     *
+     * @param capacity The minimum number of items the queue may hold.
+     */
+    explicit BoundedLockFreeQueue(size_type capacity = s_default_capacity);
+
+    /**
+     * Destructor. Destroy any items remaining in the queue.
+     */
+    ~BoundedLockFreeQueue();
+
+    BoundedLockFreeQueue(const BoundedLockFreeQueue &) = delete;
+    BoundedLockFreeQueue &operator=(const BoundedLockFreeQueue &) = delete;
+
+    /**
+     * Move an item onto the queue. If the queue is full, wait indefinitely for space to be
+     * available.
+     *
+     * @param item Item to push onto the queue.
+     */
+    void push(T &&item);
+
+    /**
+     * Move an item onto the queue if there is space available. The item is only moved-from if it
+     * was pushed.
+     *
+     * @param item Item to push onto the queue.
+     *
+     * @return True if the item was pushed.
+     */
+    bool try_push(T &&item);
+
+    /**
+     * Pop an item from the queue. If the queue is empty, wait indefinitely for an item to be
+     * available.
+     *
+     * @param item Location to store the popped item.
+     */
+    void pop(T &item);
+
+    /**
+     * Pop an item from the queue. If the queue is empty, wait (at most) for the specified amount
+     * of time for an item to be available.
+     *
+     * @param item Location to store the popped item.
+     * @param duration The amount of time to wait.
+     *
+     * @return True if an object was popped in the given duration.
+     */
+    template <typename R, typename P>
+    bool pop(T &item, std::chrono::duration<R, P> duration);
+
+    /**
+     * Pop an item from the queue if one is available, without waiting.
+     *
+     * @param item Location to store the popped item.
+     *
+     * @return True if an object was popped.
+     */
+    bool try_pop(T &item);
+
+    /**
+     * @return True if the queue is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @return The number of items in the queue. Under concurrent access, this is only a snapshot.
+     */
+    size_type size() const;
+
+    /**
+     * @return The maximum number of items the queue may hold.
+     */
+    size_type capacity() const;
+
+private:
+    /**
+     * A single slot in the ring buffer. The slot's sequence number is equal to the position of the
+     * producer which may next write to the slot, or to that position plus one once the slot has
+     * been written and may be read by a consumer.
+     */
+    struct Slot
+    {
+        std::atomic<size_type> m_sequence;
+        alignas(T) unsigned char m_storage[sizeof(T)];
+
+        T *item()
+        {
+            return std::launder(static_cast<T *>(static_cast<void *>(m_storage)));
+        }
+    };
+
+    static size_type round_capacity(size_type capacity);
+
+    const size_type m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(detail::s_cache_line_size) std::atomic<size_type> m_push_position {0};
+    alignas(detail::s_cache_line_size) std::atomic<size_type> m_pop_position {0};
+
+    detail::WaitNotifier m_not_empty;
+    detail::WaitNotifier m_not_full;
+};
+
+//==================================================================================================
+template <typename T>
+BoundedLockFreeQueue<T>::BoundedLockFreeQueue(size_type capacity) :
+    m_mask(round_capacity(capacity) - 1),
+    m_slots(std::make_unique<Slot[]>(m_mask + 1))
+{
+    for (size_type i = 0; i <= m_mask; ++i)
+    {
+        m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+//==================================================================================================
+template <typename T>
+BoundedLockFreeQueue<T>::~BoundedLockFreeQueue()
+{
+    const size_type push_position = m_push_position.load();
+
+    for (size_type position = m_pop_position.load(); position != push_position; ++position)
+    {
+        m_slots[position & m_mask].item()->~T();
+    }
+}
+
+//==================================================================================================
+template <typename T>
+void BoundedLockFreeQueue<T>::push(T &&item)
+{
+    if (!try_push(std::move(item)))
+    {
+        m_not_full.wait(
+            [this, &item]()
+            {
+                return try_push(std::move(item));
+            });
+    }
+}
+
+//==================================================================================================
+template <typename T>
+bool BoundedLockFreeQueue<T>::try_push(T &&item)
+{
+    size_type position = m_push_position.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+
+    while (true)
+    {
+        slot = &m_slots[position & m_mask];
+
+        const size_type sequence = slot->m_sequence.load(std::memory_order_acquire);
+        const auto difference =
+            static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+        if (difference == 0)
+        {
+            if (m_push_position.compare_exchange_weak(
+                    position,
+                    position + 1,
+                    std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = m_push_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    ::new (static_cast<void *>(slot->m_storage)) T(std::move(item));
+    slot->m_sequence.store(position + 1, std::memory_order_release);
+
+    m_not_empty.notify_one();
+    return true;
+}
+
+//==================================================================================================
+template <typename T>
+void BoundedLockFreeQueue<T>::pop(T &item)
+{
+    m_not_empty.wait(
+        [this, &item]()
+        {
+            return try_pop(item);
+        });
+}
+
+//==================================================================================================
+template <typename T>
+template <typename R, typename P>
+bool BoundedLockFreeQueue<T>::pop(T &item, std::chrono::duration<R, P> duration)
+{
+    return m_not_empty.wait_for(
+        [this, &item]()
+        {
+            return try_pop(item);
+        },
+        duration);
+}
+
+//==================================================================================================
+template <typename T>
+bool BoundedLockFreeQueue<T>::try_pop(T &item)
+{
+    size_type position = m_pop_position.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+
+    while (true)
+    {
+        slot = &m_slots[position & m_mask];
+
+        const size_type sequence = slot->m_sequence.load(std::memory_order_acquire);
+        const auto difference =
+            static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+        if (difference == 0)
+        {
+            if (m_pop_position.compare_exchange_weak(
+                    position,
+                    position + 1,
+                    std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = m_pop_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    T *stored = slot->item();
+    item = std::move(*stored);
+    stored->~T();
+
+    slot->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+
+    m_not_full.notify_one();
+    return true;
+}
+
+//==================================================================================================
+template <typename T>
+bool BoundedLockFreeQueue<T>::empty() const
+{
+    return size() == 0;
+}
+
+//==================================================================================================
+template <typename T>
+auto BoundedLockFreeQueue<T>::size() const -> size_type
+{
+    const size_type pop_position = m_pop_position.load(std::memory_order_acquire);
+    const size_type push_position = m_push_position.load(std::memory_order_acquire);
+
+    return (push_position > pop_position) ? (push_position - pop_position) : 0;
+}
+
+//==================================================================================================
+template <typename T>
+auto BoundedLockFreeQueue<T>::capacity() const -> size_type
+{
+    return m_mask + 1;
+}
+
+//==================================================================================================
+template <typename T>
+auto BoundedLockFreeQueue<T>::round_capacity(size_type capacity) -> size_type
+{
+    size_type rounded = 2;
+
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+
+    return rounded;
+}
+
+} // namespace fly
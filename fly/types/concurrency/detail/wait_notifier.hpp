@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace fly::detail {
+
+/**
+ * The assumed size (in bytes) of a cache line. Atomics which are heavily contended by different
+ * threads are aligned to this size to avoid false sharing.
+ */
+inline constexpr std::size_t s_cache_line_size = 64;
+
+/**
+ * Helper for lock-free containers to allow callers to block until the container is in some state,
+ * e.g. until the container is non-empty. The mutex and condition variable are only touched by
+ * threads which actually need to wait, and by notifying threads when there is at least one waiting
+ * thread. Thus, the common case of an uncontended push or pop never takes a lock.
+ */
+class WaitNotifier
+{
+public:
+    /**
+     * Block until the given predicate is satisfied. The predicate may have side effects (e.g. it
+     * may attempt to pop an item from a container); it is invoked until it returns true.
+     *
+     * @tparam Predicate Type of the predicate to invoke.
+     *
+     * @param predicate The predicate to invoke.
+     */
+    template <typename Predicate>
+    void wait(Predicate predicate);
+
+    /**
+     * Block until the given predicate is satisfied, or until the given amount of time has passed.
+     * The predicate may have side effects (e.g. it may attempt to pop an item from a container); it
+     * is invoked until it returns true or the wait times out.
+     *
+     * @tparam Predicate Type of the predicate to invoke.
+     *
+     * @param predicate The predicate to invoke.
+     * @param duration The amount of time to wait.
+     *
+     * @return True if the predicate was satisfied in the given duration.
+     */
+    template <typename Predicate, typename R, typename P>
+    bool wait_for(Predicate predicate, std::chrono::duration<R, P> duration);
+
+    /**
+     * Wake a single thread waiting for its predicate to be satisfied, if any.
+     */
+    void notify_one();
+
+    /**
+     * Wake all threads waiting for their predicates to be satisfied, if any.
+     */
+    void notify_all();
+
+private:
+    /**
+     * @return True if there is at least one thread waiting on the condition variable.
+     */
+    bool has_waiters() const;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<std::uint32_t> m_waiters {0};
+};
+
+//==================================================================================================
+template <typename Predicate>
+void WaitNotifier::wait(Predicate predicate)
+{
+    if (predicate())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_waiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    while (!predicate())
+    {
+        m_condition.wait(lock);
+    }
+
+    m_waiters.fetch_sub(1);
+}
+
+//==================================================================================================
+template <typename Predicate, typename R, typename P>
+bool WaitNotifier::wait_for(Predicate predicate, std::chrono::duration<R, P> duration)
+{
+    if (predicate())
+    {
+        return true;
+    }
+    else if (duration <= duration.zero())
+    {
+        return false;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_waiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const bool satisfied = m_condition.wait_until(lock, deadline, std::move(predicate));
+    m_waiters.fetch_sub(1);
+
+    return satisfied;
+}
+
+//==================================================================================================
+inline void WaitNotifier::notify_one()
+{
+    if (has_waiters())
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+        }
+
+        m_condition.notify_one();
+    }
+}
+
+//==================================================================================================
+inline void WaitNotifier::notify_all()
+{
+    if (has_waiters())
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+        }
+
+        m_condition.notify_all();
+    }
+}
+
+//==================================================================================================
+inline bool WaitNotifier::has_waiters() const
+{
+    // Pairs with the fence in wait() and wait_for(): either the waiting thread observes the state
+    // published by the notifying thread before blocking, or the notifying thread observes the
+    // waiting thread here.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return m_waiters.load(std::memory_order_relaxed) > 0;
+}
+
+} // namespace fly::detail
@@ -0,0 +1,564 @@
+#pragma once
+
+#include "fly/types/concurrency/detail/wait_notifier.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <thread>
+#include <utility>
+
+namespace fly {
+
+/**
+ * An unbounded, lock-free, multi-producer multi-consumer FIFO queue. The queue is formed by a
+ * linked list of fixed-size segments. Producers claim a slot in the tail segment with a single
+ * atomic increment, and consumers claim a written slot in the head segment with a single atomic
+ * compare-and-swap. A new segment is appended once the tail segment is full, and the head segment
+ * is unlinked once all of its slots have been consumed.
+ *
+ * Unlinked segments are not freed immediately, as other threads may still be accessing them.
+ * Instead, they are reclaimed with epoch-based reclamation: every operation on the queue is counted
+ * against the global epoch in which it started, and the epoch only advances once no operation which
+ * started in the previous epoch remains. A segment unlinked during an epoch is freed once the epoch
+ * has advanced twice, at which point no thread may still hold a pointer to it. As each operation is
+ * short, the epoch keeps advancing under constant contention, and the number of unlinked segments
+ * awaiting reclamation remains bounded.
+ *
+ * This queue provides the same API as fly::ConcurrentQueue. Pushing never blocks. Popping from an
+ * empty queue blocks (optionally with a timeout) until an item is available.
+ *
+ * A range of items may also be pushed at once, in which case the producer claims as many slots as
+ * it needs in each segment with a single atomic increment, and wakes waiting consumers once.
+ */
+template <typename T>
+class LockFreeQueue
+{
+public:
+    using size_type = std::size_t;
+    using value_type = T;
+
+    static constexpr size_type s_segment_size = 128;
+
+    /**
+     * Constructor. Allocate the initial segment.
+     */
+    LockFreeQueue();
+
+    /**
+     * Destructor. Destroy any items remaining in the queue and free all segments.
+     */
+    ~LockFreeQueue();
+
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+    /**
+     * Move an item onto the queue.
+     *
+     * @param item Item to push onto the queue.
+     */
+    void push(T &&item);
+
+    /**
+     * Move a range of items onto the queue. The items are pushed contiguously, in order.
+     *
+     * @tparam Iterator Forward iterator type of the range.
+     *
+     * @param begin Iterator to the first item in the range.
+     * @param end Iterator to the item following the last item in the range.
+     */
+    template <typename Iterator>
+    void push(Iterator begin, Iterator end);
+
+    /**
+     * Pop an item from the queue. If the queue is empty, wait indefinitely for an item to be
+     * available.
+     *
+     * @param item Location to store the popped item.
+     */
+    void pop(T &item);
+
+    /**
+     * Pop an item from the queue. If the queue is empty, wait (at most) for the specified amount
+     * of time for an item to be available.
+     *
+     * @param item Location to store the popped item.
+     * @param duration The amount of time to wait.
+     *
+     * @return True if an object was popped in the given duration.
+     */
+    template <typename R, typename P>
+    bool pop(T &item, std::chrono::duration<R, P> duration);
+
+    /**
+     * Pop an item from the queue if one is available, without waiting.
+     *
+     * @param item Location to store the popped item.
+     *
+     * @return True if an object was popped.
+     */
+    bool try_pop(T &item);
+
+    /**
+     * @return True if the queue is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @return The number of items in the queue. Under concurrent access, this is only a snapshot.
+     */
+    size_type size() const;
+
+private:
+    /**
+     * A single slot in a segment. The slot is marked as written once a producer has finished
+     * constructing the item in the slot.
+     */
+    struct Slot
+    {
+        std::atomic_bool m_written {false};
+        alignas(T) unsigned char m_storage[sizeof(T)];
+
+        T *item()
+        {
+            return std::launder(static_cast<T *>(static_cast<void *>(m_storage)));
+        }
+    };
+
+    /**
+     * A fixed-size block of slots. The push index is the number of slots claimed by producers (and
+     * may overshoot the segment size), and the pop index is the number of slots claimed by
+     * consumers.
+     */
+    struct Segment
+    {
+        alignas(detail::s_cache_line_size) std::atomic<size_type> m_push_index {0};
+        alignas(detail::s_cache_line_size) std::atomic<size_type> m_pop_index {0};
+        alignas(detail::s_cache_line_size) std::atomic<Segment *> m_next {nullptr};
+        Segment *m_next_retired {nullptr};
+        size_type m_retired_epoch {0};
+
+        Slot m_slots[s_segment_size];
+    };
+
+    /**
+     * RAII helper to count a thread operating on the queue against the epoch in which the operation
+     * started. When the thread leaves the queue, it attempts to reclaim unlinked segments.
+     */
+    class OperationGuard
+    {
+    public:
+        explicit OperationGuard(const LockFreeQueue *queue);
+        ~OperationGuard();
+
+    private:
+        const LockFreeQueue *m_queue;
+        size_type m_epoch;
+    };
+
+    /**
+     * Move the tail of the queue past a full segment, appending a new segment if needed.
+     *
+     * @param tail The full segment.
+     */
+    void advance_tail(Segment *tail);
+
+    /**
+     * Store an unlinked segment to be freed once no thread may be accessing it.
+     *
+     * @param segments The list of segments to retire, linked by their retired pointers.
+     */
+    void retire(Segment *segments) const;
+
+    /**
+     * Advance the epoch if no operation which started in the previous epoch remains, and then free
+     * the retired segments which were unlinked at least two epochs ago.
+     */
+    void reclaim() const;
+
+    /**
+     * Destroy any items remaining in a segment and free the segment.
+     *
+     * @param segment The segment to free.
+     */
+    static void free_segment(Segment *segment);
+
+    alignas(detail::s_cache_line_size) std::atomic<Segment *> m_head;
+    alignas(detail::s_cache_line_size) std::atomic<Segment *> m_tail;
+
+    alignas(detail::s_cache_line_size) mutable std::atomic<size_type> m_epoch {0};
+    mutable std::atomic<size_type> m_active_operations[2] {};
+    mutable std::atomic<Segment *> m_retired {nullptr};
+
+    detail::WaitNotifier m_not_empty;
+};
+
+//==================================================================================================
+template <typename T>
+LockFreeQueue<T>::LockFreeQueue()
+{
+    Segment *segment = new Segment();
+
+    m_head.store(segment);
+    m_tail.store(segment);
+}
+
+//==================================================================================================
+template <typename T>
+LockFreeQueue<T>::~LockFreeQueue()
+{
+    for (Segment *segment = m_head.load(); segment != nullptr;)
+    {
+        Segment *next = segment->m_next.load();
+        free_segment(segment);
+        segment = next;
+    }
+
+    for (Segment *segment = m_retired.load(); segment != nullptr;)
+    {
+        Segment *next = segment->m_next_retired;
+        free_segment(segment);
+        segment = next;
+    }
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeQueue<T>::push(T &&item)
+{
+    {
+        OperationGuard guard(this);
+
+        while (true)
+        {
+            Segment *tail = m_tail.load(std::memory_order_acquire);
+            const size_type index = tail->m_push_index.fetch_add(1, std::memory_order_acq_rel);
+
+            if (index < s_segment_size)
+            {
+                Slot &slot = tail->m_slots[index];
+
+                ::new (static_cast<void *>(slot.m_storage)) T(std::move(item));
+                slot.m_written.store(true, std::memory_order_release);
+
+                break;
+            }
+
+            advance_tail(tail);
+        }
+    }
+
+    m_not_empty.notify_one();
+}
+
+//==================================================================================================
+template <typename T>
+template <typename Iterator>
+void LockFreeQueue<T>::push(Iterator begin, Iterator end)
+{
+    auto remaining = static_cast<size_type>(std::distance(begin, end));
+
+    if (remaining == 0)
+    {
+        return;
+    }
+
+    const size_type count = remaining;
+    {
+        OperationGuard guard(this);
+
+        while (true)
+        {
+            Segment *tail = m_tail.load(std::memory_order_acquire);
+            const size_type index =
+                tail->m_push_index.fetch_add(remaining, std::memory_order_acq_rel);
+
+            if (index < s_segment_size)
+            {
+                const size_type claimed = std::min(remaining, s_segment_size - index);
+
+                for (size_type i = index; i < index + claimed; ++i, ++begin)
+                {
+                    Slot &slot = tail->m_slots[i];
+
+                    ::new (static_cast<void *>(slot.m_storage)) T(std::move(*begin));
+                    slot.m_written.store(true, std::memory_order_release);
+                }
+
+                remaining -= claimed;
+
+                if (remaining == 0)
+                {
+                    break;
+                }
+            }
+
+            advance_tail(tail);
+        }
+    }
+
+    if (count == 1)
+    {
+        m_not_empty.notify_one();
+    }
+    else
+    {
+        m_not_empty.notify_all();
+    }
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeQueue<T>::pop(T &item)
+{
+    m_not_empty.wait(
+        [this, &item]()
+        {
+            return try_pop(item);
+        });
+}
+
+//==================================================================================================
+template <typename T>
+template <typename R, typename P>
+bool LockFreeQueue<T>::pop(T &item, std::chrono::duration<R, P> duration)
+{
+    return m_not_empty.wait_for(
+        [this, &item]()
+        {
+            return try_pop(item);
+        },
+        duration);
+}
+
+//==================================================================================================
+template <typename T>
+bool LockFreeQueue<T>::try_pop(T &item)
+{
+    OperationGuard guard(this);
+
+    while (true)
+    {
+        Segment *head = m_head.load(std::memory_order_acquire);
+
+        size_type index = head->m_pop_index.load(std::memory_order_acquire);
+        const size_type pushed =
+            std::min(head->m_push_index.load(std::memory_order_acquire), s_segment_size);
+
+        if (index < pushed)
+        {
+            if (!head->m_pop_index.compare_exchange_weak(index, index + 1))
+            {
+                continue;
+            }
+
+            Slot &slot = head->m_slots[index];
+
+            // The slot has been claimed by a producer, but the producer may not have finished
+            // constructing the item yet.
+            while (!slot.m_written.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            T *stored = slot.item();
+            item = std::move(*stored);
+            stored->~T();
+
+            return true;
+        }
+        else if (index < s_segment_size)
+        {
+            return false;
+        }
+
+        Segment *next = head->m_next.load(std::memory_order_acquire);
+
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        // Make sure the tail is moved off the exhausted segment before unlinking it, so that no
+        // thread may find the segment after it has been retired.
+        Segment *expected = head;
+        m_tail.compare_exchange_strong(expected, next);
+
+        if (m_head.compare_exchange_strong(head, next))
+        {
+            // The epoch is read after the segment was unlinked, so any thread which starts an
+            // operation in a later epoch cannot find the segment.
+            head->m_next_retired = nullptr;
+            head->m_retired_epoch = m_epoch.load();
+            retire(head);
+        }
+    }
+}
+
+//==================================================================================================
+template <typename T>
+bool LockFreeQueue<T>::empty() const
+{
+    return size() == 0;
+}
+
+//==================================================================================================
+template <typename T>
+auto LockFreeQueue<T>::size() const -> size_type
+{
+    OperationGuard guard(this);
+    size_type size = 0;
+
+    for (Segment *segment = m_head.load(std::memory_order_acquire); segment != nullptr;
+         segment = segment->m_next.load(std::memory_order_acquire))
+    {
+        const size_type popped = segment->m_pop_index.load(std::memory_order_acquire);
+        const size_type pushed =
+            std::min(segment->m_push_index.load(std::memory_order_acquire), s_segment_size);
+
+        size += (pushed > popped) ? (pushed - popped) : 0;
+    }
+
+    return size;
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeQueue<T>::advance_tail(Segment *tail)
+{
+    Segment *next = tail->m_next.load(std::memory_order_acquire);
+
+    if (next == nullptr)
+    {
+        Segment *segment = new Segment();
+
+        if (tail->m_next.compare_exchange_strong(next, segment))
+        {
+            next = segment;
+        }
+        else
+        {
+            delete segment;
+        }
+    }
+
+    m_tail.compare_exchange_strong(tail, next);
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeQueue<T>::retire(Segment *segments) const
+{
+    Segment *last = segments;
+
+    while (last->m_next_retired != nullptr)
+    {
+        last = last->m_next_retired;
+    }
+
+    Segment *retired = m_retired.load(std::memory_order_relaxed);
+
+    do
+    {
+        last->m_next_retired = retired;
+    } while (!m_retired.compare_exchange_weak(
+        retired,
+        segments,
+        std::memory_order_release,
+        std::memory_order_relaxed));
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeQueue<T>::reclaim() const
+{
+    size_type epoch = m_epoch.load();
+
+    // Operations which started in the previous epoch share a counter with the next epoch, so the
+    // epoch may only advance once all of those operations have completed.
+    if (m_active_operations[(epoch - 1) % 2].load() == 0)
+    {
+        if (m_epoch.compare_exchange_strong(epoch, epoch + 1))
+        {
+            ++epoch;
+        }
+    }
+
+    Segment *retired = m_retired.exchange(nullptr, std::memory_order_acquire);
+    Segment *pending = nullptr;
+
+    while (retired != nullptr)
+    {
+        Segment *next = retired->m_next_retired;
+
+        if ((retired->m_retired_epoch + 2) <= epoch)
+        {
+            free_segment(retired);
+        }
+        else
+        {
+            retired->m_next_retired = pending;
+            pending = retired;
+        }
+
+        retired = next;
+    }
+
+    if (pending != nullptr)
+    {
+        retire(pending);
+    }
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeQueue<T>::free_segment(Segment *segment)
+{
+    const size_type popped = segment->m_pop_index.load();
+    const size_type pushed = std::min(segment->m_push_index.load(), s_segment_size);
+
+    for (size_type index = popped; index < pushed; ++index)
+    {
+        segment->m_slots[index].item()->~T();
+    }
+
+    delete segment;
+}
+
+//==================================================================================================
+template <typename T>
+LockFreeQueue<T>::OperationGuard::OperationGuard(const LockFreeQueue *queue) : m_queue(queue)
+{
+    // If the epoch advanced before this operation was counted, the operation would be counted
+    // against an epoch which another thread may already consider complete, so retry.
+    while (true)
+    {
+        m_epoch = m_queue->m_epoch.load();
+        m_queue->m_active_operations[m_epoch % 2].fetch_add(1);
+
+        if (m_queue->m_epoch.load() == m_epoch)
+        {
+            break;
+        }
+
+        m_queue->m_active_operations[m_epoch % 2].fetch_sub(1);
+    }
+}
+
+//==================================================================================================
+template <typename T>
+LockFreeQueue<T>::OperationGuard::~OperationGuard()
+{
+    m_queue->m_active_operations[m_epoch % 2].fetch_sub(1);
+
+    if (m_queue->m_retired.load(std::memory_order_acquire) != nullptr)
+    {
+        m_queue->reclaim();
+    }
+}
+
+} // namespace fly
@@ -0,0 +1,399 @@
+#pragma once
+
+#include "fly/types/concurrency/detail/wait_notifier.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace fly {
+
+/**
+ * An unbounded, lock-free, multi-producer multi-consumer LIFO stack (a Treiber stack).
+ *
+ * Nodes are never returned to the system while the stack is alive. Instead, popped nodes are kept
+ * on an internal free-list to be reused by later pushes, so a thread may always safely read a node
+ * which was concurrently popped by another thread. Nodes are referred to by a 32-bit index rather
+ * than by a pointer; the top of both the stack and the free-list is stored as a 64-bit word holding
+ * that index and a 32-bit tag which is incremented by every successful update. This protects the
+ * stack from the ABA problem using only single-word atomic operations.
+ *
+ * Nodes are allocated in chunks of exponentially increasing size, so the stack only allocates
+ * memory when it grows beyond its largest-ever size. This makes the stack well suited for use as an
+ * object free-list on hot paths.
+ *
+ * This stack provides the same API as fly::ConcurrentStack. Pushing never blocks. Popping from an
+ * empty stack blocks (optionally with a timeout) until an item is available; use try_pop to never
+ * block.
+ */
+template <typename T>
+class LockFreeStack
+{
+public:
+    using size_type = std::size_t;
+    using value_type = T;
+
+    /**
+     * Constructor.
+     */
+    LockFreeStack() = default;
+
+    /**
+     * Destructor. Destroy any items remaining in the stack and free all nodes.
+     */
+    ~LockFreeStack();
+
+    LockFreeStack(const LockFreeStack &) = delete;
+    LockFreeStack &operator=(const LockFreeStack &) = delete;
+
+    /**
+     * Move an item onto the stack.
+     *
+     * @param item Item to push onto the stack.
+     */
+    void push(T &&item);
+
+    /**
+     * Pop an item from the stack. If the stack is empty, wait indefinitely for an item to be
+     * available.
+     *
+     * @param item Location to store the popped item.
+     */
+    void pop(T &item);
+
+    /**
+     * Pop an item from the stack. If the stack is empty, wait (at most) for the specified amount
+     * of time for an item to be available.
+     *
+     * @param item Location to store the popped item.
+     * @param duration The amount of time to wait.
+     *
+     * @return True if an object was popped in the given duration.
+     */
+    template <typename R, typename P>
+    bool pop(T &item, std::chrono::duration<R, P> duration);
+
+    /**
+     * Pop an item from the stack if one is available, without waiting.
+     *
+     * @param item Location to store the popped item.
+     *
+     * @return True if an object was popped.
+     */
+    bool try_pop(T &item);
+
+    /**
+     * @return True if the stack is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @return The number of items in the stack. Under concurrent access, this is only a snapshot.
+     */
+    size_type size() const;
+
+private:
+    static constexpr std::uint32_t s_null_index = 0xffffffff;
+
+    static constexpr std::size_t s_first_chunk_bits = 6;
+    static constexpr std::size_t s_first_chunk_size = 1 << s_first_chunk_bits;
+    static constexpr std::size_t s_chunk_count = 32 - s_first_chunk_bits;
+
+    /**
+     * A single node in the stack. The depth of a node is the size of the stack when the node was at
+     * the top of the stack.
+     */
+    struct Node
+    {
+        std::atomic<std::uint32_t> m_next {s_null_index};
+        std::atomic<std::uint32_t> m_depth {0};
+        alignas(T) unsigned char m_storage[sizeof(T)];
+
+        T *item()
+        {
+            return std::launder(static_cast<T *>(static_cast<void *>(m_storage)));
+        }
+    };
+
+    /**
+     * Pack a node index and a tag into a single word.
+     */
+    static std::uint64_t pack(std::uint32_t index, std::uint32_t tag);
+
+    /**
+     * Unpack the node index from a word.
+     */
+    static std::uint32_t index_of(std::uint64_t top);
+
+    /**
+     * Unpack the tag from a word.
+     */
+    static std::uint32_t tag_of(std::uint64_t top);
+
+    /**
+     * Push a node onto a list of nodes.
+     *
+     * @param top The top of the list.
+     * @param index The index of the node to push.
+     * @param track_depth Whether to track the depth of the list in its nodes.
+     */
+    void push_node(std::atomic<std::uint64_t> &top, std::uint32_t index, bool track_depth);
+
+    /**
+     * Pop a node from a list of nodes.
+     *
+     * @param top The top of the list.
+     *
+     * @return The index of the popped node, or the null index if the list was empty.
+     */
+    std::uint32_t pop_node(std::atomic<std::uint64_t> &top);
+
+    /**
+     * Retrieve a free node, either from the free-list or by allocating a new node.
+     *
+     * @return The index of the free node.
+     */
+    std::uint32_t acquire_node();
+
+    /**
+     * Find the node with a given index.
+     *
+     * @param index The index of the node.
+     *
+     * @return The node with the given index.
+     */
+    Node &node(std::uint32_t index) const;
+
+    alignas(detail::s_cache_line_size) std::atomic<std::uint64_t> m_top {pack(s_null_index, 0)};
+    alignas(detail::s_cache_line_size) std::atomic<std::uint64_t> m_free {pack(s_null_index, 0)};
+    alignas(detail::s_cache_line_size) std::atomic<std::uint32_t> m_allocated_nodes {0};
+
+    std::array<std::atomic<Node *>, s_chunk_count> m_chunks {};
+
+    detail::WaitNotifier m_not_empty;
+};
+
+//==================================================================================================
+template <typename T>
+LockFreeStack<T>::~LockFreeStack()
+{
+    for (std::uint32_t index = index_of(m_top.load()); index != s_null_index;)
+    {
+        Node &top = node(index);
+        index = top.m_next.load();
+
+        top.item()->~T();
+    }
+
+    for (auto &chunk : m_chunks)
+    {
+        delete[] chunk.load();
+    }
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeStack<T>::push(T &&item)
+{
+    const std::uint32_t index = acquire_node();
+    ::new (static_cast<void *>(node(index).m_storage)) T(std::move(item));
+
+    push_node(m_top, index, true);
+    m_not_empty.notify_one();
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeStack<T>::pop(T &item)
+{
+    m_not_empty.wait(
+        [this, &item]()
+        {
+            return try_pop(item);
+        });
+}
+
+//==================================================================================================
+template <typename T>
+template <typename R, typename P>
+bool LockFreeStack<T>::pop(T &item, std::chrono::duration<R, P> duration)
+{
+    return m_not_empty.wait_for(
+        [this, &item]()
+        {
+            return try_pop(item);
+        },
+        duration);
+}
+
+//==================================================================================================
+template <typename T>
+bool LockFreeStack<T>::try_pop(T &item)
+{
+    const std::uint32_t index = pop_node(m_top);
+
+    if (index == s_null_index)
+    {
+        return false;
+    }
+
+    T *stored = node(index).item();
+    item = std::move(*stored);
+    stored->~T();
+
+    push_node(m_free, index, false);
+    return true;
+}
+
+//==================================================================================================
+template <typename T>
+bool LockFreeStack<T>::empty() const
+{
+    return index_of(m_top.load(std::memory_order_acquire)) == s_null_index;
+}
+
+//==================================================================================================
+template <typename T>
+auto LockFreeStack<T>::size() const -> size_type
+{
+    const std::uint32_t index = index_of(m_top.load(std::memory_order_acquire));
+
+    if (index == s_null_index)
+    {
+        return 0;
+    }
+
+    return node(index).m_depth.load(std::memory_order_relaxed);
+}
+
+//==================================================================================================
+template <typename T>
+std::uint64_t LockFreeStack<T>::pack(std::uint32_t index, std::uint32_t tag)
+{
+    return (static_cast<std::uint64_t>(tag) << 32) | index;
+}
+
+//==================================================================================================
+template <typename T>
+std::uint32_t LockFreeStack<T>::index_of(std::uint64_t top)
+{
+    return static_cast<std::uint32_t>(top);
+}
+
+//==================================================================================================
+template <typename T>
+std::uint32_t LockFreeStack<T>::tag_of(std::uint64_t top)
+{
+    return static_cast<std::uint32_t>(top >> 32);
+}
+
+//==================================================================================================
+template <typename T>
+void LockFreeStack<T>::push_node(
+    std::atomic<std::uint64_t> &top,
+    std::uint32_t index,
+    bool track_depth)
+{
+    Node &pushed = node(index);
+    std::uint64_t current = top.load(std::memory_order_relaxed);
+
+    do
+    {
+        const std::uint32_t next = index_of(current);
+        pushed.m_next.store(next, std::memory_order_relaxed);
+
+        if (track_depth)
+        {
+            const std::uint32_t depth =
+                (next == s_null_index) ? 0 : node(next).m_depth.load(std::memory_order_relaxed);
+            pushed.m_depth.store(depth + 1, std::memory_order_relaxed);
+        }
+    } while (!top.compare_exchange_weak(
+        current,
+        pack(index, tag_of(current) + 1),
+        std::memory_order_release,
+        std::memory_order_relaxed));
+}
+
+//==================================================================================================
+template <typename T>
+std::uint32_t LockFreeStack<T>::pop_node(std::atomic<std::uint64_t> &top)
+{
+    std::uint64_t current = top.load(std::memory_order_acquire);
+    std::uint32_t index = s_null_index;
+
+    do
+    {
+        index = index_of(current);
+
+        if (index == s_null_index)
+        {
+            break;
+        }
+
+        // The node may be concurrently popped and reused by another thread, in which case the next
+        // index read here is stale. The tag ensures the exchange below fails in that case.
+        const std::uint32_t next = node(index).m_next.load(std::memory_order_relaxed);
+
+        if (top.compare_exchange_weak(
+                current,
+                pack(next, tag_of(current) + 1),
+                std::memory_order_acquire,
+                std::memory_order_acquire))
+        {
+            break;
+        }
+    } while (true);
+
+    return index;
+}
+
+//==================================================================================================
+template <typename T>
+std::uint32_t LockFreeStack<T>::acquire_node()
+{
+    if (const std::uint32_t index = pop_node(m_free); index != s_null_index)
+    {
+        return index;
+    }
+
+    const std::uint32_t index = m_allocated_nodes.fetch_add(1, std::memory_order_relaxed);
+
+    const std::size_t position = std::size_t(index) + s_first_chunk_size;
+    const std::size_t chunk = std::bit_width(position) - 1 - s_first_chunk_bits;
+
+    if (m_chunks[chunk].load(std::memory_order_acquire) == nullptr)
+    {
+        Node *nodes = new Node[s_first_chunk_size << chunk];
+        Node *expected = nullptr;
+
+        if (!m_chunks[chunk].compare_exchange_strong(
+                expected,
+                nodes,
+                std::memory_order_acq_rel,
+                std::memory_order_acquire))
+        {
+            delete[] nodes;
+        }
+    }
+
+    return index;
+}
+
+//==================================================================================================
+template <typename T>
+auto LockFreeStack<T>::node(std::uint32_t index) const -> Node &
+{
+    const std::size_t position = std::size_t(index) + s_first_chunk_size;
+    const std::size_t chunk = std::bit_width(position) - 1 - s_first_chunk_bits;
+    const std::size_t offset = position - (s_first_chunk_size << chunk);
+
+    return m_chunks[chunk].load(std::memory_order_acquire)[offset];
+}
+
+} // namespace fly
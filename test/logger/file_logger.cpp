@@ -1,10 +1,14 @@
 #include "test/util/path_util.hpp"
+#include "test/util/task_manager.hpp"
+#include "test/util/waitable_task_runner.hpp"
 
 #include "fly/coders/coder_config.hpp"
 #include "fly/coders/huffman/huffman_decoder.hpp"
 #include "fly/fly.hpp"
 #include "fly/logger/logger.hpp"
 #include "fly/logger/logger_config.hpp"
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
 #include "fly/types/numeric/literals.hpp"
 #include "fly/types/string/string.hpp"
 
@@ -14,11 +18,15 @@
 
 #include "catch2/catch.hpp"
 
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
+#include <future>
 #include <memory>
+#include <thread>
 #include <vector>
 
+using namespace std::chrono_literals;
 using namespace fly::literals::numeric_literals;
 
 namespace {
@@ -38,6 +46,26 @@ class MutableLoggerConfig : public fly::LoggerConfig
     {
         m_default_compress_log_files = false;
     }
+
+    void set_max_pending_log_compressions(std::uint32_t max_pending_log_compressions)
+    {
+        m_default_max_pending_log_compressions = max_pending_log_compressions;
+    }
+
+    void set_log_flush_size(std::uintmax_t log_flush_size)
+    {
+        m_default_log_flush_size = log_flush_size;
+    }
+
+    void set_log_flush_interval(std::chrono::milliseconds log_flush_interval)
+    {
+        m_default_log_flush_interval = log_flush_interval.count();
+    }
+
+    void disable_flush_on_error()
+    {
+        m_default_flush_on_error = false;
+    }
 };
 
 /**
@@ -104,6 +132,8 @@ CATCH_TEST_CASE("FileLogger", "[logger]")
     auto logger_config = std::make_shared<MutableLoggerConfig>();
     auto coder_config = std::make_shared<MutableCoderConfig>();
     fly::test::PathUtil::ScopedTempDirectory path;
+    fly::test::PathUtil::ScopedTempDirectory buffered_path;
+    fly::test::PathUtil::ScopedTempDirectory compression_path;
 
     auto logger = fly::Logger::create_file_logger("test", logger_config, coder_config, path());
 
@@ -273,4 +303,223 @@ CATCH_TEST_CASE("FileLogger", "[logger]")
         std::uintmax_t actual_size = std::filesystem::file_size(log_file);
         CATCH_CHECK(actual_size >= max_message_size);
     }
+
+    CATCH_SECTION("Buffered log points")
+    {
+        logger_config->set_log_flush_size(1_u64 << 9);
+        logger = fly::Logger::create_file_logger(
+            "buffered",
+            logger_config,
+            coder_config,
+            buffered_path());
+        CATCH_REQUIRE(logger);
+
+        std::filesystem::path log_file = find_log_file(buffered_path);
+        logger->debug("Debug Log");
+
+        CATCH_SECTION("Log points are not written until the flush size is reached")
+        {
+            CATCH_CHECK(fly::test::PathUtil::read_file(log_file).empty());
+
+            const std::string random =
+                fly::String::generate_random_string(logger_config->max_message_size());
+            logger->debug("%s", random);
+            logger->debug("%s", random);
+
+            const std::string contents = fly::test::PathUtil::read_file(log_file);
+            CATCH_CHECK(contents.find("Debug Log") != std::string::npos);
+            CATCH_CHECK(contents.find(random) != std::string::npos);
+        }
+
+        CATCH_SECTION("Error log points are written immediately")
+        {
+            logger->error("Error Log");
+
+            const std::string contents = fly::test::PathUtil::read_file(log_file);
+            CATCH_CHECK(contents.find("Debug Log") != std::string::npos);
+            CATCH_CHECK(contents.find("Error Log") != std::string::npos);
+        }
+
+        CATCH_SECTION("Buffered log points are written when the logger is destroyed")
+        {
+            logger.reset();
+
+            const std::string contents = fly::test::PathUtil::read_file(log_file);
+            CATCH_CHECK(contents.find("Debug Log") != std::string::npos);
+        }
+
+        CATCH_SECTION("Buffered log points are written before rotating the log file")
+        {
+            const std::string random =
+                fly::String::generate_random_string(logger_config->max_message_size());
+
+            for (std::uint32_t i = 0; (i < 100) && (log_file == find_log_file(buffered_path)); ++i)
+            {
+                logger->debug("%s", random);
+            }
+
+            CATCH_REQUIRE(log_file != find_log_file(buffered_path));
+
+            std::filesystem::path compressed_path = log_file;
+            compressed_path.replace_extension(".log.enc");
+            CATCH_REQUIRE(std::filesystem::exists(compressed_path));
+
+            fly::HuffmanDecoder decoder;
+            CATCH_REQUIRE(decoder.decode_file(compressed_path, log_file));
+
+            const std::uintmax_t actual_size = std::filesystem::file_size(log_file);
+            CATCH_CHECK(actual_size > logger_config->max_log_file_size());
+        }
+    }
+
+    CATCH_SECTION("Error log points are buffered when flushing on error is disabled")
+    {
+        logger_config->set_log_flush_size(1_u64 << 9);
+        logger_config->disable_flush_on_error();
+
+        logger = fly::Logger::create_file_logger(
+            "buffered",
+            logger_config,
+            coder_config,
+            buffered_path());
+        CATCH_REQUIRE(logger);
+
+        logger->error("Error Log");
+        CATCH_CHECK(fly::test::PathUtil::read_file(find_log_file(buffered_path)).empty());
+    }
+
+    CATCH_SECTION("Buffered log points are written once the flush interval has elapsed")
+    {
+        logger_config->set_log_flush_size(1_u64 << 9);
+        logger_config->set_log_flush_interval(10ms);
+
+        logger = fly::Logger::create_file_logger(
+            "buffered",
+            logger_config,
+            coder_config,
+            buffered_path());
+        CATCH_REQUIRE(logger);
+
+        std::filesystem::path log_file = find_log_file(buffered_path);
+
+        logger->debug("First Log");
+        CATCH_CHECK(fly::test::PathUtil::read_file(log_file).empty());
+
+        std::this_thread::sleep_for(20ms);
+        logger->debug("Second Log");
+
+        const std::string contents = fly::test::PathUtil::read_file(log_file);
+        CATCH_CHECK(contents.find("First Log") != std::string::npos);
+        CATCH_CHECK(contents.find("Second Log") != std::string::npos);
+    }
+
+    CATCH_SECTION("Buffered log points are written once the flush interval has elapsed while idle")
+    {
+        logger_config->set_log_flush_size(1_u64 << 9);
+        logger_config->set_log_flush_interval(10ms);
+
+        auto task_runner = fly::test::task_manager()
+                               ->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        logger = fly::Logger::create_file_logger(
+            "buffered",
+            task_runner,
+            logger_config,
+            coder_config,
+            buffered_path());
+        CATCH_REQUIRE(logger);
+
+        std::filesystem::path log_file = find_log_file(buffered_path);
+
+        // Wait for the log point to be streamed, and then for the scheduled flush.
+        logger->debug("Idle Log");
+        task_runner->wait_for_task_to_complete("logger.cpp");
+        task_runner->wait_for_task_to_complete("logger.cpp");
+
+        const std::string contents = fly::test::PathUtil::read_file(log_file);
+        CATCH_CHECK(contents.find("Idle Log") != std::string::npos);
+    }
+
+    CATCH_SECTION("Rotated log files are compressed on the compression task runner")
+    {
+        auto task_runner = fly::test::task_manager()
+                               ->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        logger = fly::Logger::create_file_logger(
+            "compressed",
+            logger_config,
+            coder_config,
+            compression_path(),
+            task_runner);
+        CATCH_REQUIRE(logger);
+
+        const std::string random =
+            fly::String::generate_random_string(logger_config->max_message_size());
+
+        auto rotate_log_file = [&]()
+        {
+            const std::filesystem::path log_file = find_log_file(compression_path);
+
+            for (std::uint32_t i = 0; (i < 100) && (log_file == find_log_file(compression_path));
+                 ++i)
+            {
+                logger->debug("%s", random);
+            }
+
+            return log_file;
+        };
+
+        auto is_compressed = [](const std::filesystem::path &log_file)
+        {
+            std::filesystem::path compressed_log_file = log_file;
+            compressed_log_file.replace_extension(".log.enc");
+
+            return !std::filesystem::exists(log_file) &&
+                std::filesystem::exists(compressed_log_file);
+        };
+
+        // Block the compression task runner so that rotated log files remain pending.
+        std::promise<void> blocker;
+        task_runner->post_task(
+            FROM_HERE,
+            [future = blocker.get_future()]() mutable
+            {
+                future.wait();
+            });
+
+        CATCH_SECTION("The sink continues streaming to the new log file while compressing")
+        {
+            const std::filesystem::path log_file = rotate_log_file();
+            const bool pending = std::filesystem::exists(log_file) && !is_compressed(log_file);
+
+            logger->debug("Debug Log");
+            const std::string contents =
+                fly::test::PathUtil::read_file(find_log_file(compression_path));
+
+            blocker.set_value();
+            task_runner->wait_for_task_to_complete("file_sink.cpp");
+
+            CATCH_CHECK(pending);
+            CATCH_CHECK(contents.find("Debug Log") != std::string::npos);
+            CATCH_CHECK(is_compressed(log_file));
+        }
+
+        CATCH_SECTION("Rotated log files are compressed synchronously once the backlog is full")
+        {
+            logger_config->set_max_pending_log_compressions(1);
+
+            const std::filesystem::path log_file1 = rotate_log_file();
+            const std::filesystem::path log_file2 = rotate_log_file();
+
+            const bool pending = !is_compressed(log_file1);
+            const bool compressed = is_compressed(log_file2);
+
+            blocker.set_value();
+            task_runner->wait_for_task_to_complete("file_sink.cpp");
+
+            CATCH_CHECK(pending);
+            CATCH_CHECK(compressed);
+            CATCH_CHECK(is_compressed(log_file1));
+        }
+    }
 }
@@ -0,0 +1,289 @@
+#include "fly/logger/detail/log_buffer.hpp"
+
+#include "fly/logger/logger_config.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+fly::detail::BufferedLog make_log(std::string message)
+{
+    return {
+        fly::Log::Level::Info,
+        {},
+        fly::detail::LogRecord(std::move(message)),
+        std::chrono::high_resolution_clock::now()};
+}
+
+void discard(fly::detail::BufferedLog &&)
+{
+}
+
+} // namespace
+
+CATCH_TEST_CASE("LogRingBuffer", "[logger]")
+{
+    CATCH_SECTION("Capacity is rounded up to a power of two")
+    {
+        CATCH_CHECK(fly::detail::LogRingBuffer(0).capacity() == 2);
+        CATCH_CHECK(fly::detail::LogRingBuffer(5).capacity() == 8);
+        CATCH_CHECK(fly::detail::LogRingBuffer(16).capacity() == 16);
+    }
+
+    CATCH_SECTION("Empty ring buffers have no front log point")
+    {
+        fly::detail::LogRingBuffer buffer(4);
+        CATCH_CHECK(buffer.front() == nullptr);
+        CATCH_CHECK(buffer.size() == 0);
+    }
+
+    CATCH_SECTION("Log points are popped in the order they were pushed")
+    {
+        fly::detail::LogRingBuffer buffer(4);
+
+        for (std::uint32_t i = 0; i < 10; ++i)
+        {
+            CATCH_REQUIRE(buffer.try_push(make_log(std::to_string(i))));
+            CATCH_REQUIRE(buffer.try_push(make_log(std::to_string(i + 100))));
+            CATCH_CHECK(buffer.size() == 2);
+
+            CATCH_REQUIRE(buffer.front() != nullptr);
+            CATCH_CHECK(buffer.front()->m_record.format() == std::to_string(i));
+            buffer.pop_front();
+
+            CATCH_REQUIRE(buffer.front() != nullptr);
+            CATCH_CHECK(buffer.front()->m_record.format() == std::to_string(i + 100));
+            buffer.pop_front();
+
+            CATCH_CHECK(buffer.front() == nullptr);
+        }
+    }
+
+    CATCH_SECTION("Full ring buffers reject log points")
+    {
+        fly::detail::LogRingBuffer buffer(4);
+
+        for (std::uint32_t i = 0; i < buffer.capacity(); ++i)
+        {
+            CATCH_CHECK(buffer.try_push(make_log(std::to_string(i))));
+        }
+
+        auto log = make_log("rejected");
+        CATCH_CHECK_FALSE(buffer.try_push(std::move(log)));
+        CATCH_CHECK(log.m_record.format() == "rejected");
+
+        CATCH_REQUIRE(buffer.front() != nullptr);
+        buffer.pop_front();
+        CATCH_CHECK(buffer.try_push(make_log("accepted")));
+    }
+}
+
+CATCH_TEST_CASE("ThreadLogBuffers", "[logger]")
+{
+    CATCH_SECTION("Log points from multiple threads are merged in the order they were made")
+    {
+        fly::detail::ThreadLogBuffers buffers(1024, fly::LogOverflowPolicy::Block);
+
+        static constexpr std::uint32_t s_thread_count = 4;
+        static constexpr std::uint32_t s_log_count = 100;
+
+        std::vector<std::thread> threads;
+
+        for (std::uint32_t i = 0; i < s_thread_count; ++i)
+        {
+            threads.emplace_back(
+                [&buffers, i]()
+                {
+                    for (std::uint32_t j = 0; j < s_log_count; ++j)
+                    {
+                        buffers.push(make_log(std::to_string(i)), discard);
+                    }
+                });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        std::vector<std::chrono::high_resolution_clock::time_point> times;
+
+        buffers.drain(
+            [&times](fly::detail::BufferedLog &&log)
+            {
+                times.push_back(log.m_time);
+            });
+
+        CATCH_CHECK(times.size() == (s_thread_count * s_log_count));
+        CATCH_CHECK(std::is_sorted(times.begin(), times.end()));
+    }
+
+    CATCH_SECTION("Log points made at the same time are merged in the order they were pushed")
+    {
+        fly::detail::ThreadLogBuffers buffers(16, fly::LogOverflowPolicy::Block);
+        const auto time = std::chrono::high_resolution_clock::now();
+
+        auto push = [&buffers, time](std::uint32_t index)
+        {
+            auto log = make_log(std::to_string(index));
+            log.m_time = time;
+
+            buffers.push(std::move(log), discard);
+        };
+
+        // Alternate between the calling thread and other threads, so that the log points with equal
+        // times are spread across ring buffers.
+        for (std::uint32_t i = 0; i < 6; i += 2)
+        {
+            push(i);
+            std::thread(push, i + 1).join();
+        }
+
+        std::vector<std::string> messages;
+
+        buffers.drain(
+            [&messages](fly::detail::BufferedLog &&log)
+            {
+                messages.push_back(log.m_record.format());
+            });
+
+        CATCH_CHECK(messages == std::vector<std::string> {"0", "1", "2", "3", "4", "5"});
+    }
+
+    CATCH_SECTION("Each drain only consumes log points which were already buffered")
+    {
+        fly::detail::ThreadLogBuffers buffers(16, fly::LogOverflowPolicy::Block);
+        std::uint32_t drained = 0;
+
+        buffers.push(make_log("first"), discard);
+        buffers.push(make_log("second"), discard);
+
+        buffers.drain(
+            [&buffers, &drained](fly::detail::BufferedLog &&)
+            {
+                buffers.push(make_log("during"), discard);
+                ++drained;
+            });
+        CATCH_CHECK(drained == 2);
+
+        drained = 0;
+
+        buffers.drain(
+            [&drained](fly::detail::BufferedLog &&log)
+            {
+                CATCH_CHECK(log.m_record.format() == "during");
+                ++drained;
+            });
+        CATCH_CHECK(drained == 2);
+    }
+
+    CATCH_SECTION("Log points are dropped when the drop policy is used")
+    {
+        fly::detail::ThreadLogBuffers buffers(4, fly::LogOverflowPolicy::Drop);
+
+        for (std::uint32_t i = 0; i < 4; ++i)
+        {
+            CATCH_CHECK(buffers.push(make_log(std::to_string(i)), discard));
+        }
+
+        CATCH_CHECK_FALSE(buffers.push(make_log("dropped"), discard));
+        CATCH_CHECK_FALSE(buffers.push(make_log("dropped"), discard));
+        CATCH_CHECK(buffers.dropped() == 2);
+
+        std::uint32_t drained = 0;
+
+        buffers.drain(
+            [&drained](fly::detail::BufferedLog &&log)
+            {
+                CATCH_CHECK(log.m_record.format() == std::to_string(drained++));
+            });
+        CATCH_CHECK(drained == 4);
+    }
+
+    CATCH_SECTION("Threads blocked by the block policy resume once space is drained")
+    {
+        fly::detail::ThreadLogBuffers buffers(2, fly::LogOverflowPolicy::Block);
+        std::atomic_bool pushed {false};
+        std::atomic<std::uint32_t> drained {0};
+
+        // Both threads may drain the ring buffers, but never concurrently.
+        auto consumer = [&drained](fly::detail::BufferedLog &&log)
+        {
+            CATCH_CHECK(log.m_record.format() == std::to_string(drained.fetch_add(1)));
+        };
+
+        std::thread thread(
+            [&buffers, &pushed, &consumer]()
+            {
+                for (std::uint32_t i = 0; i < 3; ++i)
+                {
+                    buffers.push(make_log(std::to_string(i)), consumer);
+                }
+
+                pushed.store(true);
+            });
+
+        while (!pushed.load() || (drained.load() < 3))
+        {
+            buffers.drain(consumer);
+        }
+
+        thread.join();
+
+        CATCH_CHECK(drained.load() == 3);
+        CATCH_CHECK(buffers.dropped() == 0);
+    }
+
+    CATCH_SECTION("Threads blocked by the block policy drain the ring buffers themselves")
+    {
+        fly::detail::ThreadLogBuffers buffers(2, fly::LogOverflowPolicy::Block);
+        std::uint32_t drained = 0;
+
+        auto consumer = [&drained](fly::detail::BufferedLog &&log)
+        {
+            CATCH_CHECK(log.m_record.format() == std::to_string(drained++));
+        };
+
+        for (std::uint32_t i = 0; i < 5; ++i)
+        {
+            CATCH_CHECK(buffers.push(make_log(std::to_string(i)), consumer));
+        }
+
+        CATCH_CHECK(drained == 4);
+
+        buffers.drain(consumer);
+        CATCH_CHECK(drained == 5);
+        CATCH_CHECK(buffers.dropped() == 0);
+    }
+
+    CATCH_SECTION("Threads which are draining the ring buffers drop log points to a full buffer")
+    {
+        fly::detail::ThreadLogBuffers buffers(2, fly::LogOverflowPolicy::Block);
+
+        CATCH_CHECK(buffers.push(make_log("first"), discard));
+        CATCH_CHECK(buffers.push(make_log("second"), discard));
+
+        std::uint32_t drained = 0;
+
+        buffers.drain(
+            [&buffers, &drained](fly::detail::BufferedLog &&)
+            {
+                // The log point being consumed has not yet been popped, so the buffer is full.
+                if (drained++ == 0)
+                {
+                    CATCH_CHECK_FALSE(buffers.push(make_log("dropped"), discard));
+                }
+            });
+
+        CATCH_CHECK(drained == 2);
+        CATCH_CHECK(buffers.dropped() == 1);
+    }
+}
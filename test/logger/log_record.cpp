@@ -0,0 +1,120 @@
+#include "fly/logger/detail/log_record.hpp"
+
+#include "fly/types/numeric/literals.hpp"
+#include "fly/types/string/string.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <string>
+#include <string_view>
+
+using namespace fly::literals::numeric_literals;
+
+CATCH_TEST_CASE("LogRecord", "[logger]")
+{
+    CATCH_SECTION("Formatted records hold their message")
+    {
+        fly::detail::LogRecord record(std::string("Formatted message"));
+        CATCH_CHECK_FALSE(record.is_deferred());
+        CATCH_CHECK(record.format() == "Formatted message");
+    }
+
+    CATCH_SECTION("Deferred records without arguments format the format string")
+    {
+        fly::detail::LogRecord record("Deferred message %%");
+        CATCH_CHECK(record.is_deferred());
+        CATCH_CHECK(record.format() == fly::String::format("Deferred message %%"));
+    }
+
+    CATCH_SECTION("Deferred records format arithmetic arguments")
+    {
+        const char *format = "%d %u %x %f %s %c";
+
+        fly::detail::LogRecord record(format, -12, 34_u32, 255, 3.14, true, 'a');
+        const std::string expected = fly::String::format(format, -12, 34_u32, 255, 3.14, true, 'a');
+
+        CATCH_CHECK(record.is_deferred());
+        CATCH_CHECK(record.format() == expected);
+    }
+
+    CATCH_SECTION("Deferred records copy string-like arguments")
+    {
+        const char *format = "%s %s %s %s";
+
+        std::string string("string");
+        std::string_view view("view\n");
+        char buffer[] = "buffer";
+        char *pointer = buffer;
+        const char *null_string = nullptr;
+
+        fly::detail::LogRecord record(format, string, view, pointer, null_string);
+        const std::string expected = fly::String::format(format, string, view, buffer, "");
+
+        string = "changed";
+        buffer[0] = 'B';
+
+        CATCH_CHECK(record.is_deferred());
+        CATCH_CHECK(record.format() == expected);
+    }
+
+    CATCH_SECTION("Deferred records copy the format string")
+    {
+        std::string format("%d %s");
+
+        fly::detail::LogRecord record(format.c_str(), 1, std::string("copied"));
+        format.assign(format.size(), 'X');
+        format.shrink_to_fit();
+
+        CATCH_CHECK(record.is_deferred());
+        CATCH_CHECK(record.format() == "1 copied");
+    }
+
+    CATCH_SECTION("Deferred records may be moved")
+    {
+        fly::detail::LogRecord record1("%d %s", 1, std::string("moved"));
+        fly::detail::LogRecord record2(std::move(record1));
+
+        CATCH_CHECK(record2.format() == "1 moved");
+    }
+
+    CATCH_SECTION("Deferred records hold log points which do not fit in the inline storage")
+    {
+        const std::string format = std::string(200, 'f') + " %s %d";
+        const std::string argument(200, 'a');
+
+        fly::detail::LogRecord record1(format.c_str(), argument, 1);
+        fly::detail::LogRecord record2("%s", argument);
+
+        fly::detail::LogRecord moved1(std::move(record1));
+        fly::detail::LogRecord moved2(std::move(record2));
+
+        CATCH_CHECK(moved1.is_deferred());
+        CATCH_CHECK(moved1.format() == fly::String::format(format.c_str(), argument, 1));
+
+        CATCH_CHECK(moved2.is_deferred());
+        CATCH_CHECK(moved2.format() == argument);
+    }
+
+    CATCH_SECTION("Deferred records copy array arguments as strings")
+    {
+        char buffer[] = "buffer";
+
+        fly::detail::LogRecord record("%s %s", buffer, "literal");
+        buffer[0] = 'B';
+
+        CATCH_CHECK(record.format() == "buffer literal");
+    }
+
+    CATCH_SECTION("Only arithmetic and narrow string-like arguments may be deferred")
+    {
+        CATCH_CHECK(fly::detail::LogRecord::is_deferrable_v<>);
+        CATCH_CHECK(fly::detail::LogRecord::is_deferrable_v<int, double, bool, char>);
+        CATCH_CHECK(fly::detail::LogRecord::is_deferrable_v<std::string, std::string_view>);
+        CATCH_CHECK(fly::detail::LogRecord::is_deferrable_v<const char *, char *, char[4]>);
+        CATCH_CHECK(fly::detail::LogRecord::is_deferrable_v<const char[8], const char (&)[8]>);
+
+        CATCH_CHECK_FALSE(fly::detail::LogRecord::is_deferrable_v<int *>);
+        CATCH_CHECK_FALSE(fly::detail::LogRecord::is_deferrable_v<std::wstring>);
+        CATCH_CHECK_FALSE(fly::detail::LogRecord::is_deferrable_v<int, std::u16string>);
+    }
+}
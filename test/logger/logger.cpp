@@ -12,15 +12,47 @@
 
 #include "catch2/catch.hpp"
 
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+using namespace std::chrono_literals;
 using namespace fly::literals::numeric_literals;
 
 namespace {
 
+/**
+ * Subclass of the logger config to change the minimum log level.
+ */
+class MutableLoggerConfig : public fly::LoggerConfig
+{
+public:
+    void set_min_log_level(std::string level)
+    {
+        m_default_min_log_level = std::move(level);
+    }
+
+    void set_defer_log_formatting(bool defer_log_formatting)
+    {
+        m_default_defer_log_formatting = defer_log_formatting;
+    }
+
+    void set_log_buffer_size(std::uint32_t log_buffer_size)
+    {
+        m_default_log_buffer_size = log_buffer_size;
+    }
+
+    void set_log_buffer_overflow_policy(std::string policy)
+    {
+        m_default_log_buffer_overflow_policy = std::move(policy);
+    }
+};
+
 /**
  * Test log sink to store received logs in a queue for verification.
  */
@@ -96,11 +128,46 @@ class FailStreamSink : public QueueSink
     }
 };
 
+/**
+ * Test log sink to make log points to its own logger while streaming.
+ */
+class ReentrantSink : public QueueSink
+{
+public:
+    ReentrantSink(fly::ConcurrentQueue<fly::Log> &logs, std::uint32_t reentrant_logs) :
+        QueueSink(logs),
+        m_reentrant_logs(reentrant_logs)
+    {
+    }
+
+    void set_logger(fly::Logger *logger)
+    {
+        m_logger = logger;
+    }
+
+    bool stream(fly::Log &&log) override
+    {
+        const bool reenter = log.m_message == "Outer Log";
+        const bool streamed = QueueSink::stream(std::move(log));
+
+        for (std::uint32_t i = 0; reenter && (i < m_reentrant_logs); ++i)
+        {
+            m_logger->info("Inner Log: %u", i);
+        }
+
+        return streamed;
+    }
+
+private:
+    const std::uint32_t m_reentrant_logs;
+    fly::Logger *m_logger {nullptr};
+};
+
 } // namespace
 
 CATCH_TEST_CASE("Logger", "[logger]")
 {
-    auto logger_config = std::make_shared<fly::LoggerConfig>();
+    auto logger_config = std::make_shared<MutableLoggerConfig>();
     fly::ConcurrentQueue<fly::Log> received_logs;
 
     auto validate_log_points = [&](fly::Log::Level expected_level,
@@ -190,8 +257,11 @@ CATCH_TEST_CASE("Logger", "[logger]")
 
     CATCH_SECTION("Log points")
     {
-        // Run all of the log point tests with both synchronous and asynchronous loggers.
+        // Run all of the log point tests with both synchronous and asynchronous loggers, with both
+        // immediate and deferred formatting, and with and without per-thread log buffers.
         const bool synchronous_logger = GENERATE(true, false);
+        logger_config->set_defer_log_formatting(GENERATE(false, true));
+        logger_config->set_log_buffer_size(GENERATE(0_u32, 8_u32));
 
         auto task_manager = std::make_shared<fly::TaskManager>(1);
         CATCH_REQUIRE(task_manager->start());
@@ -247,10 +317,16 @@ CATCH_TEST_CASE("Logger", "[logger]")
 
             CATCH_SECTION("With macro invocation")
             {
-                LOGD("Debug Log");
-                LOGD("Debug Log: %d", 123);
-
-                validate_log_points(fly::Log::Level::Debug, __FUNCTION__, std::move(expectations));
+                if constexpr (fly::Logger::is_compiled(fly::Log::Level::Debug))
+                {
+                    LOGD("Debug Log");
+                    LOGD("Debug Log: %d", 123);
+
+                    validate_log_points(
+                        fly::Log::Level::Debug,
+                        __FUNCTION__,
+                        std::move(expectations));
+                }
             }
         }
 
@@ -361,6 +437,278 @@ CATCH_TEST_CASE("Logger", "[logger]")
         fly::Logger::set_default_logger(nullptr);
     }
 
+    CATCH_SECTION("Log points below the minimum log level are discarded")
+    {
+        logger_config->set_min_log_level("warn");
+
+        auto sink = std::make_unique<QueueSink>(received_logs);
+        auto logger = fly::Logger::create_logger("test", logger_config, std::move(sink));
+        CATCH_REQUIRE(logger);
+        CATCH_CHECK(logger->min_level() == fly::Log::Level::Warn);
+
+        CATCH_CHECK_FALSE(logger->is_enabled(fly::Log::Level::Debug));
+        CATCH_CHECK_FALSE(logger->is_enabled(fly::Log::Level::Info));
+        CATCH_CHECK(logger->is_enabled(fly::Log::Level::Warn));
+        CATCH_CHECK(logger->is_enabled(fly::Log::Level::Error));
+
+        logger->debug("Debug Log");
+        logger->info("Info Log");
+        logger->warn("Warning Log");
+        logger->error({__FILE__, __FUNCTION__, 123_u32}, "Error Log");
+
+        fly::Log log;
+        CATCH_REQUIRE(received_logs.pop(log, 0ms));
+        CATCH_CHECK(log.m_level == fly::Log::Level::Warn);
+        CATCH_REQUIRE(received_logs.pop(log, 0ms));
+        CATCH_CHECK(log.m_level == fly::Log::Level::Error);
+        CATCH_CHECK(received_logs.empty());
+
+        CATCH_SECTION("Arguments to macro invocations are not evaluated")
+        {
+            fly::Logger::set_default_logger(logger);
+            std::uint32_t evaluations = 0;
+
+            auto evaluate = [&evaluations]()
+            {
+                return ++evaluations;
+            };
+
+            LOGD("Debug Log: %d", evaluate());
+            LOGI("Info Log: %d", evaluate());
+            CATCH_CHECK(evaluations == 0);
+            CATCH_CHECK(received_logs.empty());
+
+            LOGW("Warning Log: %d", evaluate());
+            CATCH_CHECK(evaluations == 1);
+            CATCH_CHECK(received_logs.size() == 1);
+
+            fly::Logger::set_default_logger(nullptr);
+        }
+
+        CATCH_SECTION("Minimum log level may be changed after creation")
+        {
+            logger->set_min_level(fly::Log::Level::Debug);
+            CATCH_CHECK(logger->min_level() == fly::Log::Level::Debug);
+
+            logger->debug("Debug Log");
+            CATCH_REQUIRE(received_logs.pop(log, 0ms));
+            CATCH_CHECK(log.m_level == fly::Log::Level::Debug);
+
+            logger->set_min_level(fly::Log::Level::Error);
+            logger->warn("Warning Log");
+            CATCH_CHECK(received_logs.empty());
+        }
+    }
+
+    CATCH_SECTION("Asynchronous loggers may defer formatting log points")
+    {
+        logger_config->set_defer_log_formatting(true);
+
+        auto task_runner =
+            fly::test::task_manager()->create_task_runner<fly::SequencedTaskRunner>();
+        auto sink = std::make_unique<QueueSink>(received_logs);
+
+        auto logger =
+            fly::Logger::create_logger("test", task_runner, logger_config, std::move(sink));
+        CATCH_REQUIRE(logger);
+
+        std::string name("name");
+        char array[] = "array";
+
+        std::string format("Temporary Log: %d");
+
+        logger->info("Deferred Log: %d %f %s %s %s", 123, 4.5, true, name, array);
+        logger->info("Immediate Log: %s", std::wstring(L"wide"));
+        logger->info(format.c_str(), 456);
+
+        name = "changed";
+        array[0] = 'A';
+        format.assign(format.size(), 'X');
+
+        validate_log_points(
+            fly::Log::Level::Info,
+            nullptr,
+            {"Deferred Log: 123 4.500000 true name array",
+             "Immediate Log: wide",
+             "Temporary Log: 456"});
+    }
+
+    CATCH_SECTION("Asynchronous loggers may buffer log points per thread")
+    {
+        logger_config->set_log_buffer_size(4);
+
+        auto task_runner =
+            fly::test::task_manager()->create_task_runner<fly::SequencedTaskRunner>();
+        auto sink = std::make_unique<QueueSink>(received_logs);
+
+        auto logger =
+            fly::Logger::create_logger("test", task_runner, logger_config, std::move(sink));
+        CATCH_REQUIRE(logger);
+
+        CATCH_SECTION("Log points from multiple threads are all received")
+        {
+            static constexpr std::uint32_t s_thread_count = 4;
+            static constexpr std::uint32_t s_log_count = 50;
+
+            std::vector<std::thread> threads;
+
+            for (std::uint32_t i = 0; i < s_thread_count; ++i)
+            {
+                threads.emplace_back(
+                    [&logger, i]()
+                    {
+                        for (std::uint32_t j = 0; j < s_log_count; ++j)
+                        {
+                            logger->info("%u %u", i, j);
+                        }
+                    });
+            }
+
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+
+            std::vector<std::uint32_t> next_log(s_thread_count, 0);
+
+            for (std::uint32_t i = 0; i < (s_thread_count * s_log_count); ++i)
+            {
+                fly::Log log;
+                CATCH_REQUIRE(received_logs.pop(log, 5s));
+                CATCH_CHECK(log.m_index == i);
+
+                // Log points from each thread are received in the order that thread made them.
+                const auto parts = fly::String::split(log.m_message, ' ');
+                CATCH_REQUIRE(parts.size() == 2);
+
+                const auto thread = fly::String::convert<std::uint32_t>(parts[0]);
+                const auto index = fly::String::convert<std::uint32_t>(parts[1]);
+                CATCH_REQUIRE(thread);
+                CATCH_REQUIRE(index);
+
+                CATCH_CHECK(*index == next_log[*thread]++);
+            }
+        }
+
+        CATCH_SECTION("Log points are buffered from a worker of a single-threaded task manager")
+        {
+            logger_config->set_log_buffer_size(2);
+
+            auto local_manager = std::make_shared<fly::TaskManager>(1);
+            CATCH_REQUIRE(local_manager->start());
+
+            auto local_runner = local_manager->create_task_runner<fly::SequencedTaskRunner>();
+            sink = std::make_unique<QueueSink>(received_logs);
+
+            logger =
+                fly::Logger::create_logger("single", local_runner, logger_config, std::move(sink));
+            CATCH_REQUIRE(logger);
+
+            // The only worker fills the buffer, so it must make space without relying on the
+            // logger's sequence, which cannot run until the producing task is complete.
+            auto producer = local_manager->create_task_runner<fly::ParallelTaskRunner>();
+            std::promise<void> logged;
+
+            producer->post_task(
+                FROM_HERE,
+                [&logger, &logged]()
+                {
+                    for (std::uint32_t i = 0; i < 20; ++i)
+                    {
+                        logger->info("Buffered Log: %u", i);
+                    }
+
+                    logged.set_value();
+                });
+
+            CATCH_CHECK(logged.get_future().wait_for(5s) == std::future_status::ready);
+
+            for (std::uint32_t i = 0; i < 20; ++i)
+            {
+                fly::Log log;
+                CATCH_REQUIRE(received_logs.pop(log, 5s));
+                CATCH_CHECK(log.m_message == fly::String::format("Buffered Log: %u", i));
+            }
+
+            logger.reset();
+            CATCH_CHECK(local_manager->stop());
+        }
+
+        CATCH_SECTION("Log points made by the log sink do not block the logger's sequence")
+        {
+            logger_config->set_log_buffer_size(2);
+
+            auto reentrant_sink = std::make_unique<ReentrantSink>(received_logs, 4);
+            ReentrantSink *reentrant_sink_ptr = reentrant_sink.get();
+
+            logger = fly::Logger::create_logger(
+                "reentrant",
+                task_runner,
+                logger_config,
+                std::move(reentrant_sink));
+            CATCH_REQUIRE(logger);
+
+            reentrant_sink_ptr->set_logger(logger.get());
+            logger->info("Outer Log");
+
+            // The sink fills the draining thread's buffer, and the remaining log points it makes
+            // cannot be drained while it is streaming, so they are dropped.
+            std::vector<std::string> expectations = {"Outer Log", "Inner Log: 0", "Inner Log: 1"};
+
+            for (const auto &expectation : expectations)
+            {
+                fly::Log log;
+                CATCH_REQUIRE(received_logs.pop(log, 5s));
+                CATCH_CHECK(log.m_message == expectation);
+            }
+
+            fly::Log log;
+            CATCH_CHECK_FALSE(received_logs.pop(log, 10ms));
+        }
+
+        CATCH_SECTION("Log points are dropped while the buffer is full")
+        {
+            logger_config->set_log_buffer_overflow_policy("drop");
+            sink = std::make_unique<QueueSink>(received_logs);
+
+            logger =
+                fly::Logger::create_logger("drop", task_runner, logger_config, std::move(sink));
+            CATCH_REQUIRE(logger);
+
+            // Block the logger's sequence so that its buffer cannot be drained.
+            std::promise<void> blocker;
+            task_runner->post_task(
+                FROM_HERE,
+                [future = blocker.get_future()]() mutable
+                {
+                    future.wait();
+                });
+
+            for (std::uint32_t i = 0; i < 6; ++i)
+            {
+                logger->info("Buffered Log: %u", i);
+            }
+
+            blocker.set_value();
+
+            for (std::uint32_t i = 0; i < 4; ++i)
+            {
+                fly::Log log;
+                CATCH_REQUIRE(received_logs.pop(log, 5s));
+                CATCH_CHECK(log.m_message == fly::String::format("Buffered Log: %u", i));
+            }
+
+            fly::Log log;
+            CATCH_CHECK_FALSE(received_logs.pop(log, 10ms));
+        }
+    }
+
+    CATCH_SECTION("Log points at or above the compile-time minimum log level are compiled")
+    {
+        static_assert(fly::Logger::is_compiled(fly::Log::Level::Error));
+        CATCH_CHECK(fly::Logger::is_compiled(fly::Log::Level::Debug) == (FLY_MIN_LOG_LEVEL == 0));
+    }
+
     // Keep this test last so the logger registry will go out-of-scope without the default logger
     // having been reset to the initial default logger.
     CATCH_SECTION("Not resetting default logger is safe")
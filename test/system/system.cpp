@@ -6,12 +6,16 @@
 
 #if defined(FLY_LINUX)
 #    include "test/mock/mock_system.hpp"
+
+#    include <pthread.h>
+#    include <sched.h>
 #endif
 
 #include "catch2/catch.hpp"
 
 #include <csignal>
 #include <string>
+#include <thread>
 
 namespace {
 
@@ -132,6 +136,51 @@ CATCH_TEST_CASE("System", "[system]")
         CATCH_CHECK(error1 == error2);
     }
 
+    CATCH_SECTION("Set the name of the calling thread")
+    {
+        // Use a separate thread to avoid renaming the test runner's thread.
+        std::thread thread(
+            []()
+            {
+                CATCH_CHECK(fly::System::set_thread_name("fly-test"));
+
+#if defined(FLY_LINUX)
+                char name[16] {};
+                CATCH_REQUIRE(::pthread_getname_np(::pthread_self(), name, sizeof(name)) == 0);
+                CATCH_CHECK(std::string(name) == "fly-test");
+
+                // Names which are too long are truncated.
+                CATCH_CHECK(fly::System::set_thread_name("fly-test-with-a-long-name"));
+                CATCH_REQUIRE(::pthread_getname_np(::pthread_self(), name, sizeof(name)) == 0);
+                CATCH_CHECK(std::string(name) == "fly-test-with-a");
+#endif
+            });
+
+        thread.join();
+    }
+
+    CATCH_SECTION("Pin the calling thread to a CPU")
+    {
+        // Use a separate thread to avoid pinning the test runner's thread.
+        std::thread thread(
+            []()
+            {
+#if defined(FLY_MACOS)
+                CATCH_CHECK_FALSE(fly::System::set_thread_affinity(0));
+#else
+                CATCH_CHECK(fly::System::set_thread_affinity(0));
+#endif
+
+#if defined(FLY_LINUX)
+                CATCH_CHECK(::sched_getcpu() == 0);
+#endif
+
+                CATCH_CHECK_FALSE(fly::System::set_thread_affinity(4096));
+            });
+
+        thread.join();
+    }
+
     CATCH_SECTION("Setup a custom signal handler with global method")
     {
         fly::System::SignalHandler handler(&handle_signal);
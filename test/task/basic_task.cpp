@@ -0,0 +1,206 @@
+#include "fly/task/basic_task.hpp"
+
+#include "fly/task/task_types.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace {
+
+struct CallableCounts
+{
+    std::size_t m_copies {0};
+    std::size_t m_moves {0};
+};
+
+/**
+ * Callable which counts the number of times it is copied and moved. A callable stored inline is
+ * moved along with the task holding it, whereas a callable stored on the heap is not.
+ */
+template <std::size_t PayloadSize>
+class CountingCallable
+{
+public:
+    explicit CountingCallable(CallableCounts &counts) noexcept : m_counts(&counts)
+    {
+    }
+
+    CountingCallable(const CountingCallable &callable) noexcept :
+        m_counts(callable.m_counts),
+        m_payload(callable.m_payload)
+    {
+        ++m_counts->m_copies;
+    }
+
+    CountingCallable(CountingCallable &&callable) noexcept :
+        m_counts(callable.m_counts),
+        m_payload(callable.m_payload)
+    {
+        ++m_counts->m_moves;
+    }
+
+    void operator()(fly::TaskRunner *, fly::TaskLocation)
+    {
+        m_payload[0] = 1;
+    }
+
+private:
+    CallableCounts *m_counts;
+    std::array<std::uint8_t, PayloadSize> m_payload {};
+};
+
+} // namespace
+
+CATCH_TEST_CASE("BasicTask", "[task]")
+{
+    using SmallTask = fly::BasicTask<int(int), 32>;
+
+    CATCH_SECTION("Default tasks are empty")
+    {
+        SmallTask task;
+        CATCH_CHECK_FALSE(task);
+        CATCH_CHECK(task == nullptr);
+
+        SmallTask null_task(nullptr);
+        CATCH_CHECK_FALSE(null_task);
+        CATCH_CHECK(null_task == nullptr);
+    }
+
+    CATCH_SECTION("Tasks may be invoked with arguments and return a result")
+    {
+        SmallTask task = [](int value)
+        {
+            return value * 2;
+        };
+
+        CATCH_REQUIRE(task);
+        CATCH_CHECK(task != nullptr);
+        CATCH_CHECK(task(21) == 42);
+    }
+
+    CATCH_SECTION("Tasks may capture move-only types")
+    {
+        auto value = std::make_unique<int>(12);
+
+        SmallTask task = [value = std::move(value)](int other)
+        {
+            return *value + other;
+        };
+
+        CATCH_CHECK(task(1) == 13);
+    }
+
+    CATCH_SECTION("Tasks may store callables which do not fit in the inline storage")
+    {
+        std::array<int, 32> values {};
+        values[31] = 100;
+
+        SmallTask task = [values](int index)
+        {
+            return values[static_cast<std::size_t>(index)];
+        };
+
+        CATCH_CHECK(task(31) == 100);
+    }
+
+    CATCH_SECTION("Moving a task leaves the moved-from task empty")
+    {
+        auto run = [](SmallTask &&task)
+        {
+            SmallTask moved(std::move(task));
+            CATCH_CHECK(task == nullptr);
+            CATCH_REQUIRE(moved);
+
+            SmallTask assigned;
+            assigned = std::move(moved);
+            CATCH_CHECK(moved == nullptr);
+            CATCH_REQUIRE(assigned);
+
+            return assigned(3);
+        };
+
+        auto small = [](int value)
+        {
+            return value;
+        };
+
+        std::array<int, 32> values {};
+
+        auto large = [values](int value)
+        {
+            return values[0] + value;
+        };
+
+        CATCH_CHECK(run(std::move(small)) == 3);
+        CATCH_CHECK(run(std::move(large)) == 3);
+    }
+
+    CATCH_SECTION("Captured state is destroyed exactly once")
+    {
+        auto counter = std::make_shared<int>(0);
+
+        auto run = [&counter](auto &&padding)
+        {
+            {
+                SmallTask task = [counter, padding](int) mutable
+                {
+                    return ++(*counter);
+                };
+                CATCH_CHECK(counter.use_count() == 2);
+
+                SmallTask moved = std::move(task);
+                CATCH_CHECK(counter.use_count() == 2);
+                CATCH_CHECK(moved(0) > 0);
+
+                moved = nullptr;
+                CATCH_CHECK(counter.use_count() == 1);
+                CATCH_CHECK(moved == nullptr);
+            }
+
+            CATCH_CHECK(counter.use_count() == 1);
+        };
+
+        run(std::uint8_t(0));
+        run(std::array<std::uint8_t, 64> {});
+    }
+
+    CATCH_SECTION("Callables which fit in the inline storage are moved along with the task")
+    {
+        // Similar to the tasks wrapped by task runners: a pointer, and a moved payload.
+        using Callable = CountingCallable<64>;
+        static_assert(sizeof(Callable) <= fly::s_task_inline_size);
+
+        CallableCounts counts;
+        fly::Task task = Callable(counts);
+        CATCH_CHECK(counts.m_copies == 0);
+        CATCH_CHECK(counts.m_moves == 1);
+
+        fly::Task moved = std::move(task);
+        CATCH_CHECK(counts.m_copies == 0);
+        CATCH_CHECK(counts.m_moves == 2);
+
+        moved(nullptr, {});
+    }
+
+    CATCH_SECTION("Callables which do not fit in the inline storage are stored on the heap")
+    {
+        using Callable = CountingCallable<fly::s_task_inline_size>;
+        static_assert(sizeof(Callable) > fly::s_task_inline_size);
+
+        CallableCounts counts;
+        fly::Task task = Callable(counts);
+        CATCH_CHECK(counts.m_copies == 0);
+        CATCH_CHECK(counts.m_moves == 1);
+
+        fly::Task moved = std::move(task);
+        CATCH_CHECK(counts.m_copies == 0);
+        CATCH_CHECK(counts.m_moves == 1);
+
+        moved(nullptr, {});
+    }
+}
@@ -1,20 +1,95 @@
 #include "test/util/task_manager.hpp"
 #include "test/util/waitable_task_runner.hpp"
 
+#include "fly/fly.hpp"
+#include "fly/task/task_config.hpp"
 #include "fly/task/task_manager.hpp"
 #include "fly/task/task_runner.hpp"
 #include "fly/types/concurrency/concurrent_queue.hpp"
 
 #include "catch2/catch.hpp"
 
+#if defined(FLY_LINUX)
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
 namespace {
 
+/**
+ * Subclass of the task config to allow changing default values.
+ */
+class MutableTaskConfig : public fly::TaskConfig
+{
+public:
+    void enable_work_stealing()
+    {
+        m_default_work_stealing = true;
+    }
+
+    void set_sequenced_batch_size(std::uint32_t batch_size)
+    {
+        m_default_sequenced_batch_size = batch_size;
+    }
+
+    void set_sequenced_batch_duration(std::chrono::microseconds batch_duration)
+    {
+        m_default_sequenced_batch_duration = batch_duration.count();
+    }
+
+    void set_max_blocking_threads(std::uint32_t max_blocking_threads)
+    {
+        m_default_max_blocking_threads = max_blocking_threads;
+    }
+
+    void set_blocking_thread_idle_timeout(std::chrono::milliseconds idle_timeout)
+    {
+        m_default_blocking_thread_idle_timeout = idle_timeout.count();
+    }
+
+    void set_max_workers(std::uint32_t max_workers)
+    {
+        m_default_max_workers = max_workers;
+    }
+
+    void set_worker_spawn_latency(std::chrono::microseconds spawn_latency)
+    {
+        m_default_worker_spawn_latency = spawn_latency.count();
+    }
+
+    void set_worker_idle_timeout(std::chrono::milliseconds idle_timeout)
+    {
+        m_default_worker_idle_timeout = idle_timeout.count();
+    }
+
+    void set_worker_cpu_affinity(std::vector<std::uint32_t> cpus)
+    {
+        m_default_worker_cpu_affinity = std::move(cpus);
+    }
+
+    void set_max_queued_tasks(std::size_t max_queued_tasks)
+    {
+        m_default_max_queued_tasks = max_queued_tasks;
+    }
+
+    void set_queue_overflow_policy(std::string policy)
+    {
+        m_default_queue_overflow_policy = std::move(policy);
+    }
+};
+
 /**
  * A task to track whether it was exected.
  */
@@ -156,6 +231,25 @@ CATCH_TEST_CASE("Task", "[task]")
         CATCH_CHECK(task_was_called);
     }
 
+    CATCH_SECTION("Tasks may be posted as move-only lambdas")
+    {
+        auto task_runner =
+            fly::test::task_manager()->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+
+        int result = 0;
+        auto value = std::make_unique<int>(12389);
+
+        auto task = [&result, value = std::move(value)]()
+        {
+            result = *value;
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(task)));
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        CATCH_CHECK(result == 12389);
+    }
+
     CATCH_SECTION("Tasks may be posted as standalone functions")
     {
         auto task_runner =
@@ -227,6 +321,30 @@ CATCH_TEST_CASE("Task", "[task]")
         CATCH_CHECK(reply_was_called);
     }
 
+    CATCH_SECTION("Tasks may pass move-only results to a reply task")
+    {
+        auto task_runner =
+            fly::test::task_manager()->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        int reply_result = 0;
+
+        auto task = []() -> std::unique_ptr<int>
+        {
+            return std::make_unique<int>(12389);
+        };
+        auto reply = [&reply_result](std::unique_ptr<int> result)
+        {
+            reply_result = *result;
+        };
+
+        CATCH_REQUIRE(
+            task_runner->post_task_with_reply(FROM_HERE, std::move(task), std::move(reply)));
+        task_runner->wait_for_task_to_complete(__FILE__);
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        CATCH_CHECK(reply_result == 12389);
+    }
+
     CATCH_SECTION("Void tasks may indicate their completion to a reply task")
     {
         auto task_runner =
@@ -298,6 +416,61 @@ CATCH_TEST_CASE("Task", "[task]")
         CATCH_CHECK(marker == 1);
     }
 
+    CATCH_SECTION("Delayed tasks with sub-millisecond delays execute no sooner than their delay")
+    {
+        auto task_runner =
+            fly::test::task_manager()->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point stop;
+
+        auto task = [&stop]()
+        {
+            stop = std::chrono::steady_clock::now();
+        };
+
+        CATCH_REQUIRE(task_runner->post_task_with_delay(FROM_HERE, std::move(task), 500us));
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        CATCH_CHECK((stop - start) >= 500us);
+    }
+
+    CATCH_SECTION("Delayed tasks execute in order of their scheduled time")
+    {
+        auto task_runner =
+            fly::test::task_manager()->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        fly::ConcurrentQueue<int> ordering;
+        MarkerTask task(&ordering);
+
+        CATCH_REQUIRE(task_runner->post_task_with_delay(
+            FROM_HERE,
+            std::bind(&MarkerTask::run, &task, 1),
+            30ms));
+        CATCH_REQUIRE(task_runner->post_task_with_delay(
+            FROM_HERE,
+            std::bind(&MarkerTask::run, &task, 2),
+            10ms));
+        CATCH_REQUIRE(task_runner->post_task_with_delay(
+            FROM_HERE,
+            std::bind(&MarkerTask::run, &task, 3),
+            20ms));
+
+        task_runner->wait_for_task_to_complete(__FILE__);
+        task_runner->wait_for_task_to_complete(__FILE__);
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        int marker = 0;
+        ordering.pop(marker);
+        CATCH_CHECK(marker == 2);
+
+        ordering.pop(marker);
+        CATCH_CHECK(marker == 3);
+
+        ordering.pop(marker);
+        CATCH_CHECK(marker == 1);
+    }
+
     CATCH_SECTION("Delayed tasks may pass their result to a reply task")
     {
         auto task_runner =
@@ -821,6 +994,25 @@ CATCH_TEST_CASE("TaskManager", "[task]")
         CATCH_CHECK_FALSE(task_manager->stop());
     }
 
+    CATCH_SECTION("Idle workers are woken when a task is posted")
+    {
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+        std::this_thread::sleep_for(20ms);
+
+        bool task_was_called = false;
+        auto task = [&task_was_called]()
+        {
+            task_was_called = true;
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(task)));
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        CATCH_CHECK(task_was_called);
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
     CATCH_SECTION("Parallel tasks cannot be posted after the task manager is deleted")
     {
         auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
@@ -849,3 +1041,1460 @@ CATCH_TEST_CASE("TaskManager", "[task]")
             0ms));
     }
 }
+
+CATCH_TEST_CASE("WorkStealing", "[task]")
+{
+    auto config = std::make_shared<MutableTaskConfig>();
+    config->enable_work_stealing();
+
+    auto task_manager = std::make_shared<fly::TaskManager>(4, config);
+    CATCH_REQUIRE(task_manager->start());
+
+    CATCH_SECTION("Tasks posted from worker threads are executed")
+    {
+        static constexpr int s_num_tasks = 1000;
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+        CountTask task;
+
+        auto fan_out = [&task_runner, &task]()
+        {
+            for (int i = 0; i < s_num_tasks; ++i)
+            {
+                task_runner->post_task(FROM_HERE, std::bind(&CountTask::run, &task));
+            }
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(fan_out)));
+
+        for (int i = 0; i <= s_num_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        CATCH_CHECK(task.get_count() == s_num_tasks);
+    }
+
+    CATCH_SECTION("Sequenced tasks posted from worker threads are executed in order")
+    {
+        static constexpr int s_num_tasks = 100;
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        fly::ConcurrentQueue<int> ordering;
+        MarkerTask task(&ordering);
+
+        auto fan_out = [&task_runner, &task]()
+        {
+            for (int i = 0; i < s_num_tasks; ++i)
+            {
+                task_runner->post_task(FROM_HERE, std::bind(&MarkerTask::run, &task, i));
+            }
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(fan_out)));
+
+        for (int i = 0; i <= s_num_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            int marker = -1;
+            ordering.pop(marker);
+            CATCH_CHECK(marker == i);
+        }
+    }
+
+    CATCH_REQUIRE(task_manager->stop());
+}
+
+CATCH_TEST_CASE("SequencedBatching", "[task]")
+{
+    static constexpr int s_num_tasks = 100;
+
+    auto config = std::make_shared<MutableTaskConfig>();
+    config->set_sequenced_batch_size(s_num_tasks * 2);
+
+    auto task_manager = std::make_shared<fly::TaskManager>(4, config);
+    CATCH_REQUIRE(task_manager->start());
+
+    // Post a task which blocks until the remaining tasks are all posted, so that the remaining
+    // tasks are pending when the first task completes.
+    auto post_blocked_tasks = [](auto &task_runner, auto &&marker_task)
+    {
+        std::promise<void> release;
+        auto released = release.get_future().share();
+
+        auto blocker = [released]()
+        {
+            released.wait();
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(blocker)));
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::bind(marker_task, i)));
+        }
+
+        release.set_value();
+
+        for (int i = 0; i <= s_num_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+    };
+
+    CATCH_SECTION("Pending sequenced tasks are executed in order on the same worker thread")
+    {
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        fly::ConcurrentQueue<int> ordering;
+        fly::ConcurrentQueue<std::thread::id> threads;
+
+        auto marker_task = [&ordering, &threads](int marker)
+        {
+            ordering.push(std::move(marker));
+            threads.push(std::this_thread::get_id());
+        };
+
+        post_blocked_tasks(task_runner, marker_task);
+
+        std::thread::id first_thread;
+        threads.pop(first_thread);
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            int marker = -1;
+            ordering.pop(marker);
+            CATCH_CHECK(marker == i);
+
+            if (i > 0)
+            {
+                std::thread::id thread;
+                threads.pop(thread);
+                CATCH_CHECK(thread == first_thread);
+            }
+        }
+    }
+
+    CATCH_SECTION("Batches are limited by a time budget without affecting order")
+    {
+        config->set_sequenced_batch_duration(1us);
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        fly::ConcurrentQueue<int> ordering;
+        MarkerTask task(&ordering);
+
+        post_blocked_tasks(task_runner, std::bind(&MarkerTask::run, &task, std::placeholders::_1));
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            int marker = -1;
+            ordering.pop(marker);
+            CATCH_CHECK(marker == i);
+        }
+    }
+
+    CATCH_SECTION("Batched task runners do not starve other task runners")
+    {
+        config->set_sequenced_batch_size(10);
+
+        auto sequenced_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+        auto parallel_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+
+        std::atomic_bool parallel_task_ran(false);
+        std::atomic_int sequenced_tasks_before_parallel(0);
+
+        auto sequenced_task = [&parallel_task_ran, &sequenced_tasks_before_parallel](int)
+        {
+            if (!parallel_task_ran.load())
+            {
+                ++sequenced_tasks_before_parallel;
+            }
+        };
+
+        auto parallel_task = [&parallel_task_ran]()
+        {
+            parallel_task_ran.store(true);
+        };
+
+        std::promise<void> release;
+        auto released = release.get_future().share();
+
+        // Occupy all but one of the worker threads, so that the sequenced task runner and the
+        // parallel task runner must share a single worker thread.
+        for (int i = 0; i < 3; ++i)
+        {
+            auto blocker = [released]()
+            {
+                released.wait();
+            };
+
+            CATCH_REQUIRE(parallel_runner->post_task(FROM_HERE, std::move(blocker)));
+        }
+
+        post_blocked_tasks(
+            sequenced_runner,
+            [&parallel_runner, &parallel_task, &sequenced_task](int marker)
+            {
+                if (marker == 0)
+                {
+                    parallel_runner->post_task(FROM_HERE, parallel_task);
+                }
+
+                sequenced_task(marker);
+            });
+
+        release.set_value();
+
+        for (int i = 0; i < 4; ++i)
+        {
+            parallel_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        CATCH_CHECK(parallel_task_ran.load());
+        CATCH_CHECK(sequenced_tasks_before_parallel.load() < s_num_tasks);
+    }
+
+    CATCH_SECTION("Batched sequenced tasks never overlap when the sequence changes worker threads")
+    {
+        static constexpr int s_num_overlap_tasks = 2000;
+        config->set_sequenced_batch_size(3);
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        std::atomic_bool task_running(false);
+        std::atomic_int overlapping_tasks(0);
+        std::atomic_int counter(0);
+
+        auto task = [&task_running, &overlapping_tasks, &counter]()
+        {
+            if (task_running.exchange(true))
+            {
+                ++overlapping_tasks;
+            }
+
+            ++counter;
+            std::this_thread::yield();
+
+            task_running.store(false);
+        };
+
+        // Post the tasks while earlier tasks are executing, so that batches frequently exhaust the
+        // pending queue and the sequence is handed to another worker thread.
+        for (int i = 0; i < s_num_overlap_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, task));
+        }
+
+        for (int i = 0; i < s_num_overlap_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        CATCH_CHECK(counter.load() == s_num_overlap_tasks);
+        CATCH_CHECK(overlapping_tasks.load() == 0);
+    }
+
+    CATCH_REQUIRE(task_manager->stop());
+}
+
+CATCH_TEST_CASE("TaskPriority", "[task]")
+{
+    static constexpr int s_num_tasks = 10;
+
+    // Use a single worker thread so that the order in which lanes are serviced is observable.
+    auto task_manager = std::make_shared<fly::TaskManager>(1);
+    CATCH_REQUIRE(task_manager->start());
+
+    fly::ConcurrentQueue<fly::TaskPriority> ordering;
+
+    auto marker_task = [&ordering](fly::TaskPriority priority)
+    {
+        return [&ordering, priority]()
+        {
+            ordering.push(fly::TaskPriority(priority));
+        };
+    };
+
+    // Block the worker thread until tasks of every priority are queued, then find the position at
+    // which the first high priority task was executed.
+    auto run_blocked = [&ordering](auto &task_runner, int posted_tasks, auto &&post_tasks) -> int
+    {
+        std::promise<void> release;
+        auto released = release.get_future().share();
+
+        auto blocker = [released]()
+        {
+            released.wait();
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(blocker)));
+        post_tasks();
+        release.set_value();
+
+        for (int i = 0; i <= posted_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        int position = -1;
+
+        for (int i = 0; i <= s_num_tasks * 2; ++i)
+        {
+            fly::TaskPriority priority;
+            ordering.pop(priority);
+
+            if ((position == -1) && (priority == fly::TaskPriority::High))
+            {
+                position = i;
+            }
+        }
+
+        return position;
+    };
+
+    CATCH_SECTION("High priority tasks posted with a priority jump ahead of queued tasks")
+    {
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+
+        const int position = run_blocked(
+            task_runner,
+            s_num_tasks * 2 + 1,
+            [&task_runner, &marker_task]()
+            {
+                for (int i = 0; i < s_num_tasks; ++i)
+                {
+                    auto background = marker_task(fly::TaskPriority::Background);
+                    task_runner->post_task_with_priority(
+                        FROM_HERE,
+                        std::move(background),
+                        fly::TaskPriority::Background);
+
+                    task_runner->post_task(FROM_HERE, marker_task(fly::TaskPriority::Normal));
+                }
+
+                auto high = marker_task(fly::TaskPriority::High);
+                task_runner->post_task_with_priority(
+                    FROM_HERE,
+                    std::move(high),
+                    fly::TaskPriority::High);
+            });
+
+        // The high priority task is executed first, unless the worker happened to be on a tick at
+        // which lower priority lanes are given the first pick.
+        CATCH_CHECK(position >= 0);
+        CATCH_CHECK(position <= 2);
+    }
+
+    CATCH_SECTION("Task runners may be created with a default priority")
+    {
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+        auto high_task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>(
+                fly::TaskPriority::High);
+
+        const int position = run_blocked(
+            task_runner,
+            s_num_tasks * 2,
+            [&task_runner, &high_task_runner, &marker_task]()
+            {
+                for (int i = 0; i < s_num_tasks * 2; ++i)
+                {
+                    task_runner->post_task(FROM_HERE, marker_task(fly::TaskPriority::Normal));
+                }
+
+                high_task_runner->post_task(FROM_HERE, marker_task(fly::TaskPriority::High));
+            });
+
+        high_task_runner->wait_for_task_to_complete(__FILE__);
+
+        CATCH_CHECK(position >= 0);
+        CATCH_CHECK(position <= 2);
+    }
+
+    CATCH_SECTION("Background tasks are not starved by a flood of high priority tasks")
+    {
+        static constexpr int s_max_high_tasks = 1000;
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>(
+                fly::TaskPriority::High);
+
+        // Tasks may outlive this section, so their state must be shared rather than captured by
+        // reference.
+        struct FloodState
+        {
+            std::atomic_bool m_background_task_ran {false};
+            std::atomic_int m_high_tasks_run {0};
+        };
+
+        struct FloodTask
+        {
+            void operator()() const
+            {
+                if (!m_state->m_background_task_ran.load() &&
+                    (++m_state->m_high_tasks_run < s_max_high_tasks))
+                {
+                    m_task_runner->post_task(FROM_HERE, FloodTask(*this));
+                    m_task_runner->post_task(FROM_HERE, FloodTask(*this));
+                }
+            }
+
+            std::shared_ptr<FloodState> m_state;
+            std::shared_ptr<fly::test::WaitableParallelTaskRunner> m_task_runner;
+        };
+
+        auto state = std::make_shared<FloodState>();
+
+        auto background = [state]()
+        {
+            state->m_background_task_ran.store(true);
+        };
+
+        // Post the background task first; otherwise, the flood may complete before the background
+        // task is even posted.
+        task_runner->post_task_with_priority(
+            FROM_HERE,
+            std::move(background),
+            fly::TaskPriority::Background);
+        task_runner->post_task(FROM_HERE, FloodTask {state, task_runner});
+
+        auto &background_task_ran = state->m_background_task_ran;
+        auto &high_tasks_run = state->m_high_tasks_run;
+
+        while (!background_task_ran.load() && (high_tasks_run.load() < s_max_high_tasks))
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        CATCH_CHECK(background_task_ran.load());
+        CATCH_CHECK(high_tasks_run.load() < s_max_high_tasks);
+    }
+
+    CATCH_REQUIRE(task_manager->stop());
+}
+
+CATCH_TEST_CASE("BlockingTasks", "[task]")
+{
+    auto config = std::make_shared<MutableTaskConfig>();
+
+    // Spin until a condition is met, or until a generous timeout expires.
+    auto wait_until = [](auto &&condition)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+
+        while (!condition() && (std::chrono::steady_clock::now() < deadline))
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        return condition();
+    };
+
+    CATCH_SECTION("Blocking tasks do not occupy worker threads")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::promise<void> release;
+        auto released = release.get_future().share();
+
+        auto blocker = [released]()
+        {
+            released.wait();
+        };
+
+        CATCH_REQUIRE(task_runner->post_blocking_task(FROM_HERE, std::move(blocker)));
+
+        // With a single worker thread, this task could not execute if the blocking task were
+        // executed by the worker thread.
+        auto future = task_runner->post_task_with_future(
+            FROM_HERE,
+            []()
+            {
+                return 12389;
+            });
+
+        auto result = future.get();
+        CATCH_REQUIRE(result.has_value());
+        CATCH_CHECK(*result == 12389);
+
+        release.set_value();
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Blocking threads are created on demand")
+    {
+        static constexpr std::uint32_t s_num_tasks = 4;
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::atomic<std::uint32_t> running = 0;
+        std::atomic_bool release = false;
+
+        for (std::uint32_t i = 0; i < s_num_tasks; ++i)
+        {
+            auto blocker = [&running, &release]()
+            {
+                ++running;
+
+                while (!release.load())
+                {
+                    std::this_thread::sleep_for(1ms);
+                }
+
+                --running;
+            };
+
+            CATCH_REQUIRE(task_runner->post_blocking_task(FROM_HERE, std::move(blocker)));
+        }
+
+        CATCH_CHECK(wait_until(
+            [&running]()
+            {
+                return running.load() == s_num_tasks;
+            }));
+
+        release = true;
+
+        CATCH_CHECK(wait_until(
+            [&running]()
+            {
+                return running.load() == 0;
+            }));
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("The number of blocking threads is limited")
+    {
+        config->set_max_blocking_threads(1);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::atomic<std::uint32_t> running = 0;
+        std::atomic<std::uint32_t> completed = 0;
+        std::atomic_bool ran_concurrently = false;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            auto task = [&running, &completed, &ran_concurrently]()
+            {
+                if (++running > 1)
+                {
+                    ran_concurrently = true;
+                }
+
+                std::this_thread::sleep_for(5ms);
+
+                --running;
+                ++completed;
+            };
+
+            CATCH_REQUIRE(task_runner->post_blocking_task(FROM_HERE, std::move(task)));
+        }
+
+        CATCH_CHECK(wait_until(
+            [&completed]()
+            {
+                return completed.load() == 3;
+            }));
+
+        CATCH_CHECK_FALSE(ran_concurrently);
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Blocking tasks may be posted after idle blocking threads exit")
+    {
+        config->set_blocking_thread_idle_timeout(1ms);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+        std::atomic<std::uint32_t> calls = 0;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            auto task = [&calls]()
+            {
+                ++calls;
+            };
+
+            CATCH_REQUIRE(task_runner->post_blocking_task(FROM_HERE, std::move(task)));
+
+            CATCH_CHECK(wait_until(
+                [&calls, i]()
+                {
+                    return calls.load() == static_cast<std::uint32_t>(i + 1);
+                }));
+
+            std::this_thread::sleep_for(10ms);
+        }
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Blocking tasks posted to sequenced task runners remain in sequence")
+    {
+        config->set_sequenced_batch_size(10);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        fly::ConcurrentQueue<int> ordering;
+
+        for (int i = 0; i < 10; ++i)
+        {
+            auto task = [&ordering, i]()
+            {
+                ordering.push(int(i));
+            };
+
+            if ((i % 2) == 0)
+            {
+                CATCH_REQUIRE(task_runner->post_blocking_task(FROM_HERE, std::move(task)));
+            }
+            else
+            {
+                CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(task)));
+            }
+        }
+
+        for (int i = 0; i < 10; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        for (int i = 0; i < 10; ++i)
+        {
+            int value = -1;
+            ordering.pop(value);
+            CATCH_CHECK(value == i);
+        }
+
+        CATCH_CHECK(task_manager->stop());
+    }
+}
+
+CATCH_TEST_CASE("ElasticWorkerPool", "[task]")
+{
+    auto config = std::make_shared<MutableTaskConfig>();
+    config->set_worker_spawn_latency(1ms);
+    config->set_worker_idle_timeout(50ms);
+
+    // Spin until a condition is met, or until a generous timeout expires.
+    auto wait_until = [](auto &&condition)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+
+        while (!condition() && (std::chrono::steady_clock::now() < deadline))
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        return condition();
+    };
+
+    CATCH_SECTION("Worker pools have a fixed size by default")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(2, config);
+        CATCH_CHECK(task_manager->worker_count() == 0);
+
+        CATCH_REQUIRE(task_manager->start());
+        CATCH_CHECK(task_manager->worker_count() == 2);
+
+        CATCH_REQUIRE(task_manager->stop());
+        CATCH_CHECK(task_manager->worker_count() == 0);
+    }
+
+    CATCH_SECTION("Worker threads are created when tasks are queued behind busy workers")
+    {
+        static constexpr std::uint32_t s_num_tasks = 3;
+        config->set_max_workers(s_num_tasks);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+        CATCH_CHECK(task_manager->worker_count() == 1);
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::atomic<std::uint32_t> running = 0;
+        std::atomic_bool release = false;
+
+        auto blocker = [&running, &release]()
+        {
+            ++running;
+
+            while (!release.load())
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+
+            --running;
+        };
+
+        // Each task occupies a worker thread until released, so the remaining tasks may only
+        // execute on newly created worker threads. Posting repeatedly ensures the queueing latency
+        // is observed after the spawn latency interval has passed.
+        for (std::uint32_t i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, blocker));
+        }
+
+        CATCH_CHECK(wait_until(
+            [&task_runner, &running]()
+            {
+                task_runner->post_task(FROM_HERE, []() {});
+                return running.load() == s_num_tasks;
+            }));
+
+        CATCH_CHECK(task_manager->worker_count() == s_num_tasks);
+
+        release = true;
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Worker pools do not grow beyond the maximum size")
+    {
+        config->set_max_workers(2);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::atomic<std::uint32_t> running = 0;
+        std::atomic_bool release = false;
+
+        auto blocker = [&running, &release]()
+        {
+            ++running;
+
+            while (!release.load())
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+
+            --running;
+        };
+
+        for (std::uint32_t i = 0; i < 4; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, blocker));
+        }
+
+        CATCH_CHECK(wait_until(
+            [&task_runner, &running]()
+            {
+                task_runner->post_task(FROM_HERE, []() {});
+                return running.load() == 2;
+            }));
+
+        std::this_thread::sleep_for(20ms);
+        task_runner->post_task(FROM_HERE, []() {});
+
+        CATCH_CHECK(running.load() == 2);
+        CATCH_CHECK(task_manager->worker_count() == 2);
+
+        release = true;
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Idle worker threads are retired down to the minimum size")
+    {
+        config->set_max_workers(3);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+        std::atomic_bool release = false;
+
+        auto blocker = [&release]()
+        {
+            while (!release.load())
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, blocker));
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, blocker));
+
+        CATCH_CHECK(wait_until(
+            [&task_runner, &task_manager]()
+            {
+                task_runner->post_task(FROM_HERE, []() {});
+                return task_manager->worker_count() > 1;
+            }));
+
+        release = true;
+
+        CATCH_CHECK(wait_until(
+            [&task_manager]()
+            {
+                return task_manager->worker_count() == 1;
+            }));
+
+        // The remaining worker thread continues to execute tasks.
+        auto future = task_runner->post_task_with_future(
+            FROM_HERE,
+            []()
+            {
+                return 12389;
+            });
+
+        auto result = future.get();
+        CATCH_REQUIRE(result.has_value());
+        CATCH_CHECK(*result == 12389);
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Worker pools may repeatedly grow and shrink")
+    {
+        config->set_max_workers(2);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        // Retired worker slots are reused by newly created worker threads.
+        for (int i = 0; i < 3; ++i)
+        {
+            std::atomic_bool release = false;
+
+            auto blocker = [&release]()
+            {
+                while (!release.load())
+                {
+                    std::this_thread::sleep_for(1ms);
+                }
+            };
+
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, blocker));
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, blocker));
+
+            CATCH_CHECK(wait_until(
+                [&task_runner, &task_manager]()
+                {
+                    task_runner->post_task(FROM_HERE, []() {});
+                    return task_manager->worker_count() == 2;
+                }));
+
+            release = true;
+
+            CATCH_CHECK(wait_until(
+                [&task_manager]()
+                {
+                    return task_manager->worker_count() == 1;
+                }));
+        }
+
+        CATCH_CHECK(task_manager->stop());
+    }
+}
+
+CATCH_TEST_CASE("BulkPosting", "[task]")
+{
+    static constexpr std::uint32_t s_num_tasks = 1000;
+
+    auto config = std::make_shared<MutableTaskConfig>();
+
+    CATCH_SECTION("All tasks posted in bulk to a parallel task runner are executed")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(4, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::atomic<std::uint32_t> calls = 0;
+        std::promise<void> done;
+
+        std::vector<std::function<void()>> tasks;
+
+        for (std::uint32_t i = 0; i < s_num_tasks; ++i)
+        {
+            tasks.emplace_back(
+                [&calls, &done]()
+                {
+                    if (++calls == s_num_tasks)
+                    {
+                        done.set_value();
+                    }
+                });
+        }
+
+        CATCH_REQUIRE(task_runner->post_tasks(FROM_HERE, std::move(tasks)));
+        CATCH_CHECK(done.get_future().wait_for(5s) == std::future_status::ready);
+        CATCH_CHECK(calls == s_num_tasks);
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Tasks posted in bulk to a sequenced task runner are executed in order")
+    {
+        auto task_runner =
+            fly::test::task_manager()->create_task_runner<fly::SequencedTaskRunner>();
+
+        std::vector<std::uint32_t> order;
+        std::vector<std::function<void()>> tasks;
+
+        CATCH_REQUIRE(task_runner->post_task(
+            FROM_HERE,
+            [&order]()
+            {
+                order.push_back(0);
+            }));
+
+        for (std::uint32_t i = 1; i < s_num_tasks; ++i)
+        {
+            tasks.emplace_back(
+                [&order, i]()
+                {
+                    order.push_back(i);
+                });
+        }
+
+        CATCH_REQUIRE(task_runner->post_tasks(FROM_HERE, std::move(tasks)));
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, []() {});
+        CATCH_REQUIRE(future.wait());
+
+        CATCH_REQUIRE(order.size() == s_num_tasks);
+
+        for (std::uint32_t i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_CHECK(order[i] == i);
+        }
+    }
+
+    CATCH_SECTION("Tasks posted in bulk from a worker thread are executed")
+    {
+        config->enable_work_stealing();
+
+        auto task_manager = std::make_shared<fly::TaskManager>(2, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::atomic<std::uint32_t> calls = 0;
+        std::promise<void> done;
+
+        auto fan_out = [&task_runner, &calls, &done]()
+        {
+            std::vector<std::function<void()>> tasks;
+
+            for (std::uint32_t i = 0; i < s_num_tasks; ++i)
+            {
+                tasks.emplace_back(
+                    [&calls, &done]()
+                    {
+                        if (++calls == s_num_tasks)
+                        {
+                            done.set_value();
+                        }
+                    });
+            }
+
+            task_runner->post_tasks(FROM_HERE, std::move(tasks));
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(fan_out)));
+        CATCH_CHECK(done.get_future().wait_for(5s) == std::future_status::ready);
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Tasks posted in bulk with a weak owner are dropped if the owner is deleted")
+    {
+        auto task_runner = fly::test::task_manager()->create_task_runner<fly::ParallelTaskRunner>();
+
+        auto owner = std::make_shared<int>(12389);
+        std::atomic<std::uint32_t> calls = 0;
+
+        std::vector<std::function<void(std::shared_ptr<int>)>> tasks;
+
+        for (std::uint32_t i = 0; i < 10; ++i)
+        {
+            tasks.emplace_back(
+                [&calls](std::shared_ptr<int> self)
+                {
+                    CATCH_CHECK(*self == 12389);
+                    ++calls;
+                });
+        }
+
+        CATCH_REQUIRE(task_runner->post_tasks(FROM_HERE, std::move(tasks), std::weak_ptr(owner)));
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, []() {});
+        CATCH_REQUIRE(future.wait());
+        CATCH_CHECK(calls == 10);
+    }
+
+    CATCH_SECTION("Blocking tasks may be posted in bulk")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>(
+            fly::TaskPriority::Blocking);
+
+        std::atomic<std::uint32_t> calls = 0;
+        std::promise<void> done;
+
+        std::vector<std::function<void()>> tasks;
+
+        for (std::uint32_t i = 0; i < 10; ++i)
+        {
+            tasks.emplace_back(
+                [&calls, &done]()
+                {
+                    if (++calls == 10)
+                    {
+                        done.set_value();
+                    }
+                });
+        }
+
+        CATCH_REQUIRE(task_runner->post_tasks(FROM_HERE, std::move(tasks)));
+        CATCH_CHECK(done.get_future().wait_for(5s) == std::future_status::ready);
+
+        CATCH_CHECK(task_manager->stop());
+    }
+}
+
+CATCH_TEST_CASE("QueueLimits", "[task]")
+{
+    auto config = std::make_shared<MutableTaskConfig>();
+
+    auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+    auto gate_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+    std::promise<void> gate;
+    std::shared_future<void> gate_future = gate.get_future().share();
+
+    // Occupy the only worker thread until the gate is opened, so that posted tasks remain queued.
+    auto close_gate = [&gate_runner, &gate_future]()
+    {
+        auto started = std::make_shared<std::promise<void>>();
+        auto started_future = started->get_future();
+
+        CATCH_REQUIRE(gate_runner->post_task(
+            FROM_HERE,
+            [started, gate_future]()
+            {
+                started->set_value();
+                gate_future.wait();
+            }));
+
+        started_future.wait();
+    };
+
+    auto noop = []()
+    {
+    };
+
+    CATCH_SECTION("Queues are unbounded by default")
+    {
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        for (std::uint32_t i = 0; i < 100; ++i)
+        {
+            CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+        }
+
+        fly::TaskQueueMetrics metrics = task_runner->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 100);
+        CATCH_CHECK(metrics.m_capacity == 0);
+        CATCH_CHECK(metrics.m_rejected == 0);
+        CATCH_CHECK(task_manager->queue_metrics().m_depth == 100);
+
+        gate.set_value();
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, noop);
+        CATCH_REQUIRE(future.wait());
+
+        metrics = task_runner->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 0);
+        CATCH_CHECK(metrics.m_peak_depth >= 100);
+        CATCH_CHECK(task_manager->queue_metrics().m_depth == 0);
+    }
+
+    CATCH_SECTION("Tasks posted to a full task runner are rejected")
+    {
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>(
+            fly::TaskPriority::Normal,
+            {2, fly::TaskQueuePolicy::Reject});
+
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+        CATCH_CHECK_FALSE(task_runner->post_task(FROM_HERE, noop));
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, noop);
+        CATCH_CHECK(future.is_ready());
+        CATCH_CHECK_FALSE(future.wait());
+
+        fly::TaskQueueMetrics metrics = task_runner->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 2);
+        CATCH_CHECK(metrics.m_capacity == 2);
+        CATCH_CHECK(metrics.m_rejected == 2);
+
+        gate.set_value();
+
+        while (task_runner->queue_metrics().m_depth > 0)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+    }
+
+    CATCH_SECTION("Batches which do not fit in a full task runner are rejected")
+    {
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::SequencedTaskRunner>(
+            fly::TaskPriority::Normal,
+            {4, fly::TaskQueuePolicy::Reject});
+
+        // The first task is posted for execution immediately, and is not held in the pending queue.
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+
+        std::vector<std::function<void()>> tasks1(3, noop);
+        CATCH_CHECK(task_runner->post_tasks(FROM_HERE, std::move(tasks1)));
+
+        std::vector<std::function<void()>> tasks2(3, noop);
+        CATCH_CHECK_FALSE(task_runner->post_tasks(FROM_HERE, std::move(tasks2)));
+
+        fly::TaskQueueMetrics metrics = task_runner->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 3);
+        CATCH_CHECK(metrics.m_rejected == 3);
+
+        gate.set_value();
+    }
+
+    CATCH_SECTION("Sequenced task runners drop their oldest pending tasks")
+    {
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::SequencedTaskRunner>(
+            fly::TaskPriority::Normal,
+            {2, fly::TaskQueuePolicy::DropOldest});
+
+        std::vector<std::uint32_t> order;
+        std::promise<void> done;
+
+        for (std::uint32_t i = 0; i < 5; ++i)
+        {
+            CATCH_CHECK(task_runner->post_task(
+                FROM_HERE,
+                [&order, &done, i]()
+                {
+                    order.push_back(i);
+
+                    if (i == 4)
+                    {
+                        done.set_value();
+                    }
+                }));
+        }
+
+        fly::TaskQueueMetrics metrics = task_runner->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 2);
+        CATCH_CHECK(metrics.m_dropped == 2);
+        CATCH_CHECK(metrics.m_rejected == 0);
+
+        gate.set_value();
+        CATCH_REQUIRE(done.get_future().wait_for(5s) == std::future_status::ready);
+
+        CATCH_CHECK(order == std::vector<std::uint32_t> {0, 3, 4});
+    }
+
+    CATCH_SECTION("Parallel task runners reject new tasks with the drop-oldest policy")
+    {
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>(
+            fly::TaskPriority::Normal,
+            {1, fly::TaskQueuePolicy::DropOldest});
+
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+        CATCH_CHECK_FALSE(task_runner->post_task(FROM_HERE, noop));
+
+        fly::TaskQueueMetrics metrics = task_runner->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 1);
+        CATCH_CHECK(metrics.m_dropped == 0);
+        CATCH_CHECK(metrics.m_rejected == 1);
+
+        gate.set_value();
+    }
+
+    CATCH_SECTION("Posting to a full task runner blocks until space is available")
+    {
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>(
+            fly::TaskPriority::Normal,
+            {1, fly::TaskQueuePolicy::Block});
+
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+
+        auto blocked = std::async(
+            std::launch::async,
+            [&task_runner, &noop]()
+            {
+                return task_runner->post_task(FROM_HERE, noop);
+            });
+
+        CATCH_CHECK(blocked.wait_for(50ms) == std::future_status::timeout);
+
+        gate.set_value();
+        CATCH_REQUIRE(blocked.wait_for(5s) == std::future_status::ready);
+        CATCH_CHECK(blocked.get());
+
+        CATCH_CHECK(task_runner->queue_metrics().m_rejected == 0);
+    }
+
+    CATCH_SECTION("Tasks posted from within a task runner's own tasks are never blocked")
+    {
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::SequencedTaskRunner>(
+            fly::TaskPriority::Normal,
+            {1, fly::TaskQueuePolicy::Block});
+
+        std::atomic<std::uint32_t> calls = 0;
+        std::promise<void> done;
+
+        auto fan_out = [&task_runner, &calls, &done]()
+        {
+            for (std::uint32_t i = 0; i < 10; ++i)
+            {
+                task_runner->post_task(
+                    FROM_HERE,
+                    [&calls, &done]()
+                    {
+                        if (++calls == 10)
+                        {
+                            done.set_value();
+                        }
+                    });
+            }
+        };
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, std::move(fan_out)));
+        CATCH_CHECK(done.get_future().wait_for(5s) == std::future_status::ready);
+        CATCH_CHECK(task_runner->queue_metrics().m_peak_depth >= 9);
+
+        gate.set_value();
+    }
+
+    CATCH_SECTION("Tasks posted to full shared queues are rejected")
+    {
+        config->set_max_queued_tasks(2);
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+        CATCH_CHECK_FALSE(task_runner->post_task(FROM_HERE, noop));
+
+        // The task runner's own queue depth is not affected by the rejection.
+        CATCH_CHECK(task_runner->queue_metrics().m_depth == 2);
+        CATCH_CHECK(task_runner->queue_metrics().m_rejected == 0);
+
+        // Blocking tasks are not queued in the shared queues.
+        CATCH_CHECK(task_runner->post_blocking_task(FROM_HERE, noop));
+
+        fly::TaskQueueMetrics metrics = task_manager->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 2);
+        CATCH_CHECK(metrics.m_capacity == 2);
+        CATCH_CHECK(metrics.m_rejected == 1);
+
+        gate.set_value();
+    }
+
+    CATCH_SECTION("The oldest tasks in the shared queues are dropped, lowest priority first")
+    {
+        config->set_max_queued_tasks(2);
+        config->set_queue_overflow_policy("drop_oldest");
+
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::array<std::atomic_bool, 4> executed {};
+        std::promise<void> done;
+
+        auto task = [&executed, &done](std::size_t index)
+        {
+            return [&executed, &done, index]()
+            {
+                executed[index] = true;
+
+                if (index == 3)
+                {
+                    done.set_value();
+                }
+            };
+        };
+
+        CATCH_CHECK(task_runner->post_task_with_priority(
+            FROM_HERE,
+            task(0),
+            fly::TaskPriority::Background));
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, task(1)));
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, task(2)));
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, task(3)));
+
+        fly::TaskQueueMetrics metrics = task_manager->queue_metrics();
+        CATCH_CHECK(metrics.m_depth == 2);
+        CATCH_CHECK(metrics.m_dropped == 2);
+        CATCH_CHECK(task_runner->queue_metrics().m_depth == 2);
+
+        gate.set_value();
+        CATCH_REQUIRE(done.get_future().wait_for(5s) == std::future_status::ready);
+
+        CATCH_CHECK_FALSE(executed[0]);
+        CATCH_CHECK_FALSE(executed[1]);
+        CATCH_CHECK(executed[2]);
+        CATCH_CHECK(executed[3]);
+    }
+
+    CATCH_SECTION("Posting to full shared queues blocks until space is available")
+    {
+        config->set_max_queued_tasks(1);
+        config->set_queue_overflow_policy("block");
+
+        CATCH_REQUIRE(task_manager->start());
+        close_gate();
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+        CATCH_CHECK(task_runner->post_task(FROM_HERE, noop));
+
+        auto blocked = std::async(
+            std::launch::async,
+            [&task_runner, &noop]()
+            {
+                return task_runner->post_task(FROM_HERE, noop);
+            });
+
+        CATCH_CHECK(blocked.wait_for(50ms) == std::future_status::timeout);
+
+        gate.set_value();
+        CATCH_REQUIRE(blocked.wait_for(5s) == std::future_status::ready);
+        CATCH_CHECK(blocked.get());
+    }
+
+    CATCH_CHECK(task_manager->stop());
+}
+
+#if defined(FLY_LINUX)
+
+CATCH_TEST_CASE("WorkerThreads", "[task]")
+{
+    auto config = std::make_shared<MutableTaskConfig>();
+
+    auto thread_name = []()
+    {
+        char name[16] {};
+        ::pthread_getname_np(::pthread_self(), name, sizeof(name));
+
+        return std::string(name);
+    };
+
+    CATCH_SECTION("Worker threads are named")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, thread_name);
+        auto result = future.get();
+        CATCH_REQUIRE(result.has_value());
+        CATCH_CHECK(*result == "fly-worker-0");
+
+        std::promise<std::string> blocking_name;
+
+        CATCH_REQUIRE(task_runner->post_blocking_task(
+            FROM_HERE,
+            [&blocking_name, &thread_name]()
+            {
+                blocking_name.set_value(thread_name());
+            }));
+
+        CATCH_CHECK(blocking_name.get_future().get() == "fly-blocking");
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Worker threads may be pinned to a CPU")
+    {
+        config->set_worker_cpu_affinity({0});
+
+        auto task_manager = std::make_shared<fly::TaskManager>(2, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        for (int i = 0; i < 10; ++i)
+        {
+            auto future = task_runner->post_task_with_future(
+                FROM_HERE,
+                []()
+                {
+                    return ::sched_getcpu();
+                });
+
+            auto result = future.get();
+            CATCH_REQUIRE(result.has_value());
+            CATCH_CHECK(*result == 0);
+        }
+
+        CATCH_CHECK(task_manager->stop());
+    }
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include "fly/task/task_coroutine.hpp"
+
+#include "test/util/task_manager.hpp"
+
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/**
+ * Object to indicate when a coroutine frame has been destroyed.
+ */
+class FrameGuard
+{
+public:
+    explicit FrameGuard(std::atomic_bool *destroyed) noexcept : m_destroyed(destroyed)
+    {
+    }
+
+    ~FrameGuard()
+    {
+        m_destroyed->store(true);
+    }
+
+private:
+    std::atomic_bool *m_destroyed;
+};
+
+fly::TaskCoroutine
+schedule(std::shared_ptr<fly::TaskRunner> task_runner, std::promise<std::thread::id> *promise)
+{
+    co_await task_runner->schedule(FROM_HERE);
+    promise->set_value(std::this_thread::get_id());
+}
+
+fly::TaskCoroutine delay(
+    std::shared_ptr<fly::TaskRunner> task_runner,
+    std::chrono::nanoseconds duration,
+    std::promise<std::chrono::steady_clock::time_point> *promise)
+{
+    co_await task_runner->delay(FROM_HERE, duration);
+    promise->set_value(std::chrono::steady_clock::now());
+}
+
+fly::TaskCoroutine await_result(
+    std::shared_ptr<fly::TaskRunner> sequenced_runner,
+    std::shared_ptr<fly::TaskRunner> parallel_runner,
+    std::promise<std::string> *promise)
+{
+    co_await sequenced_runner->schedule(FROM_HERE);
+
+    auto task = []() -> std::string
+    {
+        return "hello";
+    };
+
+    std::string result = co_await parallel_runner->post_task_with_awaitable(FROM_HERE, task);
+
+    // The coroutine should have been resumed on the runner it was suspended from.
+    if (fly::detail::CoroutineScheduler::current_task_runner() == sequenced_runner)
+    {
+        result += " world";
+    }
+
+    promise->set_value(std::move(result));
+}
+
+fly::TaskCoroutine
+await_void(std::shared_ptr<fly::TaskRunner> task_runner, std::promise<bool> *promise)
+{
+    bool task_was_called = false;
+
+    auto task = [&task_was_called]()
+    {
+        task_was_called = true;
+    };
+
+    co_await task_runner->post_task_with_awaitable(FROM_HERE, std::move(task));
+    promise->set_value(task_was_called);
+}
+
+fly::TaskCoroutine
+dropped(std::shared_ptr<fly::TaskRunner> task_runner, std::atomic_bool *destroyed, bool *resumed)
+{
+    FrameGuard guard(destroyed);
+
+    co_await task_runner->delay(FROM_HERE, 1h);
+    *resumed = true;
+}
+
+} // namespace
+
+CATCH_TEST_CASE("TaskCoroutine", "[task]")
+{
+    auto parallel_runner =
+        fly::test::task_manager()->create_task_runner<fly::ParallelTaskRunner>();
+    auto sequenced_runner =
+        fly::test::task_manager()->create_task_runner<fly::SequencedTaskRunner>();
+
+    CATCH_SECTION("Coroutines may be resumed on a task runner")
+    {
+        std::promise<std::thread::id> promise;
+        auto future = promise.get_future();
+
+        schedule(parallel_runner, &promise);
+
+        CATCH_REQUIRE(future.wait_for(10s) == std::future_status::ready);
+        CATCH_CHECK(future.get() != std::this_thread::get_id());
+    }
+
+    CATCH_SECTION("Coroutines may be resumed on a task runner after a delay")
+    {
+        std::promise<std::chrono::steady_clock::time_point> promise;
+        auto future = promise.get_future();
+
+        const auto start = std::chrono::steady_clock::now();
+        delay(sequenced_runner, 10ms, &promise);
+
+        CATCH_REQUIRE(future.wait_for(10s) == std::future_status::ready);
+        CATCH_CHECK((future.get() - start) >= 10ms);
+    }
+
+    CATCH_SECTION("Coroutines are resumed with a task's result on their original task runner")
+    {
+        std::promise<std::string> promise;
+        auto future = promise.get_future();
+
+        await_result(sequenced_runner, parallel_runner, &promise);
+
+        CATCH_REQUIRE(future.wait_for(10s) == std::future_status::ready);
+        CATCH_CHECK(future.get() == "hello world");
+    }
+
+    CATCH_SECTION("Coroutines may await tasks which return void")
+    {
+        std::promise<bool> promise;
+        auto future = promise.get_future();
+
+        await_void(parallel_runner, &promise);
+
+        CATCH_REQUIRE(future.wait_for(10s) == std::future_status::ready);
+        CATCH_CHECK(future.get());
+    }
+
+    CATCH_SECTION("Coroutines which are never resumed are destroyed")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        std::atomic_bool destroyed {false};
+        bool resumed = false;
+
+        dropped(local_runner, &destroyed, &resumed);
+        CATCH_CHECK_FALSE(destroyed.load());
+
+        CATCH_REQUIRE(task_manager->stop());
+        task_manager.reset();
+        local_runner.reset();
+
+        CATCH_CHECK(destroyed.load());
+        CATCH_CHECK_FALSE(resumed);
+    }
+
+    CATCH_SECTION("Coroutine frames are reused")
+    {
+        void *frame1 = fly::detail::CoroutineFrameAllocator::allocate(100);
+        fly::detail::CoroutineFrameAllocator::deallocate(frame1, 100);
+
+        // Frames in the same size class should be reused.
+        void *frame2 = fly::detail::CoroutineFrameAllocator::allocate(120);
+        CATCH_CHECK(frame1 == frame2);
+
+        void *frame3 = fly::detail::CoroutineFrameAllocator::allocate(100);
+        CATCH_CHECK(frame1 != frame3);
+
+        fly::detail::CoroutineFrameAllocator::deallocate(frame2, 120);
+        fly::detail::CoroutineFrameAllocator::deallocate(frame3, 100);
+    }
+}
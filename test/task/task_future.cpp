@@ -0,0 +1,174 @@
+#include "fly/task/task_future.hpp"
+
+#include "test/util/task_manager.hpp"
+
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+CATCH_TEST_CASE("TaskFuture", "[task]")
+{
+    auto task_runner = fly::test::task_manager()->create_task_runner<fly::ParallelTaskRunner>();
+
+    CATCH_SECTION("Default futures are not associated with a task")
+    {
+        fly::TaskFuture<int> future;
+        CATCH_CHECK_FALSE(future.valid());
+        CATCH_CHECK_FALSE(future.is_ready());
+        CATCH_CHECK_FALSE(future.wait());
+        CATCH_CHECK_FALSE(future.get().has_value());
+    }
+
+    CATCH_SECTION("Futures provide the result of a task")
+    {
+        auto task = []() -> std::string
+        {
+            return "hello";
+        };
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, std::move(task));
+        CATCH_REQUIRE(future.valid());
+
+        auto result = future.get();
+        CATCH_REQUIRE(result.has_value());
+        CATCH_CHECK(*result == "hello");
+        CATCH_CHECK(future.is_ready());
+    }
+
+    CATCH_SECTION("Futures provide whether a void task was executed")
+    {
+        bool task_was_called = false;
+
+        auto task = [&task_was_called]()
+        {
+            task_was_called = true;
+        };
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, std::move(task));
+        CATCH_CHECK(future.get());
+        CATCH_CHECK(task_was_called);
+    }
+
+    CATCH_SECTION("Futures may provide move-only results")
+    {
+        auto task = []()
+        {
+            return std::make_unique<int>(12389);
+        };
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, std::move(task));
+
+        auto result = future.get();
+        CATCH_REQUIRE(result.has_value());
+        CATCH_REQUIRE(*result);
+        CATCH_CHECK(**result == 12389);
+    }
+
+    CATCH_SECTION("Futures of delayed tasks are ready after the delay")
+    {
+        auto task = []()
+        {
+            return std::chrono::steady_clock::now();
+        };
+
+        const auto start = std::chrono::steady_clock::now();
+        auto future =
+            task_runner->post_task_with_delay_and_future(FROM_HERE, std::move(task), 10ms);
+
+        auto result = future.get();
+        CATCH_REQUIRE(result.has_value());
+        CATCH_CHECK((*result - start) >= 10ms);
+    }
+
+    CATCH_SECTION("Futures of dropped tasks are ready without a result")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        auto task = []()
+        {
+            return 1;
+        };
+
+        auto future = local_runner->post_task_with_delay_and_future(FROM_HERE, std::move(task), 1h);
+        CATCH_CHECK_FALSE(future.is_ready());
+
+        CATCH_REQUIRE(task_manager->stop());
+        task_manager.reset();
+
+        CATCH_CHECK(future.is_ready());
+        CATCH_CHECK_FALSE(future.get().has_value());
+    }
+
+    CATCH_SECTION("Worker threads execute other tasks while waiting on a future")
+    {
+        // With a single worker thread, waiting on a future from within a task would deadlock if
+        // the worker simply blocked, as the awaited task could never be executed.
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        auto outer_task = [local_runner]()
+        {
+            auto inner_task = []()
+            {
+                return 12;
+            };
+
+            auto inner_future = local_runner->post_task_with_future(FROM_HERE, inner_task);
+            auto delayed_future = local_runner->post_task_with_delay_and_future(
+                FROM_HERE,
+                std::move(inner_task),
+                1ms);
+
+            return inner_future.get().value_or(0) + delayed_future.get().value_or(0);
+        };
+
+        auto future = local_runner->post_task_with_future(FROM_HERE, std::move(outer_task));
+        CATCH_CHECK(future.get() == 24);
+
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Worker threads waiting on a future are woken when it is completed elsewhere")
+    {
+        // The awaited task is executed on a blocking thread, so the single worker thread has no
+        // tasks to help with and must be woken by the task's completion.
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+        auto blocking_runner =
+            task_manager->create_task_runner<fly::ParallelTaskRunner>(fly::TaskPriority::Blocking);
+
+        auto outer_task = [blocking_runner]()
+        {
+            auto blocking_task = []()
+            {
+                std::this_thread::sleep_for(10ms);
+                return 12;
+            };
+
+            auto blocking_future =
+                blocking_runner->post_task_with_future(FROM_HERE, std::move(blocking_task));
+
+            return blocking_future.get().value_or(0);
+        };
+
+        auto future = local_runner->post_task_with_future(FROM_HERE, std::move(outer_task));
+        CATCH_CHECK(future.get() == 12);
+
+        CATCH_REQUIRE(task_manager->stop());
+    }
+}
@@ -0,0 +1,257 @@
+#include "fly/task/task_graph.hpp"
+
+#include "test/util/task_manager.hpp"
+
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+CATCH_TEST_CASE("TaskGraph", "[task]")
+{
+    auto task_runner = fly::test::task_manager()->create_task_runner<fly::ParallelTaskRunner>();
+
+    CATCH_SECTION("Empty graphs complete immediately")
+    {
+        fly::TaskGraph graph(task_runner);
+        CATCH_CHECK(graph.is_ready());
+
+        CATCH_CHECK(graph.run());
+        CATCH_CHECK(graph.wait());
+        CATCH_CHECK(graph.is_ready());
+    }
+
+    CATCH_SECTION("Dependencies may only be added between existing, distinct nodes")
+    {
+        fly::TaskGraph graph(task_runner);
+
+        auto node1 = graph.add_task(FROM_HERE, []() {});
+        auto node2 = graph.add_task(FROM_HERE, []() {});
+        CATCH_CHECK(graph.size() == 2);
+
+        CATCH_CHECK(graph.add_dependency(node1, node2));
+        CATCH_CHECK_FALSE(graph.add_dependency(node1, node1));
+        CATCH_CHECK_FALSE(graph.add_dependency(node1, 2));
+        CATCH_CHECK_FALSE(graph.add_dependency(2, node2));
+    }
+
+    CATCH_SECTION("Graphs containing a cycle are not run")
+    {
+        fly::TaskGraph graph(task_runner);
+        std::atomic_bool task_was_called = false;
+
+        auto task = [&task_was_called]()
+        {
+            task_was_called = true;
+        };
+
+        auto node1 = graph.add_task(FROM_HERE, task);
+        auto node2 = graph.add_task(FROM_HERE, task);
+        auto node3 = graph.add_task(FROM_HERE, task);
+
+        CATCH_REQUIRE(graph.add_dependency(node1, node2));
+        CATCH_REQUIRE(graph.add_dependency(node2, node3));
+        CATCH_REQUIRE(graph.add_dependency(node3, node2));
+
+        CATCH_CHECK_FALSE(graph.run());
+        CATCH_CHECK(graph.is_ready());
+        CATCH_CHECK_FALSE(task_was_called);
+    }
+
+    CATCH_SECTION("Nodes are executed after all of their dependencies")
+    {
+        fly::TaskGraph graph(task_runner);
+
+        std::mutex order_mutex;
+        std::vector<fly::TaskGraph::NodeId> order;
+
+        auto record = [&order_mutex, &order](fly::TaskGraph::NodeId node)
+        {
+            return [&order_mutex, &order, node]()
+            {
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(node);
+            };
+        };
+
+        // Diamond-shaped graph: parse -> (transform1, transform2) -> encode -> write.
+        auto parse = graph.add_task(FROM_HERE, record(0));
+        auto transform1 = graph.add_task(FROM_HERE, record(1));
+        auto transform2 = graph.add_task(FROM_HERE, record(2));
+        auto encode = graph.add_task(FROM_HERE, record(3));
+        auto write = graph.add_task(FROM_HERE, record(4));
+
+        graph.add_dependency(parse, transform1);
+        graph.add_dependency(parse, transform2);
+        graph.add_dependency(transform1, encode);
+        graph.add_dependency(transform2, encode);
+        graph.add_dependency(encode, write);
+
+        CATCH_REQUIRE(graph.run());
+        CATCH_CHECK(graph.wait());
+
+        CATCH_REQUIRE(order.size() == 5);
+        CATCH_CHECK(order[0] == parse);
+        CATCH_CHECK(((order[1] == transform1) || (order[1] == transform2)));
+        CATCH_CHECK(((order[2] == transform1) || (order[2] == transform2)));
+        CATCH_CHECK(order[3] == encode);
+        CATCH_CHECK(order[4] == write);
+    }
+
+    CATCH_SECTION("Independent nodes may execute concurrently")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(2);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+        fly::TaskGraph graph(local_runner);
+
+        std::atomic<std::uint32_t> running = 0;
+        std::atomic_bool ran_concurrently = false;
+
+        auto task = [&running, &ran_concurrently]()
+        {
+            ++running;
+
+            const auto deadline = std::chrono::steady_clock::now() + 1s;
+
+            while (!ran_concurrently.load() && (std::chrono::steady_clock::now() < deadline))
+            {
+                if (running.load() > 1)
+                {
+                    ran_concurrently = true;
+                }
+            }
+
+            --running;
+        };
+
+        graph.add_task(FROM_HERE, task);
+        graph.add_task(FROM_HERE, task);
+
+        CATCH_REQUIRE(graph.run());
+        CATCH_CHECK(graph.wait());
+        CATCH_CHECK(ran_concurrently);
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Graphs may be run repeatedly")
+    {
+        fly::TaskGraph graph(task_runner);
+        std::atomic<std::uint32_t> calls = 0;
+
+        auto task = [&calls]()
+        {
+            ++calls;
+        };
+
+        fly::TaskGraph::NodeId previous = graph.add_task(FROM_HERE, task);
+
+        for (int i = 0; i < 9; ++i)
+        {
+            auto node = graph.add_task(FROM_HERE, task);
+            graph.add_dependency(previous, node);
+            previous = node;
+        }
+
+        for (std::uint32_t run = 1; run <= 10; ++run)
+        {
+            CATCH_REQUIRE(graph.run());
+            CATCH_CHECK(graph.wait());
+            CATCH_CHECK(calls == run * 10);
+        }
+    }
+
+    CATCH_SECTION("Graphs may not be run while already running")
+    {
+        fly::TaskGraph graph(task_runner);
+        std::atomic_bool release = false;
+
+        graph.add_task(
+            FROM_HERE,
+            [&release]()
+            {
+                while (!release.load())
+                {
+                    std::this_thread::yield();
+                }
+            });
+
+        CATCH_REQUIRE(graph.run());
+        CATCH_CHECK_FALSE(graph.is_ready());
+        CATCH_CHECK_FALSE(graph.run());
+
+        release = true;
+        CATCH_CHECK(graph.wait());
+    }
+
+    CATCH_SECTION("Graphs may be waited on from within a task")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+        fly::TaskGraph graph(local_runner);
+
+        std::atomic<std::uint32_t> calls = 0;
+
+        auto task = [&calls]()
+        {
+            ++calls;
+        };
+
+        auto node1 = graph.add_task(FROM_HERE, task);
+        auto node2 = graph.add_task(FROM_HERE, task);
+        graph.add_dependency(node1, node2);
+
+        auto future = local_runner->post_task_with_future(
+            FROM_HERE,
+            [&graph]()
+            {
+                return graph.run() && graph.wait();
+            });
+
+        auto result = future.get();
+        CATCH_REQUIRE(result.has_value());
+        CATCH_CHECK(*result);
+        CATCH_CHECK(calls == 2);
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Runs complete without executing dependents of dropped nodes")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        fly::TaskGraph graph(local_runner);
+        std::atomic_bool task_was_called = false;
+
+        auto task = [&task_was_called]()
+        {
+            task_was_called = true;
+        };
+
+        auto node1 = graph.add_task(FROM_HERE, task);
+        auto node2 = graph.add_task(FROM_HERE, task);
+        graph.add_dependency(node1, node2);
+
+        task_manager.reset();
+
+        CATCH_REQUIRE(graph.run());
+        CATCH_CHECK(graph.is_ready());
+        CATCH_CHECK_FALSE(graph.wait());
+        CATCH_CHECK_FALSE(task_was_called);
+    }
+}
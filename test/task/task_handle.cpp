@@ -0,0 +1,178 @@
+#include "fly/task/task_handle.hpp"
+
+#include "test/util/task_manager.hpp"
+
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+CATCH_TEST_CASE("TaskHandle", "[task]")
+{
+    auto task_runner = fly::test::task_manager()->create_task_runner<fly::ParallelTaskRunner>();
+
+    CATCH_SECTION("Default handles are not associated with a task")
+    {
+        fly::TaskHandle handle;
+        CATCH_CHECK_FALSE(handle.valid());
+        CATCH_CHECK_FALSE(handle);
+        CATCH_CHECK_FALSE(handle.is_pending());
+        CATCH_CHECK_FALSE(handle.cancel());
+    }
+
+    CATCH_SECTION("Cancelled delayed tasks are not executed")
+    {
+        std::atomic_bool task_was_called = false;
+
+        auto task = [&task_was_called]()
+        {
+            task_was_called = true;
+        };
+
+        auto handle = task_runner->post_task_with_delay(FROM_HERE, std::move(task), 10ms);
+        CATCH_REQUIRE(handle.valid());
+        CATCH_CHECK(handle.is_pending());
+
+        CATCH_CHECK(handle.cancel());
+        CATCH_CHECK_FALSE(handle.is_pending());
+        CATCH_CHECK_FALSE(handle.cancel());
+
+        auto future = task_runner->post_task_with_delay_and_future(FROM_HERE, []() {}, 20ms);
+        CATCH_CHECK(future.wait());
+        CATCH_CHECK_FALSE(task_was_called);
+    }
+
+    CATCH_SECTION("Cancelled delayed tasks are destroyed immediately")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        auto owner = std::make_shared<int>(12389);
+        std::weak_ptr<int> weak_owner = owner;
+
+        auto task = [owner = std::move(owner)]()
+        {
+            FLY_UNUSED(owner);
+        };
+
+        auto handle = local_runner->post_task_with_delay(FROM_HERE, std::move(task), 1h);
+        CATCH_CHECK_FALSE(weak_owner.expired());
+
+        CATCH_CHECK(handle.cancel());
+        CATCH_CHECK(weak_owner.expired());
+
+        CATCH_CHECK(task_manager->stop());
+    }
+
+    CATCH_SECTION("Expired delayed tasks may not be cancelled")
+    {
+        auto task = []()
+        {
+        };
+
+        auto handle = task_runner->post_task_with_delay(FROM_HERE, std::move(task), 1ms);
+        CATCH_REQUIRE(handle.valid());
+
+        while (handle.is_pending())
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        CATCH_CHECK_FALSE(handle.cancel());
+    }
+
+    CATCH_SECTION("Handles do not cancel newer tasks which reuse their slot")
+    {
+        auto task = []()
+        {
+        };
+
+        auto handle1 = task_runner->post_task_with_delay(FROM_HERE, task, 1h);
+        CATCH_REQUIRE(handle1.cancel());
+
+        auto handle2 = task_runner->post_task_with_delay(FROM_HERE, task, 1h);
+        CATCH_CHECK_FALSE(handle1.is_pending());
+        CATCH_CHECK_FALSE(handle1.cancel());
+
+        CATCH_CHECK(handle2.is_pending());
+        CATCH_CHECK(handle2.cancel());
+    }
+
+    CATCH_SECTION("Cancelling tasks leaves the remaining tasks in scheduled order")
+    {
+        // Expired tasks are handed to the sequenced task runner in the order they are popped from
+        // the timer heap, so the execution order reflects the order of the heap.
+        auto sequenced_runner =
+            fly::test::task_manager()->create_task_runner<fly::SequencedTaskRunner>();
+
+        constexpr std::uint32_t s_tasks = 64;
+
+        std::vector<std::uint32_t> order;
+        std::vector<fly::TaskHandle> handles;
+
+        // Post tasks in an order which does not match their scheduled order.
+        auto scheduled_index = [](std::uint32_t i)
+        {
+            return (i * 37) % s_tasks;
+        };
+
+        for (std::uint32_t i = 0; i < s_tasks; ++i)
+        {
+            auto task = [&order, index = scheduled_index(i)]()
+            {
+                order.push_back(index);
+            };
+
+            // Delays are spaced widely enough that the time taken to post the tasks does not
+            // affect their scheduled order.
+            const auto delay = 10ms + std::chrono::milliseconds(scheduled_index(i) * 2);
+            handles.push_back(
+                sequenced_runner->post_task_with_delay(FROM_HERE, std::move(task), delay));
+        }
+
+        for (std::uint32_t i = 0; i < s_tasks; i += 3)
+        {
+            CATCH_CHECK(handles[i].cancel());
+        }
+
+        auto future = sequenced_runner->post_task_with_delay_and_future(FROM_HERE, []() {}, 200ms);
+        CATCH_REQUIRE(future.wait());
+
+        std::vector<std::uint32_t> expected;
+
+        for (std::uint32_t i = 0; i < s_tasks; ++i)
+        {
+            if ((i % 3) != 0)
+            {
+                expected.push_back(scheduled_index(i));
+            }
+        }
+
+        std::sort(expected.begin(), expected.end());
+        CATCH_CHECK(order == expected);
+    }
+
+    CATCH_SECTION("Handles are invalid if the task manager has been deleted")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1);
+        auto local_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        task_manager.reset();
+
+        auto handle = local_runner->post_task_with_delay(FROM_HERE, []() {}, 1ms);
+        CATCH_CHECK_FALSE(handle.valid());
+        CATCH_CHECK_FALSE(handle.cancel());
+    }
+}
@@ -0,0 +1,267 @@
+#include "fly/task/task_metrics.hpp"
+
+#include "test/util/waitable_task_runner.hpp"
+
+#include "fly/task/task_config.hpp"
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/**
+ * Subclass of the task config to allow changing default values.
+ */
+class MutableTaskConfig : public fly::TaskConfig
+{
+public:
+    void enable_instrumentation()
+    {
+        m_default_instrument_tasks = true;
+    }
+
+    void set_sequenced_batch_size(std::uint32_t batch_size)
+    {
+        m_default_sequenced_batch_size = batch_size;
+    }
+};
+
+/**
+ * Find the instrumentation recorded for tasks posted from the given location.
+ */
+const fly::TaskMetrics *
+find_metrics(const std::vector<fly::TaskMetrics> &snapshot, const fly::TaskLocation &location)
+{
+    for (const auto &metrics : snapshot)
+    {
+        if ((metrics.m_location.m_file == location.m_file) &&
+            (metrics.m_location.m_function == location.m_function) &&
+            (metrics.m_location.m_line == location.m_line))
+        {
+            return &metrics;
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace
+
+CATCH_TEST_CASE("LogLinearHistogram", "[task]")
+{
+    using Histogram = fly::LogLinearHistogram;
+
+    CATCH_SECTION("Small values are stored in exact buckets")
+    {
+        for (std::uint64_t value = 0; value < Histogram::s_sub_bucket_count * 2; ++value)
+        {
+            const std::size_t index = Histogram::bucket_index(value);
+
+            CATCH_CHECK(index == value);
+            CATCH_CHECK(Histogram::bucket_lower_bound(index) == value);
+            CATCH_CHECK(Histogram::bucket_upper_bound(index) == value);
+        }
+    }
+
+    CATCH_SECTION("Every value lies within the bounds of its bucket")
+    {
+        for (std::uint64_t value = 1; value < (1u << 20); value = (value * 3) / 2 + 1)
+        {
+            const std::size_t index = Histogram::bucket_index(value);
+
+            CATCH_CHECK(Histogram::bucket_lower_bound(index) <= value);
+            CATCH_CHECK(Histogram::bucket_upper_bound(index) >= value);
+        }
+
+        const auto max = std::numeric_limits<std::uint64_t>::max();
+        CATCH_CHECK(Histogram::bucket_index(max) == Histogram::s_bucket_count - 1);
+        CATCH_CHECK(Histogram::bucket_upper_bound(Histogram::s_bucket_count - 1) == max);
+    }
+
+    CATCH_SECTION("Buckets are contiguous and bounded in relative width")
+    {
+        for (std::size_t index = 1; index < Histogram::s_bucket_count; ++index)
+        {
+            const std::uint64_t lower = Histogram::bucket_lower_bound(index);
+            const std::uint64_t upper = Histogram::bucket_upper_bound(index);
+
+            CATCH_CHECK(lower == Histogram::bucket_upper_bound(index - 1) + 1);
+            CATCH_CHECK((upper - lower) <= (lower / Histogram::s_sub_bucket_count));
+        }
+    }
+
+    CATCH_SECTION("Percentiles are approximated by bucket upper bounds")
+    {
+        Histogram histogram;
+        CATCH_CHECK(histogram.percentile(50.0) == 0);
+
+        for (std::uint64_t value = 1; value <= 100; ++value)
+        {
+            histogram.record(value);
+        }
+
+        CATCH_CHECK(histogram.count() == 100);
+
+        const std::uint64_t median = histogram.percentile(50.0);
+        CATCH_CHECK(median >= 50);
+        CATCH_CHECK(median <= 50 + (50 / Histogram::s_sub_bucket_count));
+
+        CATCH_CHECK(histogram.percentile(0.0) == 1);
+        CATCH_CHECK(histogram.percentile(100.0) >= 100);
+    }
+
+    CATCH_SECTION("Merging histograms combines their counts")
+    {
+        Histogram histogram1;
+        histogram1.record(10, 3);
+
+        Histogram histogram2;
+        histogram2.record(10);
+        histogram2.record(1000);
+
+        histogram1.merge(histogram2);
+
+        CATCH_CHECK(histogram1.count() == 5);
+        CATCH_CHECK(histogram1.bucket(Histogram::bucket_index(10)) == 4);
+        CATCH_CHECK(histogram1.bucket(Histogram::bucket_index(1000)) == 1);
+    }
+}
+
+CATCH_TEST_CASE("TaskMetrics", "[task]")
+{
+    auto config = std::make_shared<MutableTaskConfig>();
+
+    auto noop = []()
+    {
+    };
+
+    CATCH_SECTION("Instrumentation is disabled by default")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, noop));
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        CATCH_CHECK(task_manager->task_metrics().empty());
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Tasks are grouped by the location from which they were posted")
+    {
+        static constexpr int s_num_tasks = 10;
+        config->enable_instrumentation();
+
+        auto task_manager = std::make_shared<fly::TaskManager>(2, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+
+        auto sleeping_task = []()
+        {
+            std::this_thread::sleep_for(1ms);
+        };
+
+        const fly::TaskLocation location1 = FROM_HERE;
+        const fly::TaskLocation location2 = FROM_HERE;
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(fly::TaskLocation(location1), sleeping_task));
+            CATCH_REQUIRE(task_runner->post_task(fly::TaskLocation(location2), noop));
+        }
+
+        for (int i = 0; i < s_num_tasks * 2; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        const auto snapshot = task_manager->task_metrics();
+
+        const fly::TaskMetrics *metrics1 = find_metrics(snapshot, location1);
+        CATCH_REQUIRE(metrics1 != nullptr);
+        CATCH_CHECK(metrics1->m_execution_time.count() == s_num_tasks);
+        CATCH_CHECK(metrics1->m_queue_delay.count() == s_num_tasks);
+        CATCH_CHECK(metrics1->m_execution_time.percentile(0.0) >= 1'000'000);
+
+        const fly::TaskMetrics *metrics2 = find_metrics(snapshot, location2);
+        CATCH_REQUIRE(metrics2 != nullptr);
+        CATCH_CHECK(metrics2->m_execution_time.count() == s_num_tasks);
+        CATCH_CHECK(metrics2->m_queue_delay.count() == s_num_tasks);
+
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Queueing delay of delayed tasks is measured from their scheduled time")
+    {
+        config->enable_instrumentation();
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+
+        const fly::TaskLocation location = FROM_HERE;
+        CATCH_REQUIRE(task_runner->post_task_with_delay(fly::TaskLocation(location), noop, 50ms));
+
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        const auto snapshot = task_manager->task_metrics();
+
+        const fly::TaskMetrics *metrics = find_metrics(snapshot, location);
+        CATCH_REQUIRE(metrics != nullptr);
+        CATCH_CHECK(metrics->m_queue_delay.count() == 1);
+        CATCH_CHECK(metrics->m_queue_delay.percentile(100.0) < 50'000'000);
+
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Batched sequenced tasks are recorded individually")
+    {
+        static constexpr int s_num_tasks = 20;
+
+        config->enable_instrumentation();
+        config->set_sequenced_batch_size(s_num_tasks);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        const fly::TaskLocation location = FROM_HERE;
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(fly::TaskLocation(location), noop));
+        }
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        const auto snapshot = task_manager->task_metrics();
+
+        const fly::TaskMetrics *metrics = find_metrics(snapshot, location);
+        CATCH_REQUIRE(metrics != nullptr);
+        CATCH_CHECK(metrics->m_execution_time.count() == s_num_tasks);
+
+        CATCH_REQUIRE(task_manager->stop());
+    }
+}
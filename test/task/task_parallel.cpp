@@ -0,0 +1,282 @@
+#include "fly/task/task_parallel.hpp"
+
+#include "test/util/task_manager.hpp"
+
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+CATCH_TEST_CASE("TaskParallel", "[task]")
+{
+    fly::TaskManager *task_manager = fly::test::task_manager();
+
+    CATCH_SECTION("Parallel loops invoke the function for each index exactly once")
+    {
+        constexpr std::size_t s_size = 100'000;
+        std::vector<std::atomic<std::uint32_t>> counts(s_size);
+
+        auto function = [&counts](std::size_t index)
+        {
+            ++counts[index];
+        };
+
+        task_manager->parallel_for(FROM_HERE, std::size_t(0), s_size, function);
+
+        auto visited_once = [](const std::atomic<std::uint32_t> &count)
+        {
+            return count.load() == 1;
+        };
+
+        CATCH_CHECK(std::all_of(counts.begin(), counts.end(), visited_once));
+    }
+
+    CATCH_SECTION("Parallel loops may iterate over iterators")
+    {
+        std::vector<int> values(10'000);
+        std::iota(values.begin(), values.end(), 0);
+
+        auto function = [](std::vector<int>::iterator it)
+        {
+            *it *= 2;
+        };
+
+        task_manager->parallel_for(FROM_HERE, values.begin(), values.end(), function, 64);
+
+        std::vector<int> expected(values.size());
+        std::iota(expected.begin(), expected.end(), 0);
+        std::transform(
+            expected.begin(),
+            expected.end(),
+            expected.begin(),
+            [](int value)
+            {
+                return value * 2;
+            });
+
+        CATCH_CHECK(values == expected);
+    }
+
+    CATCH_SECTION("Parallel loops over empty ranges do nothing")
+    {
+        bool function_was_called = false;
+
+        auto function = [&function_was_called](int)
+        {
+            function_was_called = true;
+        };
+
+        task_manager->parallel_for(FROM_HERE, 10, 10, function);
+        task_manager->parallel_for(FROM_HERE, 10, 0, function);
+
+        CATCH_CHECK_FALSE(function_was_called);
+    }
+
+    CATCH_SECTION("Parallel reductions reduce every transformed element")
+    {
+        std::vector<std::uint64_t> values(100'000);
+        std::iota(values.begin(), values.end(), 1);
+
+        auto square = [](std::uint64_t value)
+        {
+            return value * value;
+        };
+
+        const std::uint64_t expected = std::transform_reduce(
+            values.begin(),
+            values.end(),
+            std::uint64_t(12),
+            std::plus<>(),
+            square);
+
+        const std::uint64_t result = task_manager->parallel_transform_reduce(
+            FROM_HERE,
+            values.begin(),
+            values.end(),
+            std::uint64_t(12),
+            std::plus<>(),
+            square);
+
+        CATCH_CHECK(result == expected);
+    }
+
+    CATCH_SECTION("Parallel reductions over empty ranges result in the initial value")
+    {
+        std::vector<int> values;
+
+        auto identity = [](int value)
+        {
+            return value;
+        };
+
+        const int result = task_manager->parallel_transform_reduce(
+            FROM_HERE,
+            values.begin(),
+            values.end(),
+            12389,
+            std::plus<>(),
+            identity);
+
+        CATCH_CHECK(result == 12389);
+    }
+
+    CATCH_SECTION("Parallel sorts order the range")
+    {
+        std::mt19937 engine(12389);
+        std::uniform_int_distribution<int> distribution;
+
+        constexpr std::size_t s_sizes[] = {0, 1, 100, 5'000, 100'000};
+
+        for (std::size_t size : s_sizes)
+        {
+            std::vector<int> values(size);
+            std::generate(values.begin(), values.end(), std::bind(distribution, engine));
+
+            std::vector<int> expected = values;
+            std::sort(expected.begin(), expected.end());
+
+            task_manager->parallel_sort(FROM_HERE, values.begin(), values.end());
+            CATCH_CHECK(values == expected);
+
+            std::sort(expected.begin(), expected.end(), std::greater<>());
+
+            task_manager->parallel_sort(FROM_HERE, values.begin(), values.end(), std::greater<>());
+            CATCH_CHECK(values == expected);
+        }
+    }
+
+    CATCH_SECTION("Parallel sorts merge blocks across several worker threads")
+    {
+        auto local_manager = std::make_shared<fly::TaskManager>(4);
+        CATCH_REQUIRE(local_manager->start());
+
+        std::mt19937 engine(12389);
+        std::uniform_int_distribution<int> distribution(0, 100);
+
+        constexpr std::size_t s_sizes[] = {5'000, 100'003, 250'000};
+
+        for (std::size_t size : s_sizes)
+        {
+            // Sort move-only values with many duplicates.
+            std::vector<std::unique_ptr<int>> values(size);
+            std::vector<int> expected(size);
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                expected[i] = distribution(engine);
+                values[i] = std::make_unique<int>(expected[i]);
+            }
+
+            std::sort(expected.begin(), expected.end());
+
+            local_manager->parallel_sort(
+                FROM_HERE,
+                values.begin(),
+                values.end(),
+                [](const auto &value1, const auto &value2)
+                {
+                    return *value1 < *value2;
+                });
+
+            std::vector<int> actual;
+
+            for (const auto &value : values)
+            {
+                actual.push_back(value ? *value : -1);
+            }
+
+            CATCH_CHECK(actual == expected);
+        }
+
+        CATCH_REQUIRE(local_manager->stop());
+    }
+
+    CATCH_SECTION("Parallel algorithms may be invoked from within a task")
+    {
+        // With a single worker thread, the worker executing the task must execute the entire loop
+        // itself, rather than waiting on itself to execute the posted helper tasks.
+        auto local_manager = std::make_shared<fly::TaskManager>(1);
+        CATCH_REQUIRE(local_manager->start());
+
+        auto task_runner = local_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        auto task = [&local_manager]()
+        {
+            std::vector<int> values(10'000, 1);
+
+            auto identity = [](int value)
+            {
+                return value;
+            };
+
+            return local_manager->parallel_transform_reduce(
+                FROM_HERE,
+                values.begin(),
+                values.end(),
+                0,
+                std::plus<>(),
+                identity);
+        };
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, std::move(task));
+        CATCH_CHECK(future.get() == 10'000);
+
+        CATCH_REQUIRE(local_manager->stop());
+    }
+
+    CATCH_SECTION("Exceptions thrown on worker threads are rethrown to the calling thread")
+    {
+        auto local_manager = std::make_shared<fly::TaskManager>(2);
+        CATCH_REQUIRE(local_manager->start());
+
+        const auto calling_thread = std::this_thread::get_id();
+        std::atomic_bool helper_threw {false};
+
+        auto function = [&calling_thread, &helper_threw](std::size_t)
+        {
+            if (std::this_thread::get_id() != calling_thread)
+            {
+                helper_threw.store(true);
+                throw std::runtime_error("helper");
+            }
+
+            // Keep the calling thread busy until a worker thread has joined the loop and thrown.
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+            while (!helper_threw.load() && (std::chrono::steady_clock::now() < deadline))
+            {
+                std::this_thread::yield();
+            }
+        };
+
+        CATCH_CHECK_THROWS_AS(
+            local_manager->parallel_for(FROM_HERE, std::size_t(0), std::size_t(100), function, 1),
+            std::runtime_error);
+        CATCH_CHECK(helper_threw.load());
+
+        CATCH_REQUIRE(local_manager->stop());
+    }
+
+    CATCH_SECTION("Parallel algorithms execute on the calling thread if the manager is stopped")
+    {
+        auto local_manager = std::make_shared<fly::TaskManager>(4);
+
+        std::vector<int> values(10'000);
+        std::iota(values.rbegin(), values.rend(), 0);
+
+        local_manager->parallel_sort(FROM_HERE, values.begin(), values.end());
+        CATCH_CHECK(std::is_sorted(values.begin(), values.end()));
+    }
+}
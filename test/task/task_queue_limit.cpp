@@ -0,0 +1,110 @@
+#include "fly/task/task_queue_limit.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+
+using namespace std::chrono_literals;
+
+CATCH_TEST_CASE("TaskQueueLimit", "[task]")
+{
+    fly::detail::TaskQueueDepth depth;
+
+    CATCH_SECTION("Unbounded queues always have capacity")
+    {
+        CATCH_CHECK_FALSE(depth.is_bounded());
+        CATCH_CHECK(depth.try_reserve(1000));
+        CATCH_CHECK(depth.has_capacity(1000));
+        CATCH_CHECK(depth.overflow(1000) == 0);
+        CATCH_CHECK(depth.reserve(1000) == 0);
+
+        const fly::TaskQueueMetrics metrics = depth.metrics();
+        CATCH_CHECK(metrics.m_depth == 2000);
+        CATCH_CHECK(metrics.m_peak_depth == 2000);
+        CATCH_CHECK(metrics.m_capacity == 0);
+    }
+
+    CATCH_SECTION("Bounded queues only reserve space up to their capacity")
+    {
+        depth.set_limit({4, fly::TaskQueuePolicy::Reject});
+        CATCH_CHECK(depth.is_bounded());
+
+        CATCH_CHECK(depth.try_reserve(3));
+        CATCH_CHECK(depth.has_capacity(1));
+        CATCH_CHECK_FALSE(depth.has_capacity(2));
+        CATCH_CHECK(depth.overflow(3) == 2);
+        CATCH_CHECK_FALSE(depth.try_reserve(2));
+        CATCH_CHECK(depth.try_reserve(1));
+
+        depth.release(2);
+        CATCH_CHECK(depth.try_reserve(2));
+
+        const fly::TaskQueueMetrics metrics = depth.metrics();
+        CATCH_CHECK(metrics.m_depth == 4);
+        CATCH_CHECK(metrics.m_peak_depth == 4);
+        CATCH_CHECK(metrics.m_capacity == 4);
+    }
+
+    CATCH_SECTION("Empty queues reserve space for batches larger than their capacity")
+    {
+        depth.set_limit({4, fly::TaskQueuePolicy::Reject});
+
+        CATCH_CHECK(depth.has_capacity(10));
+        CATCH_CHECK(depth.try_reserve(10));
+        CATCH_CHECK_FALSE(depth.try_reserve(1));
+    }
+
+    CATCH_SECTION("Unconditional reservations report the overflow of the queue")
+    {
+        depth.set_limit({4, fly::TaskQueuePolicy::DropOldest});
+
+        CATCH_CHECK(depth.reserve(3) == 0);
+        CATCH_CHECK(depth.reserve(3) == 2);
+        CATCH_CHECK(depth.metrics().m_depth == 6);
+    }
+
+    CATCH_SECTION("Rejected and dropped tasks are recorded")
+    {
+        depth.record_rejected(3);
+        depth.record_dropped(4);
+        depth.record_rejected(1);
+
+        const fly::TaskQueueMetrics metrics = depth.metrics();
+        CATCH_CHECK(metrics.m_rejected == 4);
+        CATCH_CHECK(metrics.m_dropped == 4);
+    }
+
+    CATCH_SECTION("Waiting threads are woken when space is released")
+    {
+        depth.set_limit({1, fly::TaskQueuePolicy::Block});
+        CATCH_REQUIRE(depth.try_reserve(1));
+
+        std::atomic<std::uint32_t> helper_calls = 0;
+
+        auto waiter = std::async(
+            std::launch::async,
+            [&depth, &helper_calls]()
+            {
+                depth.wait_until(
+                    [&depth]()
+                    {
+                        return depth.try_reserve(1);
+                    },
+                    [&helper_calls]()
+                    {
+                        ++helper_calls;
+                        return false;
+                    });
+            });
+
+        CATCH_CHECK(waiter.wait_for(20ms) == std::future_status::timeout);
+        CATCH_CHECK(helper_calls > 0);
+
+        depth.release(1);
+        CATCH_CHECK(waiter.wait_for(5s) == std::future_status::ready);
+        CATCH_CHECK(depth.metrics().m_depth == 1);
+    }
+}
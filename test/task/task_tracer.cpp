@@ -0,0 +1,269 @@
+#include "fly/task/task_tracer.hpp"
+
+#include "test/util/waitable_task_runner.hpp"
+
+#include "fly/task/task_config.hpp"
+#include "fly/task/task_manager.hpp"
+#include "fly/task/task_runner.hpp"
+#include "fly/types/json/json.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/**
+ * Subclass of the task config to allow changing default values.
+ */
+class MutableTaskConfig : public fly::TaskConfig
+{
+public:
+    void enable_tracing(std::uint32_t buffer_size)
+    {
+        m_default_trace_tasks = true;
+        m_default_trace_buffer_size = buffer_size;
+    }
+};
+
+/**
+ * Count the number of events in a trace with the given phase.
+ */
+std::size_t count_events(const fly::Json &trace, const char *phase)
+{
+    std::size_t count = 0;
+
+    for (const auto &event : trace.at("traceEvents"))
+    {
+        if (event.at("ph") == phase)
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+} // namespace
+
+CATCH_TEST_CASE("TaskTracer", "[task]")
+{
+    auto config = std::make_shared<MutableTaskConfig>();
+
+    auto sleeping_task = []()
+    {
+        std::this_thread::sleep_for(1ms);
+    };
+
+    CATCH_SECTION("Tracing is disabled by default")
+    {
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableParallelTaskRunner>();
+
+        CATCH_REQUIRE(task_runner->post_task(FROM_HERE, sleeping_task));
+        task_runner->wait_for_task_to_complete(__FILE__);
+
+        CATCH_CHECK(task_manager->task_trace().is_null());
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Each task is traced as a complete event")
+    {
+        static constexpr int s_num_tasks = 10;
+        config->enable_tracing(100);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(2, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        const fly::TaskLocation location = FROM_HERE;
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(fly::TaskLocation(location), sleeping_task));
+        }
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        const fly::Json trace = task_manager->task_trace();
+        CATCH_REQUIRE(trace.contains("traceEvents"));
+
+        CATCH_CHECK(count_events(trace, "X") == s_num_tasks);
+
+        // One process name and one thread name per worker thread.
+        CATCH_CHECK(count_events(trace, "M") == 3);
+
+        for (const auto &event : trace.at("traceEvents"))
+        {
+            if (event.at("ph") == "X")
+            {
+                CATCH_CHECK(event.at("name") == location.m_function);
+                CATCH_CHECK(event.at("cat") == "task");
+                CATCH_CHECK(event.at("args").at("file") == location.m_file);
+                CATCH_CHECK(event.at("args").at("line") == location.m_line);
+                CATCH_CHECK(event.at("args").contains("queue_delay_us"));
+                CATCH_CHECK(double(event.at("dur")) >= 0.0);
+                CATCH_CHECK(event.contains("tid"));
+            }
+        }
+
+        std::stringstream stream;
+        stream << trace;
+        CATCH_CHECK(stream.str().starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Events are ordered on each thread")
+    {
+        static constexpr int s_num_tasks = 5;
+        config->enable_tracing(100);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, sleeping_task));
+        }
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        const fly::Json trace = task_manager->task_trace();
+        double last_end = -1.0;
+
+        for (const auto &event : trace.at("traceEvents"))
+        {
+            if (event.at("ph") == "X")
+            {
+                const auto timestamp = double(event.at("ts"));
+                CATCH_CHECK(timestamp >= last_end);
+
+                last_end = timestamp + double(event.at("dur"));
+            }
+        }
+
+        CATCH_CHECK(count_events(trace, "X") == s_num_tasks);
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Tasks executed while another task waits are nested within that task")
+    {
+        config->enable_tracing(100);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner = task_manager->create_task_runner<fly::ParallelTaskRunner>();
+
+        // With a single worker thread, the inner task is executed by the outer task's thread while
+        // the outer task waits on its result, and is therefore recorded first.
+        auto outer_task = [&task_runner, &sleeping_task]()
+        {
+            auto future = task_runner->post_task_with_future(FROM_HERE, sleeping_task);
+            future.wait();
+        };
+
+        auto future = task_runner->post_task_with_future(FROM_HERE, outer_task);
+        future.wait();
+
+        CATCH_REQUIRE(task_manager->stop());
+
+        const fly::Json trace = task_manager->task_trace();
+        CATCH_REQUIRE(count_events(trace, "X") == 2);
+
+        std::vector<std::pair<double, double>> spans;
+
+        for (const auto &event : trace.at("traceEvents"))
+        {
+            if (event.at("ph") == "X")
+            {
+                const auto timestamp = double(event.at("ts"));
+                spans.emplace_back(timestamp, timestamp + double(event.at("dur")));
+            }
+        }
+
+        const auto &[inner_start, inner_end] = spans[0];
+        const auto &[outer_start, outer_end] = spans[1];
+
+        CATCH_CHECK(outer_start <= inner_start);
+        CATCH_CHECK(inner_end <= outer_end);
+    }
+
+    CATCH_SECTION("Only the most recent tasks are retained in the ring buffer")
+    {
+        static constexpr int s_num_tasks = 20;
+        static constexpr std::uint32_t s_buffer_size = 4;
+        config->enable_tracing(s_buffer_size);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+        CATCH_REQUIRE(task_manager->start());
+
+        auto task_runner =
+            task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, sleeping_task));
+        }
+
+        for (int i = 0; i < s_num_tasks; ++i)
+        {
+            task_runner->wait_for_task_to_complete(__FILE__);
+        }
+
+        const fly::Json trace = task_manager->task_trace();
+        CATCH_CHECK(count_events(trace, "X") == s_buffer_size);
+
+        CATCH_REQUIRE(task_manager->stop());
+    }
+
+    CATCH_SECTION("Worker threads which are restarted reuse their trace")
+    {
+        config->enable_tracing(100);
+
+        auto task_manager = std::make_shared<fly::TaskManager>(1, config);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            CATCH_REQUIRE(task_manager->start());
+
+            auto task_runner =
+                task_manager->create_task_runner<fly::test::WaitableSequencedTaskRunner>();
+
+            CATCH_REQUIRE(task_runner->post_task(FROM_HERE, sleeping_task));
+            task_runner->wait_for_task_to_complete(__FILE__);
+
+            CATCH_REQUIRE(task_manager->stop());
+        }
+
+        const fly::Json trace = task_manager->task_trace();
+        CATCH_CHECK(count_events(trace, "X") == 3);
+
+        // One process name and a single thread name for the restarted worker thread.
+        CATCH_CHECK(count_events(trace, "M") == 2);
+    }
+}
@@ -1,5 +1,8 @@
+#include "fly/types/concurrency/bounded_lock_free_queue.hpp"
 #include "fly/types/concurrency/concurrent_queue.hpp"
 #include "fly/types/concurrency/concurrent_stack.hpp"
+#include "fly/types/concurrency/lock_free_queue.hpp"
+#include "fly/types/concurrency/lock_free_stack.hpp"
 #include "fly/types/numeric/literals.hpp"
 
 #include "catch2/catch.hpp"
@@ -8,6 +11,8 @@
 #include <chrono>
 #include <functional>
 #include <future>
+#include <memory>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -16,7 +21,11 @@ using namespace fly::literals::numeric_literals;
 CATCH_TEMPLATE_PRODUCT_TEST_CASE(
     "ConcurrentContainer",
     "[concurrency]",
-    (fly::ConcurrentQueue, fly::ConcurrentStack),
+    (fly::ConcurrentQueue,
+     fly::ConcurrentStack,
+     fly::BoundedLockFreeQueue,
+     fly::LockFreeQueue,
+     fly::LockFreeStack),
     (std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t))
 {
     using size_type = typename TestType::size_type;
@@ -77,7 +86,10 @@ CATCH_TEMPLATE_PRODUCT_TEST_CASE(
         push(obj2, ++size);
         push(obj3, ++size);
 
-        if (std::is_same_v<TestType, fly::ConcurrentQueue<value_type>>)
+        constexpr bool is_stack = std::is_same_v<TestType, fly::ConcurrentStack<value_type>> ||
+            std::is_same_v<TestType, fly::LockFreeStack<value_type>>;
+
+        if constexpr (!is_stack)
         {
             pop(obj1, --size);
             pop(obj2, --size);
@@ -191,3 +203,371 @@ CATCH_TEMPLATE_PRODUCT_TEST_CASE(
         CATCH_CHECK(future.get() == obj);
     }
 }
+
+CATCH_TEST_CASE("BoundedLockFreeQueue", "[concurrency]")
+{
+    CATCH_SECTION("Capacity is rounded up to a power of two")
+    {
+        CATCH_CHECK(fly::BoundedLockFreeQueue<int>(0).capacity() == 2);
+        CATCH_CHECK(fly::BoundedLockFreeQueue<int>(3).capacity() == 4);
+        CATCH_CHECK(fly::BoundedLockFreeQueue<int>(64).capacity() == 64);
+        CATCH_CHECK(fly::BoundedLockFreeQueue<int>().capacity() == 1024);
+    }
+
+    CATCH_SECTION("Cannot push onto a full queue without blocking")
+    {
+        fly::BoundedLockFreeQueue<std::unique_ptr<int>> queue(2);
+
+        CATCH_CHECK(queue.try_push(std::make_unique<int>(1)));
+        CATCH_CHECK(queue.try_push(std::make_unique<int>(2)));
+
+        auto item = std::make_unique<int>(3);
+        CATCH_CHECK_FALSE(queue.try_push(std::move(item)));
+        CATCH_REQUIRE(item);
+        CATCH_CHECK(queue.size() == 2);
+
+        std::unique_ptr<int> popped;
+        CATCH_REQUIRE(queue.try_pop(popped));
+        CATCH_CHECK(*popped == 1);
+
+        CATCH_CHECK(queue.try_push(std::move(item)));
+        CATCH_CHECK(item == nullptr);
+    }
+
+    CATCH_SECTION("Pushing onto a full queue blocks until space is available")
+    {
+        fly::BoundedLockFreeQueue<int> queue(2);
+        queue.push(1);
+        queue.push(2);
+
+        auto blocked_push = std::async(
+            std::launch::async,
+            [&queue]()
+            {
+                queue.push(3);
+            });
+
+        std::future_status status = blocked_push.wait_for(std::chrono::milliseconds(10));
+        CATCH_CHECK(status == std::future_status::timeout);
+
+        int value = 0;
+        queue.pop(value);
+        CATCH_CHECK(value == 1);
+
+        status = blocked_push.wait_for(std::chrono::seconds(1));
+        CATCH_CHECK(status == std::future_status::ready);
+
+        queue.pop(value);
+        CATCH_CHECK(value == 2);
+        queue.pop(value);
+        CATCH_CHECK(value == 3);
+    }
+
+    CATCH_SECTION("Items remaining in the queue are destroyed with the queue")
+    {
+        auto item = std::make_shared<int>(1);
+        {
+            fly::BoundedLockFreeQueue<std::shared_ptr<int>> queue(4);
+            queue.push(std::shared_ptr<int>(item));
+            queue.push(std::shared_ptr<int>(item));
+            CATCH_CHECK(item.use_count() == 3);
+        }
+
+        CATCH_CHECK(item.use_count() == 1);
+    }
+}
+
+CATCH_TEST_CASE("LockFreeQueue", "[concurrency]")
+{
+    static constexpr std::size_t s_items = fly::LockFreeQueue<int>::s_segment_size * 10;
+
+    CATCH_SECTION("Items remain ordered across segment boundaries")
+    {
+        fly::LockFreeQueue<std::size_t> queue;
+
+        for (std::size_t i = 0; i < s_items; ++i)
+        {
+            queue.push(std::size_t(i));
+        }
+
+        CATCH_CHECK(queue.size() == s_items);
+
+        for (std::size_t i = 0; i < s_items; ++i)
+        {
+            std::size_t value = 0;
+            CATCH_REQUIRE(queue.try_pop(value));
+            CATCH_CHECK(value == i);
+        }
+
+        CATCH_CHECK(queue.empty());
+    }
+
+    CATCH_SECTION("Ranges of items remain ordered across segment boundaries")
+    {
+        fly::LockFreeQueue<std::size_t> queue;
+        queue.push(std::size_t(0));
+
+        // Push ranges which do not align with the segment size.
+        static constexpr std::size_t s_range_size = fly::LockFreeQueue<int>::s_segment_size + 3;
+        std::size_t next = 1;
+
+        while (next < s_items)
+        {
+            std::vector<std::size_t> range;
+
+            for (std::size_t i = 0; (i < s_range_size) && (next < s_items); ++i)
+            {
+                range.push_back(next++);
+            }
+
+            queue.push(range.begin(), range.end());
+        }
+
+        std::vector<std::size_t> empty;
+        queue.push(empty.begin(), empty.end());
+
+        CATCH_CHECK(queue.size() == s_items);
+
+        for (std::size_t i = 0; i < s_items; ++i)
+        {
+            std::size_t value = 0;
+            CATCH_REQUIRE(queue.try_pop(value));
+            CATCH_CHECK(value == i);
+        }
+
+        CATCH_CHECK(queue.empty());
+    }
+
+    CATCH_SECTION("Pushing a range of items wakes all waiting consumers")
+    {
+        static constexpr std::size_t s_threads = 4;
+
+        fly::LockFreeQueue<std::size_t> queue;
+        std::vector<std::future<std::size_t>> futures;
+
+        for (std::size_t i = 0; i < s_threads; ++i)
+        {
+            futures.push_back(std::async(
+                std::launch::async,
+                [&queue]()
+                {
+                    std::size_t value = 0;
+                    queue.pop(value);
+
+                    return value;
+                }));
+        }
+
+        std::vector<std::size_t> range(s_threads, 12389);
+        queue.push(range.begin(), range.end());
+
+        for (auto &future : futures)
+        {
+            CATCH_REQUIRE(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+            CATCH_CHECK(future.get() == 12389);
+        }
+    }
+
+    CATCH_SECTION("Each item is popped exactly once under contention")
+    {
+        static constexpr std::size_t s_threads = 4;
+
+        fly::LockFreeQueue<std::size_t> queue;
+        std::vector<std::atomic_bool> popped(s_items * s_threads);
+        std::atomic<std::size_t> duplicates(0);
+
+        std::vector<std::future<void>> futures;
+
+        for (std::size_t i = 0; i < s_threads; ++i)
+        {
+            futures.push_back(std::async(
+                std::launch::async,
+                [&queue, i]()
+                {
+                    for (std::size_t j = 0; j < s_items; ++j)
+                    {
+                        queue.push(i * s_items + j);
+                    }
+                }));
+
+            futures.push_back(std::async(
+                std::launch::async,
+                [&queue, &popped, &duplicates]()
+                {
+                    for (std::size_t j = 0; j < s_items; ++j)
+                    {
+                        std::size_t value = 0;
+                        queue.pop(value);
+
+                        if (popped[value].exchange(true))
+                        {
+                            ++duplicates;
+                        }
+                    }
+                }));
+        }
+
+        for (auto &future : futures)
+        {
+            future.get();
+        }
+
+        CATCH_CHECK(duplicates.load() == 0);
+        CATCH_CHECK(queue.empty());
+    }
+
+    CATCH_SECTION("Segments are reclaimed while other threads continue operating on the queue")
+    {
+        static constexpr std::size_t s_threads = 4;
+        static constexpr std::size_t s_contended_items = s_items * 10;
+
+        fly::LockFreeQueue<std::shared_ptr<std::size_t>> queue;
+        std::atomic<std::size_t> sum(0);
+
+        std::vector<std::future<void>> futures;
+
+        for (std::size_t i = 0; i < s_threads; ++i)
+        {
+            futures.push_back(std::async(
+                std::launch::async,
+                [&queue]()
+                {
+                    for (std::size_t j = 0; j < s_contended_items; ++j)
+                    {
+                        queue.push(std::make_shared<std::size_t>(j));
+                    }
+                }));
+
+            // Query the size of the queue between pops, so that segments are traversed while they
+            // are being unlinked and reclaimed.
+            futures.push_back(std::async(
+                std::launch::async,
+                [&queue, &sum]()
+                {
+                    for (std::size_t j = 0; j < s_contended_items; ++j)
+                    {
+                        std::shared_ptr<std::size_t> value;
+                        queue.pop(value);
+
+                        sum += *value;
+                        queue.size();
+                    }
+                }));
+        }
+
+        for (auto &future : futures)
+        {
+            future.get();
+        }
+
+        const std::size_t expected = s_threads * (s_contended_items * (s_contended_items - 1) / 2);
+        CATCH_CHECK(sum.load() == expected);
+        CATCH_CHECK(queue.empty());
+    }
+
+    CATCH_SECTION("Items remaining in the queue are destroyed with the queue")
+    {
+        auto item = std::make_shared<int>(1);
+        {
+            fly::LockFreeQueue<std::shared_ptr<int>> queue;
+
+            for (std::size_t i = 0; i < s_items; ++i)
+            {
+                queue.push(std::shared_ptr<int>(item));
+            }
+
+            std::shared_ptr<int> value;
+            CATCH_REQUIRE(queue.try_pop(value));
+        }
+
+        CATCH_CHECK(item.use_count() == 1);
+    }
+}
+
+CATCH_TEST_CASE("LockFreeStack", "[concurrency]")
+{
+    static constexpr std::size_t s_items = 1000;
+
+    CATCH_SECTION("Nodes are reused after being popped")
+    {
+        fly::LockFreeStack<std::size_t> stack;
+
+        for (std::size_t round = 0; round < 3; ++round)
+        {
+            for (std::size_t i = 0; i < s_items; ++i)
+            {
+                stack.push(std::size_t(i));
+            }
+
+            CATCH_CHECK(stack.size() == s_items);
+
+            for (std::size_t i = s_items; i > 0; --i)
+            {
+                std::size_t value = 0;
+                CATCH_REQUIRE(stack.try_pop(value));
+                CATCH_CHECK(value == i - 1);
+            }
+
+            CATCH_CHECK(stack.empty());
+        }
+    }
+
+    CATCH_SECTION("Each item is popped exactly once under contention")
+    {
+        static constexpr std::size_t s_threads = 4;
+
+        fly::LockFreeStack<std::size_t> stack;
+        std::vector<std::atomic_bool> popped(s_items * s_threads);
+        std::atomic<std::size_t> duplicates(0);
+
+        std::vector<std::future<void>> futures;
+
+        for (std::size_t i = 0; i < s_threads; ++i)
+        {
+            futures.push_back(std::async(
+                std::launch::async,
+                [&stack, &popped, &duplicates, i]()
+                {
+                    // Mimic a free-list: repeatedly push an item, and then pop any item.
+                    for (std::size_t j = 0; j < s_items; ++j)
+                    {
+                        stack.push(i * s_items + j);
+
+                        std::size_t value = 0;
+                        stack.pop(value);
+
+                        if (popped[value].exchange(true))
+                        {
+                            ++duplicates;
+                        }
+                    }
+                }));
+        }
+
+        for (auto &future : futures)
+        {
+            future.get();
+        }
+
+        CATCH_CHECK(duplicates.load() == 0);
+        CATCH_CHECK(stack.empty());
+    }
+
+    CATCH_SECTION("Items remaining in the stack are destroyed with the stack")
+    {
+        auto item = std::make_shared<int>(1);
+        {
+            fly::LockFreeStack<std::shared_ptr<int>> stack;
+
+            for (std::size_t i = 0; i < s_items; ++i)
+            {
+                stack.push(std::shared_ptr<int>(item));
+            }
+
+            std::shared_ptr<int> value;
+            CATCH_REQUIRE(stack.try_pop(value));
+        }
+
+        CATCH_CHECK(item.use_count() == 1);
+    }
+}